@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace Bench {
+
+// Pins the calling thread to one core so repeated runs are comparable (also used by run_tests --perf)
+inline bool PinToCpu(int cpu) {
+    if (cpu < 0) return true;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    return false;
+#endif
+}
+
+// Runs body() warmup + repetitions times and returns the median duration in seconds
+template<typename Body>
+double MedianSeconds(Body&& body, size_t repetitions = 7, size_t warmup = 2) {
+    std::vector<double> seconds;
+    for (size_t rep = 0; rep < warmup + repetitions; rep++) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto stop = std::chrono::steady_clock::now();
+        if (rep >= warmup)
+            seconds.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return seconds[seconds.size() / 2];
+}
+
+// Deterministic white noise in [-1, 1)
+inline void FillNoise(float* data, size_t count, unsigned seed = 1) {
+    unsigned state = seed;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+    }
+}
+
+// Keeps the optimiser from discarding a result
+inline void DoNotOptimize(const float* data, size_t count) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < count; i++) acc += data[i];
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(acc) : "memory");
+#else
+    static volatile float sink;
+    sink = acc;
+    (void)sink;
+#endif
+}
+
+} // namespace Bench
@@ -0,0 +1,126 @@
+// Runtime-dispatch engines (Process through a pointer-to-member) against the
+// statically dispatched *EngineT templates, on the per-voice pattern where the
+// call overhead matters: many voices, short IRs, small blocks.
+//
+// usage: dispatch_benchmark [--voices N] [--frames N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../DenseConvolutionEngine.hpp"
+#include "../../SparseConvolutionEngine.hpp"
+#include "../../VelvetConvolutionEngine.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+using WMode = ConvolutionUtils::WrappingMode;
+using CLayout = ConvolutionUtils::ChannelLayout;
+
+constexpr size_t kChannels = 2;
+constexpr size_t kBufferSize = 256;      // Power of two, holds the longest IR below
+constexpr size_t kDenseTaps = 24;
+constexpr size_t kSparseTaps = 12;
+constexpr size_t kVelvetTaps = 6;        // Per sign
+
+struct Options {
+    size_t voices = 64;
+    size_t frames = 8192;
+    int cpu = 0;
+};
+
+struct IRs {
+    std::vector<float> dense;
+    std::vector<size_t> sparse_positions;
+    std::vector<float> sparse_values;
+    std::vector<size_t> velvet_pos;
+    std::vector<size_t> velvet_neg;
+
+    IRs() : dense(kDenseTaps), sparse_values(kSparseTaps) {
+        Bench::FillNoise(dense.data(), dense.size(), 3);
+        Bench::FillNoise(sparse_values.data(), sparse_values.size(), 5);
+        for (size_t t = 0; t < kSparseTaps; t++) sparse_positions.push_back(t * 9 + (t & 1));
+        for (size_t t = 0; t < kVelvetTaps; t++) {
+            velvet_pos.push_back(t * 17);
+            velvet_neg.push_back(t * 17 + 8);
+        }
+    }
+};
+
+DenseIRHandle MakeHandle(const IRs& irs, const DenseConvolutionEngine*) { return {irs.dense.data(), irs.dense.size()}; }
+SparseIRHandle MakeHandle(const IRs& irs, const SparseConvolutionEngine*) {
+    return {irs.sparse_positions.data(), irs.sparse_values.data(), irs.sparse_positions.size()};
+}
+VelvetIRHandle MakeHandle(const IRs& irs, const VelvetConvolutionEngine*) {
+    return {irs.velvet_pos.data(), irs.velvet_pos.size(), irs.velvet_neg.data(), irs.velvet_neg.size()};
+}
+
+// Frames per second summed over all voices, processing every voice block by block
+template<typename EngineType, typename HandleType>
+double Measure(const HandleType& handle, const Options& options, size_t block_size) {
+    std::vector<EngineType> engines(options.voices);
+    std::vector<float> circ_buffers(options.voices * kBufferSize);
+    std::vector<float> in(options.voices * options.frames * kChannels);
+    std::vector<float> out(in.size());
+    Bench::FillNoise(in.data(), in.size());
+    for (size_t v = 0; v < options.voices; v++)
+        engines[v].Init(handle, circ_buffers.data() + v * kBufferSize, kBufferSize, kChannels);
+
+    const double seconds = Bench::MedianSeconds([&] {
+        for (size_t pos = 0; pos < options.frames; pos += block_size) {
+            const size_t block = std::min(block_size, options.frames - pos);
+            for (size_t v = 0; v < options.voices; v++) {
+                const size_t offset = (v * options.frames + pos) * kChannels;
+                engines[v].Process(in.data() + offset, out.data() + offset, block);
+            }
+        }
+    });
+    Bench::DoNotOptimize(out.data(), out.size());
+    return options.voices * options.frames / seconds;
+}
+
+template<typename RuntimeEngine, typename StaticEngine>
+void Compare(const char* name, const IRs& irs, const Options& options) {
+    const auto handle = MakeHandle(irs, static_cast<const RuntimeEngine*>(nullptr));
+    std::printf("%s\n", name);
+    std::printf("  %6s %16s %16s %9s\n", "block", "runtime Mfr/s", "static Mfr/s", "speedup");
+    for (size_t block : {1, 2, 4, 8, 16, 32, 64}) {
+        const double runtime_fps = Measure<RuntimeEngine>(handle, options, block);
+        const double static_fps = Measure<StaticEngine>(handle, options, block);
+        std::printf("  %6zu %16.2f %16.2f %8.2fx\n", block, runtime_fps * 1e-6, static_fps * 1e-6,
+                    static_fps / runtime_fps);
+    }
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--voices") && has_value) options.voices = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--frames") && has_value) options.frames = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--voices N] [--frames N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.voices > 0 && options.frames > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    std::printf("%zu stereo voices, %zu frames each, buffer %zu\n\n", options.voices, options.frames, kBufferSize);
+    const IRs irs;
+    Compare<DenseConvolutionEngine, DenseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::STEREO>>(
+        "dense (24 taps)", irs, options);
+    Compare<SparseConvolutionEngine, SparseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::STEREO>>(
+        "sparse (12 taps)", irs, options);
+    Compare<VelvetConvolutionEngine, VelvetConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::STEREO>>(
+        "velvet (6+6 taps)", irs, options);
+    return 0;
+}
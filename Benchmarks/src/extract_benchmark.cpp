@@ -0,0 +1,90 @@
+// The "extract output and clear buffer" step on its own: frame by frame (extract_frame)
+// against the bulk copy and clear (extract_block), with cached and non-temporal clears,
+// sweeping circular buffers from L2 to DRAM sized like the engines do.
+//
+// usage: extract_benchmark [--block N] [--channels N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../ConvolutionUtils.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+using WMode = ConvolutionUtils::WrappingMode;
+using CLayout = ConvolutionUtils::ChannelLayout;
+
+struct Options {
+    size_t block = 256;          // Frames extracted per call
+    size_t channels = 2;
+    int cpu = 0;
+};
+
+// Mega frames per second over a few sweeps of the whole buffer
+template<typename Extract>
+double Measure(std::vector<float>& buffer, size_t num_channels, const Options& options, Extract extract) {
+    const size_t buffer_frames = buffer.size() / num_channels;
+    const size_t frames = std::max<size_t>(buffer_frames * 4, size_t(1) << 22);
+    std::vector<float> out(options.block * num_channels);
+    const double seconds = Bench::MedianSeconds([&] {
+        size_t head = 0;
+        for (size_t pos = 0; pos < frames; pos += options.block) {
+            // A cell per block is written back, as the scatter would, so the sweep is not all zeros
+            buffer[head] = 1.0f;
+            head = extract(buffer.data(), buffer.size(), head, out.data(), options.block);
+        }
+    }, 5, 1);
+    Bench::DoNotOptimize(out.data(), out.size());
+    return frames / seconds * 1e-6;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--channels") && has_value) options.channels = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--block N] [--channels N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.block > 0 && options.channels > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    const size_t num_ch = options.channels;
+    std::printf("blocks of %zu frames, %zu channels, Mframes/s (higher is better)\n\n", options.block, num_ch);
+    std::printf("%10s %12s %12s %12s %10s\n", "buffer KiB", "per frame", "bulk", "bulk NT", "bulk gain");
+
+    for (size_t kib : {64, 256, 1024, 4096, 16384, 65536}) {
+        // Power-of-two sample counts, as Init's buffers usually are
+        std::vector<float> buffer(kib * 1024 / sizeof(float), 0.0f);
+
+        const double per_frame = Measure(buffer, num_ch, options, [&](float* data, size_t size, size_t head, float* out, size_t frames) {
+            for (size_t smp = 0; smp < frames; smp++) {
+                ConvolutionUtils::extract_frame<WMode::POWER_OF_TWO, CLayout::MULTICHANNEL>(data, size, head, out + smp * num_ch, num_ch, nullptr);
+                head = ConvolutionUtils::wrap_address<WMode::POWER_OF_TWO>(head + num_ch, size);
+            }
+            return head;
+        });
+        double bulk[2];
+        for (bool non_temporal : {false, true}) {
+            bulk[non_temporal] = Measure(buffer, num_ch, options, [&](float* data, size_t size, size_t head, float* out, size_t frames) {
+                ConvolutionUtils::extract_block(data, size, head, out, frames * num_ch, non_temporal);
+                return ConvolutionUtils::wrap_address<WMode::POWER_OF_TWO>(head + frames * num_ch, size);
+            });
+        }
+        std::printf("%10zu %12.1f %12.1f %12.1f %9.2fx\n", kib, per_frame, bulk[0], bulk[1], bulk[0] / per_frame);
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Feedback delay network throughput against the equivalent convolution: the network's
+// own impulse response, truncated at the decay time, run through the dense engine.
+//
+// usage: fdn_benchmark [--block N] [--rt60 FRAMES] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../FeedbackDelayNetwork.hpp"
+#include "../../DenseConvolutionEngine.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Options {
+    size_t block = 256;          // Callback size
+    size_t rt60 = 24000;         // Decay time, and length of the equivalent IR
+    int cpu = 0;
+};
+
+// Mutually prime delays between about 500 and 2000 frames
+const size_t kDelays[] = {523, 613, 701, 797, 887, 983, 1069, 1163, 1259, 1361, 1451, 1549, 1637, 1741, 1831, 1933};
+
+void InitNetwork(FeedbackDelayNetwork<>& fdn, std::vector<float>& buffer, size_t num_lines, const Options& options) {
+    buffer.assign(ConvolutionUtils::next_power_of_two(FeedbackDelayNetwork<>::GetMinBufferSize(kDelays, num_lines) + 1024 * num_lines), 0.0f);
+    fdn.Init(kDelays, num_lines, FeedbackMatrix::HADAMARD, static_cast<float>(options.rt60), buffer.data(), buffer.size(), 1);
+}
+
+// Mega frames per second of a mono engine, over callbacks of options.block frames
+template<typename EngineType>
+double Measure(EngineType& engine, size_t frames, const Options& options) {
+    std::vector<float> in(frames), out(frames);
+    Bench::FillNoise(in.data(), in.size());
+    const double seconds = Bench::MedianSeconds([&] {
+        for (size_t pos = 0; pos < frames; pos += options.block) {
+            const size_t block = std::min(options.block, frames - pos);
+            engine.Process(in.data() + pos, out.data() + pos, block);
+        }
+    }, 3, 1);
+    Bench::DoNotOptimize(out.data(), out.size());
+    return frames / seconds * 1e-6;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--rt60") && has_value) options.rt60 = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--block N] [--rt60 FRAMES] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.block > 0 && options.rt60 > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    std::printf("mono, callback %zu frames, IR %zu frames, Mframes/s (higher is better)\n\n", options.block, options.rt60);
+    std::printf("%5s %10s %12s %9s\n", "lines", "fdn", "convolution", "speedup");
+
+    for (size_t num_lines : {4, 8, 16}) {
+        FeedbackDelayNetwork<> fdn;
+        std::vector<float> fdn_buffer;
+
+        // The equivalent IR: the network's response to an impulse
+        InitNetwork(fdn, fdn_buffer, num_lines, options);
+        std::vector<float> impulse(options.rt60, 0.0f), ir(options.rt60);
+        impulse[0] = 1.0f;
+        fdn.Process(impulse.data(), ir.data(), options.rt60);
+
+        DenseConvolutionEngine convolution;
+        DenseIRHandle handle = {ir.data(), ir.size()};
+        std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(ir.size() + options.block));
+        convolution.Init(handle, circ_buffer.data(), circ_buffer.size(), 1);
+
+        // About 2^27 multiply-adds per convolution repetition
+        const size_t frames = std::max<size_t>(options.block * 4, (size_t(1) << 27) / ir.size());
+        InitNetwork(fdn, fdn_buffer, num_lines, options);
+        const double fdn_rate = Measure(fdn, frames, options);
+        const double convolution_rate = Measure(convolution, frames, options);
+        std::printf("%5zu %10.2f %12.3f %8.0fx\n", num_lines, fdn_rate, convolution_rate, fdn_rate / convolution_rate);
+        std::fflush(stdout);
+    }
+    return 0;
+}
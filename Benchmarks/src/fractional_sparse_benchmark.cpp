@@ -0,0 +1,110 @@
+// Fractional sparse taps (linear and cubic) against the integer sparse kernel with the
+// same positions rounded, e.g. a set of early reflections: with the taps at rest, and
+// with every tap gliding by a fraction of a frame per callback, as under Doppler.
+//
+// usage: fractional_sparse_benchmark [--block N] [--taps N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../SparseConvolutionEngine.hpp"
+#include "../../FractionalSparseConvolutionEngine.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Options {
+    size_t block = 256;          // Callback size
+    size_t taps = 64;            // Taps of the IR, spread over 4800 frames
+    int cpu = 0;
+};
+
+const size_t kSpanFrames = 4800;
+
+size_t SignalFrames(const Options& options) {
+    return std::max<size_t>(options.block * 4, (size_t(1) << 24) / options.taps);
+}
+
+// Mega frames per second over callbacks of options.block frames, calling before(engine) ahead of each.
+// All engines share in and out, so none gets luckier placement against the circular buffer.
+template<typename EngineType, typename Before>
+double Measure(EngineType& engine, size_t num_channels, const Options& options, const std::vector<float>& in,
+               std::vector<float>& out, Before&& before) {
+    const size_t frames = SignalFrames(options);
+    const double seconds = Bench::MedianSeconds([&] {
+        for (size_t pos = 0; pos < frames; pos += options.block) {
+            const size_t block = std::min(options.block, frames - pos);
+            before(engine);
+            engine.Process(in.data() + pos * num_channels, out.data() + pos * num_channels, block);
+        }
+    }, 5, 1);
+    Bench::DoNotOptimize(out.data(), out.size());
+    return frames / seconds * 1e-6;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--taps") && has_value) options.taps = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--block N] [--taps N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.block > 0 && options.taps > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    // Sorted positions over the span, with fractional parts
+    std::vector<float> fractional(options.taps), values(options.taps), moved(options.taps);
+    std::vector<size_t> integer(options.taps);
+    Bench::FillNoise(values.data(), values.size(), 7);
+    for (size_t t = 0; t < options.taps; t++) {
+        fractional[t] = 1.0f + (kSpanFrames - 4) * (t + 0.37f) / options.taps;
+        integer[t] = static_cast<size_t>(fractional[t] + 0.5f);
+        moved[t] = fractional[t] + 0.75f;
+    }
+
+    std::printf("callback %zu frames, %zu taps over %zu frames, Mframes/s (higher is better)\n\n",
+                options.block, options.taps, kSpanFrames);
+    std::printf("%8s %10s %10s %10s %12s %10s %10s %12s\n", "channels", "integer", "linear", "cubic", "cubic ratio",
+                "lin ramp", "cub ramp", "ramp ratio");
+
+    for (size_t num_channels : {1, 2}) {
+        std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(kSpanFrames * num_channels));
+        std::vector<float> in(SignalFrames(options) * num_channels), out(in.size());
+        Bench::FillNoise(in.data(), in.size());
+        SparseConvolutionEngine sparse;
+        sparse.Init({integer.data(), values.data(), options.taps}, circ_buffer.data(), circ_buffer.size(), num_channels);
+        const double integer_rate = Measure(sparse, num_channels, options, in, out, [](SparseConvolutionEngine&) {});
+
+        // At rest, then gliding back and forth by 0.75 frames over every callback
+        double rates[2], ramp_rates[2];
+        const FractionalInterpolation interpolations[2] = {FractionalInterpolation::LINEAR, FractionalInterpolation::CUBIC};
+        for (size_t i = 0; i < 2; i++) {
+            std::vector<float> taps(FractionalSparseConvolutionEngine::GetTapBufferSize(options.taps));
+            FractionalSparseConvolutionEngine engine;
+            engine.Init({fractional.data(), values.data(), options.taps}, circ_buffer.data(), circ_buffer.size(),
+                        num_channels, taps.data(), interpolations[i]);
+            rates[i] = Measure(engine, num_channels, options, in, out, [](FractionalSparseConvolutionEngine&) {});
+            bool forth = false;
+            ramp_rates[i] = Measure(engine, num_channels, options, in, out, [&](FractionalSparseConvolutionEngine& e) {
+                forth = !forth;
+                e.SetTapPositions(forth ? moved.data() : fractional.data(), options.block);
+            });
+        }
+        std::printf("%8zu %10.2f %10.2f %10.2f %11.2fx %10.2f %10.2f %11.2fx\n", num_channels, integer_rate, rates[0],
+                    rates[1], integer_rate / rates[1], ramp_rates[0], ramp_rates[1], integer_rate / ramp_rates[1]);
+        std::fflush(stdout);
+    }
+    return 0;
+}
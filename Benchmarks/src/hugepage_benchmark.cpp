@@ -0,0 +1,198 @@
+// A fleet of sparse engines with multi-MB circular buffers, whose taps land on a different
+// page each, with buffers from std::vector and from EngineAllocator on regular, transparent
+// huge and explicit huge pages. Reports throughput and, where Linux perf counters are
+// available (perf_event_paranoid <= 2 and a PMU exposed to the machine), dTLB misses.
+//
+// usage: hugepage_benchmark [--engines N] [--span N] [--taps N] [--block N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../SparseConvolutionEngine.hpp"
+#include "../../EngineAllocator.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Options {
+    size_t engines = 64;         // Engines in the fleet
+    size_t span = 1 << 20;       // IR span in frames: 4 MB mono buffers
+    size_t taps = 32;            // Taps spread evenly over the span
+    size_t block = 256;          // Callback size
+    int cpu = 0;
+};
+
+// One hardware counter of the calling thread, user space only; invalid if unsupported
+class PerfCounter {
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)type; (void)config;
+#endif
+    }
+    ~PerfCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    bool Valid() const { return fd_ >= 0; }
+    void Start() {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    uint64_t Stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+#if defined(__linux__)
+uint64_t DtlbConfig(uint64_t op) {
+    return PERF_COUNT_HW_CACHE_DTLB | (op << 8) | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+}
+#endif
+
+enum class Source { VECTOR, NONE, TRANSPARENT, EXPLICIT };
+
+const char* Name(Source source) {
+    switch (source) {
+        case Source::VECTOR:      return "std::vector";
+        case Source::NONE:        return "regular";
+        case Source::TRANSPARENT: return "transparent";
+        case Source::EXPLICIT:    return "explicit";
+    }
+    return "";
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--engines") && has_value) options.engines = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--span") && has_value) options.span = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--taps") && has_value) options.taps = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--engines N] [--span N] [--taps N] [--block N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.engines > 0 && options.taps > 0 && options.span >= options.taps && options.block > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    // Taps spread over the span, every one on its own page
+    std::vector<size_t> positions(options.taps);
+    std::vector<float> values(options.taps);
+    Bench::FillNoise(values.data(), values.size(), 5);
+    for (size_t t = 0; t < options.taps; t++) positions[t] = t * (options.span / options.taps) + 3 * t;
+    const SparseIRHandle handle = {positions.data(), values.data(), options.taps};
+    const size_t buffer_size = SparseConvolutionEngine::GetBufferSize(handle, 1, options.block);
+
+    std::printf("%zu mono engines, %zu taps over %zu frames, %.1f MiB of buffers, callback %zu frames, numa node %d\n\n",
+                options.engines, options.taps, options.span, options.engines * buffer_size * sizeof(float) / 1048576.0,
+                options.block, EngineAllocator::CurrentNumaNode());
+    std::printf("%-12s %-12s %10s %12s %16s %16s\n", "source", "obtained", "huge MiB", "Mframes/s", "dTLB load miss/kf", "dTLB store miss/kf");
+
+    const size_t frames = std::max<size_t>(options.block * 16, (size_t(1) << 24) / (options.engines * options.taps));
+    std::vector<float> in(frames), out(options.block);
+    Bench::FillNoise(in.data(), in.size());
+
+    for (Source source : {Source::VECTOR, Source::NONE, Source::TRANSPARENT, Source::EXPLICIT}) {
+        std::vector<std::vector<float>> vectors;
+        std::vector<PlacedBuffer> placed;
+        std::vector<SparseConvolutionEngine> engines(options.engines);
+        HugePages obtained = HugePages::NONE;
+        for (auto& engine : engines) {
+            float* data;
+            if (source == Source::VECTOR) {
+                vectors.emplace_back(buffer_size);
+                data = vectors.back().data();
+            } else {
+                BufferPlacement placement;
+                placement.huge_pages = source == Source::NONE ? HugePages::NONE
+                                     : source == Source::TRANSPARENT ? HugePages::TRANSPARENT : HugePages::EXPLICIT;
+                placed.push_back(EngineAllocator::Allocate(buffer_size, placement));
+                if (!placed.back().data()) {
+                    std::fprintf(stderr, "allocation failed\n");
+                    return 1;
+                }
+                obtained = placed.back().GetHugePages();
+                data = placed.back().data();
+            }
+            engine.Init(handle, data, buffer_size, 1);
+        }
+        size_t huge_bytes = 0;
+        for (const auto& buffer : placed) huge_bytes += buffer.GetHugePageBytes();
+
+        auto run = [&] {
+            for (size_t pos = 0; pos + options.block <= frames; pos += options.block)
+                for (auto& engine : engines) engine.Process(in.data() + pos, out.data(), options.block);
+        };
+        const double seconds = Bench::MedianSeconds(run, 3, 1);
+        Bench::DoNotOptimize(out.data(), out.size());
+        const double rate = frames * options.engines / seconds * 1e-6;
+
+        // One more pass under the counters
+        std::string misses[2] = {"n/a", "n/a"};
+#if defined(__linux__)
+        PerfCounter load(PERF_TYPE_HW_CACHE, DtlbConfig(PERF_COUNT_HW_CACHE_OP_READ));
+        PerfCounter store(PERF_TYPE_HW_CACHE, DtlbConfig(PERF_COUNT_HW_CACHE_OP_WRITE));
+        load.Start();
+        store.Start();
+        run();
+        const uint64_t counts[2] = {load.Stop(), store.Stop()};
+        const bool valid[2] = {load.Valid(), store.Valid()};
+        for (size_t i = 0; i < 2; i++) {
+            if (!valid[i]) continue;
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.2f", counts[i] * 1000.0 / (frames * options.engines));
+            misses[i] = text;
+        }
+#endif
+        const char* obtained_name = source == Source::VECTOR ? "-"
+                                  : obtained == HugePages::EXPLICIT ? "explicit"
+                                  : obtained == HugePages::TRANSPARENT ? "transparent" : "regular";
+        std::printf("%-12s %-12s %10.1f %12.2f %16s %16s\n", Name(source), obtained_name, huge_bytes / 1048576.0, rate,
+                    misses[0].c_str(), misses[1].c_str());
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Multi-rate convolution (late part at 1/2 or 1/4 rate) against the full-rate dense
+// engine, for reverb-length IRs of a few seconds at 48 kHz.
+//
+// usage: multirate_benchmark [--block N] [--split N] [--filter N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../DenseConvolutionEngine.hpp"
+#include "../../MultiRateConvolutionEngine.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Options {
+    size_t block = 256;          // Callback size
+    size_t split = 4800;         // Early taps at full rate (100 ms)
+    size_t filter = 127;         // Anti-alias filter length
+    int cpu = 0;
+};
+
+const size_t kSampleRate = 48000;
+
+// Mega frames per second over callbacks of options.block frames
+template<typename EngineType>
+double Measure(EngineType& engine, size_t num_taps, size_t num_channels, const Options& options) {
+    const size_t frames = std::max<size_t>(options.block * 4, (size_t(1) << 28) / num_taps);
+    std::vector<float> in(frames * num_channels), out(frames * num_channels);
+    Bench::FillNoise(in.data(), in.size());
+    const double seconds = Bench::MedianSeconds([&] {
+        for (size_t pos = 0; pos < frames; pos += options.block) {
+            const size_t block = std::min(options.block, frames - pos);
+            engine.Process(in.data() + pos * num_channels, out.data() + pos * num_channels, block);
+        }
+    }, 3, 1);
+    Bench::DoNotOptimize(out.data(), out.size());
+    return frames / seconds * 1e-6;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--split") && has_value) options.split = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--filter") && has_value) options.filter = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--block N] [--split N] [--filter N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.block > 0 && options.filter % 2 == 1 && options.split >= 2 * options.filter;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    std::printf("callback %zu frames, split %zu taps, filter %zu taps, mono, Mframes/s (higher is better)\n\n",
+                options.block, options.split, options.filter);
+    std::printf("%8s %10s %10s %10s %10s %10s\n", "seconds", "dense", "rate/2", "rate/4", "ratio /2", "ratio /4");
+
+    for (size_t seconds : {3, 6}) {
+        const size_t num_taps = seconds * kSampleRate;
+        std::vector<float> ir(num_taps);
+        Bench::FillNoise(ir.data(), ir.size(), 3);
+
+        std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(num_taps + options.block));
+        DenseConvolutionEngine dense;
+        dense.Init({ir.data(), num_taps}, circ_buffer.data(), circ_buffer.size(), 1);
+        const double dense_rate = Measure(dense, num_taps, 1, options);
+
+        double rates[2];
+        const size_t factors[2] = {2, 4};
+        for (size_t i = 0; i < 2; i++) {
+            const MultiRateConfig config = {options.split, factors[i], options.filter};
+            std::vector<float> work(MultiRateConvolutionEngine::GetWorkBufferSize(num_taps, config, 1));
+            MultiRateConvolutionEngine engine;
+            engine.Init({ir.data(), num_taps}, config, work.data(), 1);
+            rates[i] = Measure(engine, num_taps, 1, options);
+        }
+        std::printf("%8zu %10.3f %10.3f %10.3f %9.2fx %9.2fx\n", seconds, dense_rate, rates[0], rates[1],
+                    rates[0] / dense_rate, rates[1] / dense_rate);
+        std::fflush(stdout);
+    }
+    return 0;
+}
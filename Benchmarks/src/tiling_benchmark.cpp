@@ -0,0 +1,89 @@
+// Dense kernel throughput with and without (block x tap tile) cache tiling, for IRs
+// whose working set sits in L1, L2, L3 and DRAM.
+//
+// usage: tiling_benchmark [--channels N] [--block N] [--cpu N]
+
+#include "bench_common.hpp"
+#include "../../DenseConvolutionEngine.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Options {
+    size_t channels = 2;
+    size_t block = 256;          // Callback size
+    int cpu = 0;
+};
+
+// Giga multiply-adds per second for one tiling
+double Measure(const std::vector<float>& taps, const Options& options, const ConvolutionUtils::TilingConfig* tiling) {
+    const size_t num_ch = options.channels;
+    // About 2^28 multiply-adds per repetition, whatever the IR size
+    const size_t frames = std::max<size_t>(options.block, (size_t(1) << 28) / (taps.size() * num_ch));
+    std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two((taps.size() + options.block) * num_ch));
+    std::vector<float> in(frames * num_ch), out(in.size());
+    Bench::FillNoise(in.data(), in.size());
+
+    DenseConvolutionEngine engine;
+    DenseIRHandle handle = {taps.data(), taps.size()};
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_ch);
+    if (tiling) engine.SetTiling(*tiling);
+
+    const double seconds = Bench::MedianSeconds([&] {
+        for (size_t pos = 0; pos < frames; pos += options.block) {
+            const size_t block = std::min(options.block, frames - pos);
+            engine.Process(in.data() + pos * num_ch, out.data() + pos * num_ch, block);
+        }
+    }, 3, 1);
+    Bench::DoNotOptimize(out.data(), out.size());
+    return frames * taps.size() * num_ch / seconds * 1e-9;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--channels") && has_value) options.channels = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--block") && has_value) options.block = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--channels N] [--block N] [--cpu N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.channels > 0 && options.block > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    // Working set is about taps * (channels + 1) * 4 bytes
+    const struct { const char* level; size_t taps; } sizes[] = {
+        {"L1", 1 << 10}, {"L2", 1 << 14}, {"L3", 1 << 18}, {"DRAM", 1 << 21}};
+    const ConvolutionUtils::TilingConfig sweep[] = {{16, 256}, {64, 256}, {16, 1024}, {64, 1024}, {64, 4096}};
+
+    std::printf("dense, %zu channels, callback %zu frames, GMAC/s (higher is better)\n\n", options.channels, options.block);
+    std::printf("%-5s %9s %10s %10s", "level", "taps", "untiled", "auto");
+    for (const auto& t : sweep) std::printf("   %4zux%-5zu", t.block_frames, t.tile_taps);
+    std::printf("\n");
+
+    for (const auto& size : sizes) {
+        std::vector<float> taps(size.taps);
+        Bench::FillNoise(taps.data(), taps.size(), 7);
+        for (float& t : taps) t *= 1e-3f;
+
+        const ConvolutionUtils::TilingConfig untiled = {0, 0};
+        std::printf("%-5s %9zu %10.2f %10.2f", size.level, size.taps,
+                    Measure(taps, options, &untiled), Measure(taps, options, nullptr));
+        for (const auto& t : sweep) std::printf(" %12.2f", Measure(taps, options, &t));
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+    return 0;
+}
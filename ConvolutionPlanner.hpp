@@ -0,0 +1,207 @@
+#pragma once
+#ifndef CONVOLUTION_PLANNER_H
+#define CONVOLUTION_PLANNER_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Picks the fastest kernel variant for an engine configuration by timing the
+ * candidates on this machine, FFTW-style.
+ *
+ * The choice for a configuration (engine kind, IR size, channel count, callback size,
+ * wrapping mode) is kept as "wisdom", which can be saved to a file keyed on the CPU
+ * model and loaded at later startups to skip the measurement. Wisdom recorded on a
+ * different CPU model is kept in the file but never applied.
+ *
+ * The tunable variant is the cache tiling of the Dense and Sparse kernels (see
+ * ConvolutionUtils::TilingConfig). Not real-time safe: planning allocates and runs
+ * the kernels, call it from a non-real-time Init.
+ */
+class ConvolutionPlanner
+{
+public:
+    ConvolutionPlanner() : cpu_model_(DetectCpuModel()), measure_macs_(size_t(1) << 24), num_measurements_(0) {}
+
+    /**
+     * @brief Tunes an initialized engine for callbacks of block_size frames: reuses the wisdom
+     * for its configuration, measuring the candidates (and recording the winner) if there is none.
+     * A block_size of 0 has nothing to measure: the engine is left as it is and nothing is recorded.
+     * @return The tiling applied to the engine.
+     */
+    template <typename EngineType, typename HandleType>
+    ConvolutionUtils::TilingConfig Tune(EngineType& engine, const HandleType& handle, size_t buffer_size,
+                                        size_t num_channels, size_t block_size)
+    {
+        if (block_size == 0) return engine.GetTiling();
+
+        const std::string key = MakeKey(handle, buffer_size, num_channels, block_size);
+        auto it = wisdom_.find(Entry(cpu_model_, key));
+        if (it == wisdom_.end())
+        {
+            const auto best = Measure<EngineType>(handle, buffer_size, num_channels, block_size);
+            it = wisdom_.emplace(Entry(cpu_model_, key), best).first;
+        }
+        engine.SetTiling(it->second);
+        return it->second;
+    }
+
+    /**
+     * @brief Merges the wisdom in path (one "cpu model|configuration|block frames|tile taps"
+     * line per entry, '#' starts a comment). Returns false if the file cannot be read.
+     */
+    bool LoadWisdom(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#') continue;
+            std::vector<std::string> fields;
+            std::istringstream stream(line);
+            for (std::string field; std::getline(stream, field, '|'); ) fields.push_back(field);
+            if (fields.size() != 4) continue;
+            wisdom_[Entry(fields[0], fields[1])] = { std::strtoull(fields[2].c_str(), nullptr, 10),
+                                                     std::strtoull(fields[3].c_str(), nullptr, 10) };
+        }
+        return true;
+    }
+
+    bool SaveWisdom(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file) return false;
+        file << "# Convolution planner wisdom: cpu model|configuration|block frames|tile taps\n";
+        for (const auto& entry : wisdom_)
+            file << entry.first.first << '|' << entry.first.second << '|'
+                 << entry.second.block_frames << '|' << entry.second.tile_taps << '\n';
+        return true;
+    }
+
+    bool HasWisdom(const std::string& key) const { return wisdom_.count(Entry(cpu_model_, key)) > 0; }
+
+    void ForgetWisdom() { wisdom_.clear(); }
+
+    /**
+     * @brief Key of a configuration in the wisdom, e.g. "dense:taps=4096:len=4096:ch=2:block=64:pow2=1".
+     */
+    template <typename HandleType>
+    static std::string MakeKey(const HandleType& handle, size_t buffer_size, size_t num_channels, size_t block_size)
+    {
+        std::ostringstream key;
+        key << KindName(handle) << ":taps=" << NumTaps(handle) << ":len=" << ir_length(handle)
+            << ":ch=" << num_channels << ":block=" << block_size
+            << ":pow2=" << (ConvolutionUtils::is_power_of_two(buffer_size) ? 1 : 0);
+        return key.str();
+    }
+
+    const std::string& GetCpuModel() const { return cpu_model_; }
+
+    // Overrides the detected CPU model, e.g. to share wisdom across identical machines
+    void SetCpuModel(const std::string& cpu_model) { cpu_model_ = cpu_model; }
+
+    // Work per candidate measurement, in multiply-adds (default 2^24)
+    void SetMeasureBudget(size_t multiply_adds) { measure_macs_ = std::max<size_t>(multiply_adds, 1); }
+
+    // Number of configurations measured so far (wisdom hits do not count)
+    size_t GetNumMeasurements() const { return num_measurements_; }
+
+    static std::string DetectCpuModel()
+    {
+#if defined(__linux__)
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            // "model name" on x86, "Model" or "CPU part" on ARM
+            if (line.compare(0, 10, "model name") == 0 || line.compare(0, 5, "Model") == 0 ||
+                line.compare(0, 8, "CPU part") == 0)
+            {
+                const size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                std::string model = line.substr(line.find_first_not_of(" \t", colon + 1));
+                std::replace(model.begin(), model.end(), '|', '/');
+                return model;
+            }
+        }
+#endif
+        return "unknown";
+    }
+
+protected:
+    using Entry = std::pair<std::string, std::string>;
+
+    static const char* KindName(const DenseIRHandle&)  { return "dense"; }
+    static const char* KindName(const SparseIRHandle&) { return "sparse"; }
+    static size_t NumTaps(const DenseIRHandle& handle)  { return handle.num_taps; }
+    static size_t NumTaps(const SparseIRHandle& handle) { return handle.num_taps; }
+
+    // Times the untiled kernel, the default tiling and a sweep, and returns the fastest
+    template <typename EngineType, typename HandleType>
+    ConvolutionUtils::TilingConfig Measure(const HandleType& handle, size_t buffer_size, size_t num_channels, size_t block_size)
+    {
+        assert(block_size > 0 && "Measure needs a non-empty callback to time");
+        num_measurements_++;
+
+        std::vector<ConvolutionUtils::TilingConfig> candidates = {
+            { 0, 0 }, ConvolutionUtils::auto_tiling(ir_length(handle), num_channels) };
+        for (size_t block_frames : { size_t(16), size_t(64) })
+            for (size_t tile_taps : { size_t(256), size_t(1024), size_t(4096) })
+                if (tile_taps < NumTaps(handle)) candidates.push_back({ block_frames, tile_taps });
+
+        const size_t macs_per_frame = std::max<size_t>(NumTaps(handle) * num_channels, 1);
+        const size_t frames = std::max(block_size, measure_macs_ / macs_per_frame);
+        std::vector<float> circ_buffer(buffer_size);
+        std::vector<float> in(frames * num_channels), out(in.size());
+        for (size_t i = 0; i < in.size(); i++)
+            in[i] = static_cast<float>((i * 2654435761u) % 2001) * 1e-3f - 1.0f;
+
+        ConvolutionUtils::TilingConfig best = candidates[0];
+        double best_seconds = 0.0;
+        for (const auto& candidate : candidates)
+        {
+            EngineType engine;
+            engine.Init(handle, circ_buffer.data(), buffer_size, num_channels);
+            engine.SetTiling(candidate);
+
+            // Best of three, after one warm-up pass
+            double seconds = 0.0;
+            for (int rep = 0; rep < 4; rep++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                for (size_t pos = 0; pos < frames; pos += block_size)
+                {
+                    const size_t block = std::min(block_size, frames - pos);
+                    engine.Process(in.data() + pos * num_channels, out.data() + pos * num_channels, block);
+                }
+                const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (rep == 1 || (rep > 1 && elapsed < seconds)) seconds = elapsed;
+            }
+            if (best_seconds == 0.0 || seconds < best_seconds)
+            {
+                best = candidate;
+                best_seconds = seconds;
+            }
+        }
+        return best;
+    }
+
+    std::string cpu_model_;
+    size_t      measure_macs_;
+    size_t      num_measurements_;
+    std::map<Entry, ConvolutionUtils::TilingConfig> wisdom_;
+};
+
+#endif // CONVOLUTION_PLANNER_H
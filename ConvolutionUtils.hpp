@@ -3,6 +3,16 @@
 #define CONVOLUTION_UTILS_H
 
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CONVOLUTION_HAS_MXCSR 1
+#define CONVOLUTION_HAS_STREAMING_STORES 1
+#endif
 
 /**
  * @brief Common utilities shared across all convolution engine types
@@ -53,11 +63,689 @@ namespace ConvolutionUtils {
         }
     }
 
+    /**
+     * @brief Number of interleaved channels, as a compile-time constant where the layout fixes it
+     */
+    template<ChannelLayout CLayout>
+    [[nodiscard]] constexpr size_t channel_count(size_t num_channels) noexcept
+    {
+        if constexpr (CLayout == ChannelLayout::MONO) return 1;
+        else if constexpr (CLayout == ChannelLayout::STEREO) return 2;
+        else if constexpr (CLayout == ChannelLayout::QUAD) return 4;
+        else return num_channels;
+    }
+
+    /**
+     * @brief Accumulates one input frame, scaled by a run of consecutive gains, into
+     * the circular buffer starting at the (already wrapped) address start.
+     *
+     * The run covers length * num_channels consecutive cells. It is split at the
+     * wrap point so that each piece is a plain strided loop the compiler can vectorize;
+     * only a frame straddling the end of the buffer goes through wrap_address.
+     * With PerChannelGains the gains are interleaved like the buffer (gains[k * num_channels + ch]),
+     * giving each channel its own IR while the loop stays one contiguous multiply-add.
+     */
+    template <WrappingMode WMode, ChannelLayout CLayout, bool PerChannelGains = false>
+    void scatter_run(float* buffer, size_t buffer_size, size_t start,
+                     const float* frame, const float* gains, size_t length, size_t num_channels)
+    {
+        const size_t num_ch = channel_count<CLayout>(num_channels);
+        size_t k = 0;
+        size_t pos = start;
+
+        while (k < length)
+        {
+            // Contiguous frames before the end of the buffer
+            const size_t n = std::min(length - k, (buffer_size - pos) / num_ch);
+            float* dst = buffer + pos;
+            if constexpr (PerChannelGains)
+            {
+                const float* g = gains + k * num_ch;
+                for (size_t i = 0; i < n; i++)
+                    for_each_channel<CLayout>([&](size_t ch) { dst[i * num_ch + ch] += frame[ch] * g[i * num_ch + ch]; }, num_ch);
+            }
+            else
+            {
+                const float* g = gains + k;
+                for (size_t i = 0; i < n; i++)
+                    for_each_channel<CLayout>([&](size_t ch) { dst[i * num_ch + ch] += frame[ch] * g[i]; }, num_ch);
+            }
+            k   += n;
+            pos += n * num_ch;
+            if (k == length) break;
+
+            // Frame at (or straddling) the wrap point
+            for_each_channel<CLayout>([&](size_t ch) {
+                buffer[wrap_address<WMode>(pos + ch, buffer_size)] += frame[ch] * gains[PerChannelGains ? k * num_ch + ch : k];
+            }, num_ch);
+            k++;
+            pos = wrap_address<WMode>(pos + num_ch, buffer_size);
+        }
+    }
+
+    /**
+     * @brief Output gain of one channel, ramping linearly to a target over a number of frames
+     */
+    struct ChannelGain
+    {
+        float  gain;                 /**< Gain applied to the next frame. */
+        float  target;               /**< Gain at the end of the ramp. */
+        float  step;                 /**< Increment per frame while ramping. */
+        size_t remaining;            /**< Frames left in the ramp. */
+
+        void Set(float new_target, size_t ramp_frames)
+        {
+            target    = new_target;
+            remaining = ramp_frames;
+            if (remaining == 0) gain = target;
+            else step = (target - gain) / static_cast<float>(ramp_frames);
+        }
+
+        // Returns the gain for the current frame and moves to the next one
+        float Next()
+        {
+            const float current = gain;
+            if (remaining > 0)
+            {
+                gain = (--remaining == 0) ? target : gain + step;
+            }
+            return current;
+        }
+
+        void Skip(size_t frames)
+        {
+            if (frames >= remaining) { gain = target; remaining = 0; }
+            else { gain += step * static_cast<float>(frames); remaining -= frames; }
+        }
+    };
+
+    /**
+     * @brief Moves the frame at head to out and clears its cells, applying per-channel
+     * gains if provided (nullptr for unity gain). With Accumulate, the frame scaled by
+     * mix_gain is added to out instead, so engines can sum straight into a bus.
+     */
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate = false>
+    void extract_frame(float* buffer, size_t buffer_size, size_t head, float* out, size_t num_channels, ChannelGain* gains,
+                       float mix_gain = 1.0f)
+    {
+        if (gains)
+        {
+            for_each_channel<CLayout>([&](size_t ch) {
+                const size_t addr = wrap_address<WMode>(head + ch, buffer_size);
+                if constexpr (Accumulate) out[ch] += buffer[addr] * gains[ch].Next() * mix_gain;
+                else                      out[ch]  = buffer[addr] * gains[ch].Next();
+                buffer[addr] = 0.0f;
+            }, num_channels);
+        }
+        else
+        {
+            for_each_channel<CLayout>([&](size_t ch) {
+                const size_t addr = wrap_address<WMode>(head + ch, buffer_size);
+                if constexpr (Accumulate) out[ch] += buffer[addr] * mix_gain;
+                else                      out[ch]  = buffer[addr];
+                buffer[addr] = 0.0f;
+            }, num_channels);
+        }
+    }
+
+    /**
+     * @brief Zeroes count consecutive floats, bypassing the cache if non_temporal (and the
+     * target has streaming stores). Follow non-temporal clears with stream_fence.
+     */
+    inline void clear_run(float* dst, size_t count, bool non_temporal)
+    {
+#if defined(CONVOLUTION_HAS_STREAMING_STORES)
+        if (non_temporal)
+        {
+            size_t i = 0;
+            for (; i < count && (reinterpret_cast<uintptr_t>(dst + i) & 15u); i++) dst[i] = 0.0f;
+            const __m128 zero = _mm_setzero_ps();
+            for (; i + 4 <= count; i += 4) _mm_stream_ps(dst + i, zero);
+            for (; i < count; i++) dst[i] = 0.0f;
+            return;
+        }
+#endif
+        (void)non_temporal;
+        std::memset(dst, 0, count * sizeof(float));
+    }
+
+    /**
+     * @brief Orders earlier non-temporal stores before later stores, e.g. before another
+     * thread snapshots the buffer. No-op without streaming stores.
+     */
+    inline void stream_fence()
+    {
+#if defined(CONVOLUTION_HAS_STREAMING_STORES)
+        _mm_sfence();
+#endif
+    }
+
+    // Shorter runs are moved and cleared in one fused loop, below the cost of the library calls
+    constexpr size_t kBulkExtractMinSamples = 32;
+
+    /**
+     * @brief Block counterpart of extract_frame without per-channel gains: moves count
+     * consecutive samples starting at the (already wrapped) address head to out (with
+     * Accumulate, adds them scaled by mix_gain) and clears them. count must not exceed
+     * buffer_size.
+     *
+     * Split once at the wrap point into a contiguous copy and a single clear per side.
+     * The engines clear through the cache: the cells were just read, so streaming stores
+     * only add write-backs (see extract_benchmark), whatever the buffer size.
+     */
+    template <bool Accumulate = false>
+    void extract_block(float* buffer, size_t buffer_size, size_t head, float* out, size_t count, bool non_temporal,
+                       float mix_gain = 1.0f)
+    {
+        const size_t first = std::min(count, buffer_size - head);
+        const size_t runs[2][2] = { { head, first }, { 0, count - first } };
+        for (const auto& run : runs)
+        {
+            float* src = buffer + run[0];
+            const size_t length = run[1];
+            if (non_temporal || length >= kBulkExtractMinSamples)
+            {
+                if constexpr (Accumulate)
+                {
+                    for (size_t i = 0; i < length; i++) out[i] += src[i] * mix_gain;
+                }
+                else
+                {
+                    std::memcpy(out, src, length * sizeof(float));
+                }
+                clear_run(src, length, non_temporal);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; i++)
+                {
+                    if constexpr (Accumulate) out[i] += src[i] * mix_gain;
+                    else                      out[i]  = src[i];
+                    src[i] = 0.0f;
+                }
+            }
+            out += length;
+        }
+        if (non_temporal) stream_fence();
+    }
+
+    /**
+     * @brief Extracts frames consecutive frames starting at head, as extract_frame would
+     * one by one, and returns the advanced head. Without per-channel gains this is a
+     * single extract_block.
+     */
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate = false>
+    size_t extract_frames(float* buffer, size_t buffer_size, size_t head, float* out, size_t frames, size_t num_channels,
+                          ChannelGain* gains, float mix_gain = 1.0f)
+    {
+        const size_t num_ch = channel_count<CLayout>(num_channels);
+        if (gains)
+        {
+            for (size_t smp = 0; smp < frames; smp++)
+            {
+                extract_frame<WMode, CLayout, Accumulate>(buffer, buffer_size, head, out + smp * num_ch, num_ch, gains, mix_gain);
+                head = wrap_address<WMode>(head + num_ch, buffer_size);
+            }
+            return head;
+        }
+        extract_block<Accumulate>(buffer, buffer_size, head, out, frames * num_ch, false, mix_gain);
+        return wrap_address<WMode>(head + frames * num_ch, buffer_size);
+    }
+
+    /**
+     * @brief Adds (or subtracts) count consecutive samples into the circular buffer starting
+     * at the (already wrapped) address start. count must not exceed buffer_size.
+     *
+     * The destination is split once at the wrap point, leaving two contiguous loops.
+     */
+    template <bool Subtract>
+    void accumulate_block(float* buffer, size_t buffer_size, size_t start, const float* src, size_t count)
+    {
+        const size_t first = std::min(count, buffer_size - start);
+        float* dst = buffer + start;
+        for (size_t i = 0; i < first; i++)
+        {
+            if constexpr (Subtract) dst[i] -= src[i];
+            else                    dst[i] += src[i];
+        }
+        for (size_t i = first; i < count; i++)
+        {
+            if constexpr (Subtract) buffer[i - first] -= src[i];
+            else                    buffer[i - first] += src[i];
+        }
+    }
+
+    /**
+     * @brief Adds count consecutive samples of the circular buffer, starting at the (already
+     * wrapped) address start and scaled by gain, into dst. count must not exceed buffer_size.
+     *
+     * The read-side counterpart of accumulate_block, split once at the wrap point.
+     */
+    inline void gather_block(float* dst, const float* buffer, size_t buffer_size, size_t start, float gain, size_t count)
+    {
+        const size_t first = std::min(count, buffer_size - start);
+        const float* src = buffer + start;
+        for (size_t i = 0; i < first; i++)
+            dst[i] += src[i] * gain;
+        for (size_t i = first; i < count; i++)
+            dst[i] += buffer[i - first] * gain;
+    }
+
+    /**
+     * @brief Adds count consecutive samples of src, scaled by gain, into the circular buffer
+     * starting at the (already wrapped) address start. count must not exceed buffer_size.
+     *
+     * The write-side counterpart of gather_block, split once at the wrap point.
+     */
+    inline void scatter_block(float* buffer, size_t buffer_size, size_t start, const float* src, float gain, size_t count)
+    {
+        const size_t first = std::min(count, buffer_size - start);
+        float* dst = buffer + start;
+        for (size_t i = 0; i < first; i++)
+            dst[i] += src[i] * gain;
+        for (size_t i = first; i < count; i++)
+            buffer[i - first] += src[i] * gain;
+    }
+
+    // Samples per inner loop of the fixed-length kernels: a compile-time trip count lets -O2
+    // vectorize them without a scalar epilogue
+    constexpr size_t kLaneBlock = 16;
+
+    // sum_k g[k] * r[k][j] for the 2 (linear) or 4 (cubic) terms of a Farrow interpolator,
+    // or plain sum_k r[k][j] without gains
+    template <size_t Terms, bool Gains>
+    inline float basis_sample(const float* g, const float* const* r, size_t j)
+    {
+        static_assert(Terms == 2 || Terms == 4, "linear or cubic");
+        if constexpr (!Gains && Terms == 2) return r[0][j] + r[1][j];
+        else if constexpr (!Gains) return (r[0][j] + r[1][j]) + (r[2][j] + r[3][j]);
+        else if constexpr (Terms == 2) return g[0] * r[0][j] + g[1] * r[1][j];
+        else return (g[0] * r[0][j] + g[1] * r[1][j]) + (g[2] * r[2][j] + g[3] * r[3][j]);
+    }
+
+    /**
+     * @brief Adds sum_k gains[k] * rows[k][i], i in [0, count), into dst, or sum_k rows[k][i]
+     * if gains is null. The rows must not overlap dst, which __restrict tells the compiler so
+     * it needs no alias check to vectorize.
+     */
+    template <size_t Terms>
+    void add_basis(float* __restrict dst, const float* const* rows, const float* gains, size_t count)
+    {
+        float g[Terms] = {};
+        const float* r[Terms];
+        for (size_t k = 0; k < Terms; k++)
+        {
+            if (gains) g[k] = gains[k];
+            r[k] = rows[k];
+        }
+
+        size_t i = 0;
+        if (gains)
+        {
+            for (; i + kLaneBlock <= count; i += kLaneBlock)
+                for (size_t j = i; j < i + kLaneBlock; j++) dst[j] += basis_sample<Terms, true>(g, r, j);
+            for (; i < count; i++) dst[i] += basis_sample<Terms, true>(g, r, i);
+        }
+        else
+        {
+            for (; i + kLaneBlock <= count; i += kLaneBlock)
+                for (size_t j = i; j < i + kLaneBlock; j++) dst[j] += basis_sample<Terms, false>(g, r, j);
+            for (; i < count; i++) dst[i] += basis_sample<Terms, false>(g, r, i);
+        }
+    }
+
+    /**
+     * @brief Adds sum_k gains[k] * rows[k][i], i in [0, count), into the circular buffer
+     * starting at the (already wrapped) address start, or sum_k rows[k][i] if gains is null.
+     * count must not exceed buffer_size.
+     *
+     * scatter_block for a Farrow interpolator: a few basis streams combined with per-tap
+     * gains, so a tap costs one pass over the buffer whatever its number of cells.
+     */
+    template <size_t Terms>
+    void scatter_basis(float* buffer, size_t buffer_size, size_t start, const float* const* rows, const float* gains,
+                       size_t count)
+    {
+        const size_t first = std::min(count, buffer_size - start);
+        const float* tail[Terms];
+        for (size_t k = 0; k < Terms; k++) tail[k] = rows[k] + first;
+        add_basis<Terms>(buffer + start, rows, gains, first);
+        add_basis<Terms>(buffer, tail, gains, count - first);
+    }
+
+    /**
+     * @brief Scoped flush-to-zero / denormals-are-zero mode for the calling thread.
+     *
+     * Decaying tails would otherwise reach the denormal range, where x86 arithmetic
+     * slows down by one to two orders of magnitude. The previous mode is restored on
+     * destruction. No-op on targets without a known control register.
+     */
+    class DenormalGuard
+    {
+    public:
+        DenormalGuard() noexcept
+        {
+#if defined(CONVOLUTION_HAS_MXCSR)
+            saved_ = _mm_getcsr();
+            _mm_setcsr(saved_ | 0x8040u);   // FTZ (bit 15) | DAZ (bit 6)
+#elif defined(__aarch64__)
+            uint64_t fpcr;
+            __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+            saved_ = fpcr;
+            __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (uint64_t(1) << 24)));   // FZ
+#endif
+        }
+
+        ~DenormalGuard() noexcept
+        {
+#if defined(CONVOLUTION_HAS_MXCSR)
+            _mm_setcsr(static_cast<unsigned int>(saved_));
+#elif defined(__aarch64__)
+            __asm__ __volatile__("msr fpcr, %0" : : "r"(saved_));
+#endif
+        }
+
+        DenormalGuard(const DenormalGuard&) = delete;
+        DenormalGuard& operator=(const DenormalGuard&) = delete;
+
+    private:
+        uint64_t saved_ = 0;
+    };
+
+    /**
+     * @brief Number of all-zero frames at the end of an interleaved block
+     */
+    inline size_t trailing_silent_frames(const float* in, size_t frames, size_t num_channels)
+    {
+        for (size_t i = frames * num_channels; i > 0; i--)
+        {
+            if (in[i - 1] != 0.0f) return frames - 1 - (i - 1) / num_channels;
+        }
+        return frames;
+    }
+
+    /**
+     * @brief Tracks how long an engine's input has been silent, to tell when its
+     * output buffer has fully drained.
+     *
+     * Once the silent run covers the IR length, every cell the last non-zero input
+     * wrote has been extracted and cleared, and the output stays zero until the input
+     * changes: the engine is idle and may replace its kernel with a memset.
+     * Optionally keeps a shared counter of idle engines up to date.
+     */
+    class TailTracker
+    {
+    public:
+        // A freshly initialized engine has an empty buffer, hence starts idle
+        TailTracker() : silent_frames_(SIZE_MAX), idle_(true), idle_counter_(nullptr) {}
+        TailTracker(const TailTracker& other) : silent_frames_(other.silent_frames_), idle_(other.idle_), idle_counter_(nullptr) {}
+        TailTracker& operator=(const TailTracker& other)
+        {
+            silent_frames_ = other.silent_frames_;
+            set_idle(other.idle_);
+            return *this;
+        }
+        ~TailTracker() { SetIdleCounter(nullptr); }
+
+        void Reset()
+        {
+            silent_frames_ = SIZE_MAX;
+            set_idle(true);
+        }
+
+        bool IsIdle() const { return idle_; }
+
+        /**
+         * @brief Attaches a counter (shared by any number of engines) that holds the number
+         * of attached engines currently idle. Pass nullptr to detach.
+         */
+        void SetIdleCounter(std::atomic<size_t>* counter)
+        {
+            if (idle_counter_ && idle_) idle_counter_->fetch_sub(1, std::memory_order_relaxed);
+            idle_counter_ = counter;
+            if (idle_counter_ && idle_) idle_counter_->fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records a processed block of block_frames ending in silent_frames silent frames
+         */
+        void Update(size_t silent_frames, size_t block_frames, size_t ir_length)
+        {
+            if (silent_frames == block_frames)
+                silent_frames_ = (silent_frames_ > SIZE_MAX - block_frames) ? SIZE_MAX : silent_frames_ + block_frames;
+            else
+                silent_frames_ = silent_frames;
+            set_idle(silent_frames_ >= ir_length);
+        }
+
+        // Saves or restores the tracker through a StateWriter / StateReader (the counter stays attached)
+        template <typename Archive>
+        void Transfer(Archive& archive)
+        {
+            bool idle = idle_;
+            archive.Io(silent_frames_);
+            archive.Io(idle);
+            set_idle(idle);
+        }
+
+    private:
+        void set_idle(bool idle)
+        {
+            if (idle == idle_) return;
+            idle_ = idle;
+            if (idle_counter_)
+            {
+                if (idle_) idle_counter_->fetch_add(1, std::memory_order_relaxed);
+                else       idle_counter_->fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        size_t               silent_frames_;
+        bool                 idle_;
+        std::atomic<size_t>* idle_counter_;
+    };
+
+    /**
+     * @brief Zeroes count samples of a circular buffer from start, split once at the wrap point.
+     */
+    inline void clear_ring(float* buffer, size_t buffer_size, size_t start, size_t count)
+    {
+        const size_t first = std::min(count, buffer_size - start);
+        std::fill(buffer + start, buffer + start + first, 0.0f);
+        std::fill(buffer, buffer + (count - first), 0.0f);
+    }
+
+    /**
+     * @brief Serializes engine state into a caller buffer for SaveState.
+     *
+     * Engines describe their state once, in a transfer_state(Archive&) member, which
+     * both this and StateReader walk. With a null destination only the size is counted.
+     */
+    class StateWriter
+    {
+    public:
+        StateWriter(void* dst, size_t capacity) : dst_(static_cast<unsigned char*>(dst)), capacity_(capacity), size_(0) {}
+
+        template <typename T>
+        void Io(const T& value) { put(&value, sizeof(T)); }
+
+        // Fixed-size array, its length is part of the configuration
+        template <typename T>
+        void IoArray(const T* values, size_t count) { put(values, count * sizeof(T)); }
+
+        // Variable-size array of up to capacity elements, stored with its count
+        template <typename T>
+        void IoArray(const T* values, const size_t& count, size_t /*capacity*/)
+        {
+            Io(count);
+            IoArray(values, count);
+        }
+
+        // A configuration value that the restoring engine must match
+        void Check(size_t value) { Io(value); }
+
+        // count samples of a circular buffer from head, stored with head and count
+        void Ring(const float* buffer, size_t buffer_size, const size_t& head, size_t count)
+        {
+            const size_t first = std::min(count, buffer_size - head);
+            Io(head);
+            Io(count);
+            IoArray(buffer + head, first);
+            IoArray(buffer, count - first);
+        }
+
+        size_t Size() const { return size_; }
+        bool   Ok() const { return size_ <= capacity_; }
+
+    private:
+        void put(const void* src, size_t bytes)
+        {
+            if (dst_ && size_ + bytes <= capacity_) std::memcpy(dst_ + size_, src, bytes);
+            size_ += bytes;
+        }
+
+        unsigned char* dst_;
+        size_t         capacity_;
+        size_t         size_;
+    };
+
+    /**
+     * @brief Reads back a StateWriter buffer for RestoreState.
+     *
+     * A first pass with apply == false only validates the buffer against the engine's
+     * configuration, so that a mismatching or truncated state leaves the engine untouched;
+     * a second pass with apply == true writes it.
+     */
+    class StateReader
+    {
+    public:
+        StateReader(const void* src, size_t size, bool apply)
+            : src_(static_cast<const unsigned char*>(src)), size_(size), pos_(0), apply_(apply), ok_(src != nullptr) {}
+
+        template <typename T>
+        void Io(T& value)
+        {
+            T stored;
+            if (get(&stored, sizeof(T)) && apply_) value = stored;
+        }
+
+        template <typename T>
+        void IoArray(T* values, size_t count)
+        {
+            if (!ok_ || count * sizeof(T) > size_ - pos_) { ok_ = false; return; }
+            if (apply_) std::memcpy(values, src_ + pos_, count * sizeof(T));
+            pos_ += count * sizeof(T);
+        }
+
+        template <typename T>
+        void IoArray(T* values, size_t& count, size_t capacity)
+        {
+            size_t stored = 0;
+            if (!get(&stored, sizeof(size_t)) || stored > capacity) { ok_ = false; return; }
+            if (apply_) count = stored;
+            IoArray(values, stored);
+        }
+
+        void Check(size_t value)
+        {
+            size_t stored = 0;
+            if (get(&stored, sizeof(size_t)) && stored != value) ok_ = false;
+        }
+
+        void Ring(float* buffer, size_t buffer_size, size_t& head, size_t /*count*/)
+        {
+            size_t stored_head = 0, stored_count = 0;
+            get(&stored_head, sizeof(size_t));
+            get(&stored_count, sizeof(size_t));
+            if (!ok_ || stored_head >= buffer_size || stored_count > buffer_size) { ok_ = false; return; }
+            if (apply_) head = stored_head;
+
+            const size_t first = std::min(stored_count, buffer_size - stored_head);
+            IoArray(buffer + stored_head, first);
+            IoArray(buffer, stored_count - first);
+        }
+
+        // True once the whole buffer was consumed without a mismatch
+        bool Done() const { return ok_ && pos_ == size_; }
+        bool Ok() const { return ok_; }
+
+    private:
+        bool get(void* dst, size_t bytes)
+        {
+            if (!ok_ || bytes > size_ - pos_) { ok_ = false; return false; }
+            std::memcpy(dst, src_ + pos_, bytes);
+            pos_ += bytes;
+            return true;
+        }
+
+        const unsigned char* src_;
+        size_t               size_;
+        size_t               pos_;
+        bool                 apply_;
+        bool                 ok_;
+    };
+
+    /**
+     * @brief Tiling of a scatter kernel over (block of input frames x tile of taps).
+     *
+     * Every frame of a block is applied to one tile of taps before moving to the next
+     * tile, so the tile and the buffer cells it covers stay cache-resident while
+     * block_frames samples reuse them. tile_taps == 0 disables tiling.
+     */
+    struct TilingConfig
+    {
+        size_t block_frames;         /**< Input frames applied per tile pass. */
+        size_t tile_taps;            /**< Taps per tile, 0 for the untiled per-sample kernel. */
+    };
+
+    // Working sets below this stay in L2 without tiling
+    constexpr size_t kTilingThresholdBytes = 256 * 1024;
+    // Target working set of one tile: half of a typical 32 KiB L1D
+    constexpr size_t kTileTargetBytes      = 16 * 1024;
+    constexpr size_t kDefaultTileBlock     = 32;
+
+    /**
+     * @brief Default tiling for num_taps taps spanning num_channels interleaved channels:
+     * untiled while the taps and the buffer span fit in L2, else tiles sized for L1.
+     */
+    inline TilingConfig auto_tiling(size_t num_taps, size_t num_channels)
+    {
+        // Each tap reads one gain and updates num_channels cells
+        const size_t bytes_per_tap = (num_channels + 1) * sizeof(float);
+        if (num_taps * bytes_per_tap <= kTilingThresholdBytes) return { 0, 0 };
+        return { kDefaultTileBlock, std::max<size_t>(kTileTargetBytes / bytes_per_tap, 16) };
+    }
+
     /**
      * @brief Checks if a number is a power of two
      */
     inline bool is_power_of_two(size_t n) { return (n > 0) && ((n & (n - 1)) == 0); }
 
+    /**
+     * @brief Smallest power of two greater than or equal to n (1 for n == 0)
+     */
+    inline size_t next_power_of_two(size_t n)
+    {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    /**
+     * @brief Frames per Process call the engines' buffer size queries leave room for by default
+     */
+    constexpr size_t kDefaultMaxBlockFrames = 1024;
+
+    /**
+     * @brief Power-of-two circular buffer size (in samples) for an IR spanning length frames,
+     * with room for blocks of max_block_frames: the block kernels write a block up to
+     * (length + block - 1) frames ahead, and split calls into blocks that fit.
+     */
+    inline size_t buffer_size_for(size_t length, size_t num_channels, size_t max_block_frames = 1)
+    {
+        return next_power_of_two((std::max<size_t>(length, 1) + std::max<size_t>(max_block_frames, 1) - 1) * num_channels);
+    }
+
 } // namespace ConvolutionUtils
 
 #endif // CONVOLUTION_UTILS_H
\ No newline at end of file
@@ -5,30 +5,274 @@
 #include "IRHandle.hpp"
 #include "ConvolutionUtils.hpp"
 #include <cstddef>   
+#include <cassert>
 #include <algorithm> 
 #include <cmath>     
 #include <type_traits> 
 
 /**
- * @brief A generic, real-time safe convolution engine supporting dense
- * impulse responses with compile-time optimization for channel layout.
+ * @brief Morph state of one output channel in per-channel IR mode.
  */
-class DenseConvolutionEngine
+struct DenseChannelMorph
+{
+    int cycles_remaining;        /**< Update calls left, 0 when idle. */
+};
+
+/**
+ * @brief State, morphing and kernels shared by the runtime-dispatch DenseConvolutionEngine
+ * and the statically dispatched DenseConvolutionEngineT.
+ */
+class DenseConvolutionEngineCore
 {
-    friend class ConvolutionEngineTest;
-    template<typename EngineType> friend class EngineWrapperImpl;
 public:
     using WrappingMode = ConvolutionUtils::WrappingMode;
     using ChannelLayout = ConvolutionUtils::ChannelLayout;
 
-    using ProcessFunctionPtr = void (DenseConvolutionEngine::*)(const float*, float*, size_t);
+    /**
+     * @brief Circular buffer size (in samples) to allocate for Init with handle: the span of the IR
+     * in frames plus max_block_frames - 1, rounded up to a power of two so that the masked wrapping
+     * kernels are used. Process calls of up to max_block_frames frames then run as one block.
+     */
+    static size_t GetBufferSize(const DenseIRHandle& handle, size_t num_channels,
+                                size_t max_block_frames = ConvolutionUtils::kDefaultMaxBlockFrames)
+    {
+        return ConvolutionUtils::buffer_size_for(ir_length(handle), num_channels, max_block_frames);
+    }
 
-    DenseConvolutionEngine() : active_process_function_(nullptr), is_morphing_(false), 
-                               morph_cycles_remaining_(0), morph_delta_(nullptr) {}
-    ~DenseConvolutionEngine() {}
+    DenseConvolutionEngineCore() : handle_taps_(nullptr), is_morphing_(false), morph_cycles_remaining_(0), current_taps_(nullptr), morph_target_(nullptr),
+                                   channel_taps_(nullptr), channel_target_(nullptr), channel_morphs_(nullptr), channel_gains_(nullptr) {}
 
-    void Init(const DenseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
-              float* current_taps_buffer = nullptr, float* morph_delta_buffer = nullptr)
+    /**
+     * @brief Starts moving the IR towards target_handle over morph_cycles calls of
+     * MorphIRDense_Update. The target is copied, so its taps need not outlive the call.
+     */
+    void MorphIRDense(const DenseIRHandle& target_handle, int morph_cycles)
+    {
+        assert(morph_cycles > 0);
+        assert(target_handle.taps);
+        assert(target_handle.num_taps == num_dense_taps_);
+        assert(current_taps_);
+        assert(morph_target_);
+
+        std::copy(target_handle.taps, target_handle.taps + num_dense_taps_, morph_target_);
+        morph_cycles_remaining_ = morph_cycles;
+        
+        // Switch to using current_taps_ for processing
+        dense_taps_ = current_taps_;
+        is_morphing_ = true;
+    }
+
+    void MorphIRDense_Update()
+    {
+        if (!is_morphing_ || morph_cycles_remaining_ <= 0)
+            return;
+
+        morph_cycles_remaining_--;
+        
+        if (morph_cycles_remaining_ == 0)
+        {
+            // Morphing complete - snap to target values and update main pointer
+            std::copy(morph_target_, morph_target_ + num_dense_taps_, current_taps_);
+            dense_taps_ = current_taps_;
+            is_morphing_ = false;
+        }
+        else
+        {
+            // One step of linear interpolation: an equal share of the distance left per call
+            const float step = 1.0f / static_cast<float>(morph_cycles_remaining_ + 1);
+            for (size_t i = 0; i < num_dense_taps_; i++)
+            {
+                current_taps_[i] += (morph_target_[i] - current_taps_[i]) * step;
+            }
+        }
+    }
+
+    /**
+     * @brief Switches to one IR per output channel, all starting from the current IR.
+     *
+     * channel_taps_buffer (and channel_target_buffer, needed for morphing) hold num_taps * num_channels
+     * floats, interleaved like the circular buffer (tap * num_channels + ch), so the kernel stays a
+     * single contiguous pass in which each cell is scaled by its own channel's tap. channel_morphs
+     * holds num_channels entries (optional, needed for morphing). Call after Init; the shared-IR
+     * morph functions have no effect in this mode.
+     */
+    void EnableChannelIRs(float* channel_taps_buffer, float* channel_target_buffer = nullptr,
+                          DenseChannelMorph* channel_morphs = nullptr)
+    {
+        assert(channel_taps_buffer);
+        channel_taps_   = channel_taps_buffer;
+        channel_target_ = channel_target_buffer;
+        channel_morphs_ = channel_morphs;
+
+        for (size_t i = 0; i < num_dense_taps_; i++)
+            for (size_t ch = 0; ch < num_channels_; ch++)
+                channel_taps_[i * num_channels_ + ch] = dense_taps_[i];
+        if (channel_morphs_)
+            for (size_t ch = 0; ch < num_channels_; ch++) channel_morphs_[ch] = { 0 };
+    }
+
+    /**
+     * @brief Replaces the IR of one channel immediately (same number of taps as the engine's IR)
+     */
+    void SetChannelIR(size_t channel, const DenseIRHandle& handle)
+    {
+        assert(channel_taps_);
+        assert(channel < num_channels_);
+        assert(handle.num_taps == num_dense_taps_);
+
+        for (size_t i = 0; i < num_dense_taps_; i++)
+            channel_taps_[i * num_channels_ + channel] = handle.taps[i];
+        if (channel_morphs_) channel_morphs_[channel].cycles_remaining = 0;
+    }
+
+    /**
+     * @brief Starts moving one channel's IR towards target_handle over morph_cycles calls of
+     * MorphIRDenseChannel_Update. Other channels keep their own IRs and morphs. The target
+     * is copied, so its taps need not outlive the call.
+     */
+    void MorphIRDenseChannel(size_t channel, const DenseIRHandle& target_handle, int morph_cycles)
+    {
+        assert(morph_cycles > 0);
+        assert(channel_taps_ && channel_target_ && channel_morphs_);
+        assert(channel < num_channels_);
+        assert(target_handle.taps);
+        assert(target_handle.num_taps == num_dense_taps_);
+
+        for (size_t i = 0; i < num_dense_taps_; i++)
+            channel_target_[i * num_channels_ + channel] = target_handle.taps[i];
+        channel_morphs_[channel] = { morph_cycles };
+    }
+
+    /**
+     * @brief Applies one interpolation step to every channel that is morphing
+     */
+    void MorphIRDenseChannel_Update()
+    {
+        if (!channel_morphs_) return;
+
+        for (size_t ch = 0; ch < num_channels_; ch++)
+        {
+            DenseChannelMorph& morph = channel_morphs_[ch];
+            if (morph.cycles_remaining <= 0) continue;
+
+            if (--morph.cycles_remaining == 0)
+            {
+                // Morphing complete - snap to target values
+                for (size_t i = 0; i < num_dense_taps_; i++)
+                    channel_taps_[i * num_channels_ + ch] = channel_target_[i * num_channels_ + ch];
+            }
+            else
+            {
+                const float step = 1.0f / static_cast<float>(morph.cycles_remaining + 1);
+                for (size_t i = 0; i < num_dense_taps_; i++)
+                {
+                    const size_t cell = i * num_channels_ + ch;
+                    channel_taps_[cell] += (channel_target_[cell] - channel_taps_[cell]) * step;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief True while the input has been silent for at least the IR length, i.e. the
+     * output buffer is drained and Process only writes zeros.
+     */
+    bool IsIdle() const { return tail_.IsIdle(); }
+
+    /**
+     * @brief Attaches a counter, typically shared by all voices, of how many engines are idle.
+     */
+    void SetIdleCounter(std::atomic<size_t>* counter) { tail_.SetIdleCounter(counter); }
+
+    /**
+     * @brief Attaches storage for num_channels per-channel output gains, all starting at unity.
+     * Call after Init; pass nullptr to detach.
+     */
+    void SetChannelGainBuffer(ConvolutionUtils::ChannelGain* gains)
+    {
+        channel_gains_ = gains;
+        if (channel_gains_)
+            for (size_t ch = 0; ch < num_channels_; ch++) channel_gains_[ch] = { 1.0f, 1.0f, 0.0f, 0 };
+    }
+
+    /**
+     * @brief Ramps the output gain of one channel to target over ramp_frames output frames,
+     * sample-accurately from the next processed frame. Requires a gain buffer.
+     */
+    void SetChannelGain(size_t channel, float target, size_t ramp_frames)
+    {
+        assert(channel_gains_);
+        assert(channel < num_channels_);
+        channel_gains_[channel].Set(target, ramp_frames);
+    }
+
+    /**
+     * @brief Overrides the tiling picked at Init (see ConvolutionUtils::auto_tiling);
+     * tile_taps == 0 selects the untiled kernel. Call after Init.
+     */
+    void SetTiling(const ConvolutionUtils::TilingConfig& tiling)
+    {
+        assert(tiling.tile_taps == 0 || tiling.block_frames > 0);
+        tiling_ = tiling;
+    }
+
+    ConvolutionUtils::TilingConfig GetTiling() const { return tiling_; }
+
+    /**
+     * @brief Bytes SaveState needs for the current state.
+     */
+    size_t GetStateSize() const
+    {
+        ConvolutionUtils::StateWriter writer(nullptr, 0);
+        const_cast<DenseConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Size();
+    }
+
+    /**
+     * @brief Snapshots the engine into state: the live part of the buffer (the IR span
+     * ahead of the write head, not the whole buffer) plus the silence tracking, morph
+     * and gain state. Morph targets are referenced, not copied. Real-time safe.
+     * @return Bytes written, 0 if capacity is below GetStateSize().
+     */
+    size_t SaveState(void* state, size_t capacity) const
+    {
+        ConvolutionUtils::StateWriter writer(state, capacity);
+        const_cast<DenseConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Ok() ? writer.Size() : 0;
+    }
+
+    /**
+     * @brief Restores a SaveState snapshot, e.g. to seek or to hand a voice over. The engine
+     * must be initialized with the same IR, buffer size, channel count and optional buffers;
+     * otherwise false is returned and the engine is left untouched. Real-time safe.
+     */
+    bool RestoreState(const void* state, size_t size)
+    {
+        ConvolutionUtils::StateReader check(state, size, false);
+        transfer_state(check);
+        if (!check.Done()) return false;
+
+        Reset();
+        ConvolutionUtils::StateReader reader(state, size, true);
+        transfer_state(reader);
+        return true;
+    }
+
+    /**
+     * @brief Drops the tail, as a new Init would, but clears only the cells that can hold
+     * it: none when idle, else the IR span ahead of the write head. IR, morph and gain
+     * state are kept. Real-time safe.
+     */
+    void Reset()
+    {
+        if (!tail_.IsIdle())
+            ConvolutionUtils::clear_ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Reset();
+    }
+
+protected:
+    void init_state(const DenseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+                    float* current_taps_buffer, float* morph_target_buffer)
     {
         circ_buffer_  = circ_buffer;
         buffer_size_  = buffer_size;
@@ -41,23 +285,236 @@ public:
 
 		// Init empty buffer
         std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
+        tail_.Reset();
+        channel_gains_ = nullptr;
+        channel_taps_ = nullptr;
+        channel_target_ = nullptr;
+        channel_morphs_ = nullptr;
 
-        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
-        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
-
+        handle_taps_                = handle.taps;
         dense_taps_ 				= handle.taps;
         num_dense_taps_ 			= handle.num_taps;
         assert(dense_taps_          || (num_dense_taps_ == 0));         // != NULL
 
+        tiling_ = ConvolutionUtils::auto_tiling(num_dense_taps_, num_channels_);
+
         // Initialize morphing buffers if provided
         current_taps_ = current_taps_buffer;
-        morph_delta_ = morph_delta_buffer;
+        morph_target_ = morph_target_buffer;
+        is_morphing_ = false;
+        morph_cycles_remaining_ = 0;
         
         if (current_taps_ && num_dense_taps_ > 0)
         {
             // Copy initial IR values to current_taps_ buffer
             std::copy(dense_taps_, dense_taps_ + num_dense_taps_, current_taps_);
         }
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessImpl(const float* in, float* out, size_t size)
+    {
+        ProcessMix<WMode, CLayout, false>(in, out, size, 1.0f);
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessAccumulateImpl(const float* in, float* out, size_t size, float gain)
+    {
+        ProcessMix<WMode, CLayout, true>(in, out, size, gain);
+    }
+
+    // Overwrites out with the output, or with Accumulate adds gain times it; in == out is allowed
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessMix(const float* in, float* out, size_t size, float gain)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+        const size_t silent = ConvolutionUtils::trailing_silent_frames(in, size, num_ch);
+
+        // Drained buffer and silent input: the output stays zero (or untouched), only the head moves
+        if (tail_.IsIdle() && silent == size)
+        {
+            if constexpr (!Accumulate) std::fill(out, out + size * num_ch, 0.0f);
+            write_head_ = (write_head_ + size * num_ch) % buffer_size_;
+            if (channel_gains_)
+                for (size_t ch = 0; ch < num_ch; ch++) channel_gains_[ch].Skip(size);
+        }
+        else
+        {
+            ProcessKernel<WMode, CLayout, Accumulate>(in, out, size, gain);
+        }
+        tail_.Update(silent, size, num_dense_taps_);
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessKernel(const float* in, float* out, size_t size, float gain)
+    {
+        const size_t num_ch = ConvolutionUtils::channel_count<CLayout>(num_channels_);
+
+        // DENSE KERNEL: a block of frames per tile of taps, then the block is extracted in bulk.
+        // Untiled, the whole IR is one tile. The writes reach (block + IR length - 1) frames
+        // ahead, which must not wrap onto unread cells.
+        const size_t buffer_frames = buffer_size_ / num_ch;
+        const size_t max_block = (num_dense_taps_ < buffer_frames) ? buffer_frames - num_dense_taps_ + 1 : 1;
+        const size_t tile = tiling_.tile_taps ? tiling_.tile_taps : num_dense_taps_;
+        const size_t block_frames = tiling_.tile_taps ? std::min(tiling_.block_frames, max_block) : max_block;
+
+        while (size > 0)
+        {
+            const size_t block = std::min(size, block_frames);
+
+            for (size_t t0 = 0; t0 < num_dense_taps_; t0 += tile)
+            {
+                const size_t t1 = std::min(t0 + tile, num_dense_taps_);
+                for (size_t smp = 0; smp < block; smp++)
+                    ScatterTaps<WMode, CLayout>(in + smp * num_ch,
+                                                ConvolutionUtils::wrap_address<WMode>(write_head_ + smp * num_ch, buffer_size_), t0, t1);
+            }
+
+            // Extract output and clear buffer
+            write_head_ = ConvolutionUtils::extract_frames<WMode, CLayout, Accumulate>(circ_buffer_, buffer_size_, write_head_, out, block,
+                                                                                        num_ch, channel_gains_, gain);
+
+            in   += block * num_ch;
+            out  += block * num_ch;
+            size -= block;
+        }
+    }
+
+    // Samples ahead of the write head that can still hold a tail
+    size_t live_size() const { return std::min(num_dense_taps_ * num_channels_, buffer_size_); }
+
+    // Walks the state with a StateWriter or StateReader, in one fixed order
+    template <typename Archive>
+    void transfer_state(Archive& archive)
+    {
+        const size_t optional_buffers = (current_taps_ ? 1 : 0) | (morph_target_ ? 2 : 0) | (channel_taps_ ? 4 : 0) |
+                                        (channel_target_ ? 8 : 0) | (channel_morphs_ ? 16 : 0) | (channel_gains_ ? 32 : 0);
+        archive.Check(kStateTag);
+        archive.Check(buffer_size_);
+        archive.Check(num_channels_);
+        archive.Check(num_dense_taps_);
+        archive.Check(optional_buffers);
+
+        archive.Ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Transfer(archive);
+
+        // The taps in use are either the Init handle's or current_taps_. Only which one is
+        // stored: a restored engine keeps its own handle, never another engine's pointer.
+        bool on_current = current_taps_ && dense_taps_ == current_taps_;
+        archive.Io(on_current);
+        dense_taps_ = on_current ? current_taps_ : handle_taps_;
+
+        // Morph targets are copies held in the engine's buffers, so nothing here is referenced
+        archive.Io(is_morphing_);
+        archive.Io(morph_cycles_remaining_);
+        if (current_taps_)   archive.IoArray(current_taps_, num_dense_taps_);
+        if (morph_target_)   archive.IoArray(morph_target_, num_dense_taps_);
+        if (channel_taps_)   archive.IoArray(channel_taps_, num_dense_taps_ * num_channels_);
+        if (channel_target_) archive.IoArray(channel_target_, num_dense_taps_ * num_channels_);
+        if (channel_morphs_) archive.IoArray(channel_morphs_, num_channels_);
+        if (channel_gains_)  archive.IoArray(channel_gains_, num_channels_);
+    }
+
+    static constexpr size_t kStateTag = 0x44454e53; // "DENS"
+
+    // Scatters taps [t0, t1) of one input frame arriving at head
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ScatterTaps(const float* frame, size_t head, size_t t0, size_t t1)
+    {
+        const size_t start = ConvolutionUtils::wrap_address<WMode>(head + t0 * num_channels_, buffer_size_);
+        if (channel_taps_)
+            ConvolutionUtils::scatter_run<WMode, CLayout, true>(circ_buffer_, buffer_size_, start, frame,
+                                                                channel_taps_ + t0 * num_channels_, t1 - t0, num_channels_);
+        else
+            ConvolutionUtils::scatter_run<WMode, CLayout>(circ_buffer_, buffer_size_, start, frame,
+                                                          dense_taps_ + t0, t1 - t0, num_channels_);
+    }
+
+
+    size_t write_head_;
+    size_t buffer_size_;
+    size_t num_channels_;
+    float* circ_buffer_;
+
+	// Used for DENSE kernel
+    const float * dense_taps_;
+    size_t        num_dense_taps_;
+    const float * handle_taps_;     // The Init handle's taps
+
+    // Morphing state
+    bool is_morphing_;
+    int morph_cycles_remaining_;
+    float* current_taps_;
+    float* morph_target_;           // Copy of the morph target
+
+    // Cache tiling of the kernel
+    ConvolutionUtils::TilingConfig tiling_;
+
+    // Per-channel IR state, interleaved like the buffer (optional)
+    float*             channel_taps_;
+    float*             channel_target_;
+    DenseChannelMorph* channel_morphs_;
+
+    // Silence tracking for the idle fast path
+    ConvolutionUtils::TailTracker tail_;
+
+    // Per-channel output gain ramps (optional)
+    ConvolutionUtils::ChannelGain* channel_gains_;
+};
+
+/**
+ * @brief Dense engine with wrapping mode and channel layout fixed at compile time.
+ * Process is a direct call into the kernel that the compiler can inline into the
+ * caller's loop; use it when the configuration is known up front.
+ */
+template <ConvolutionUtils::WrappingMode WMode, ConvolutionUtils::ChannelLayout CLayout>
+class DenseConvolutionEngineT : public DenseConvolutionEngineCore
+{
+public:
+    void Init(const DenseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              float* current_taps_buffer = nullptr, float* morph_target_buffer = nullptr)
+    {
+        assert(num_channels == ConvolutionUtils::channel_count<CLayout>(num_channels));
+        assert(WMode == WrappingMode::ARBITRARY || ConvolutionUtils::is_power_of_two(buffer_size));
+
+        init_state(handle, circ_buffer, buffer_size, num_channels, current_taps_buffer, morph_target_buffer);
+    }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        this->template ProcessImpl<WMode, CLayout>(in, out, size);
+    }
+
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
+    {
+        this->template ProcessAccumulateImpl<WMode, CLayout>(in, out, size, gain);
+    }
+};
+
+/**
+ * @brief A generic, real-time safe convolution engine supporting dense
+ * impulse responses with compile-time optimization for channel layout.
+ * Picks the kernel at Init from the runtime channel count and buffer size.
+ */
+class DenseConvolutionEngine : public DenseConvolutionEngineCore
+{
+    friend class ConvolutionEngineTest;
+    template<typename EngineType> friend class EngineWrapperImpl;
+public:
+    using ProcessFunctionPtr = void (DenseConvolutionEngine::*)(const float*, float*, size_t);
+    using AccumulateFunctionPtr = void (DenseConvolutionEngine::*)(const float*, float*, size_t, float);
+
+    DenseConvolutionEngine() : active_process_function_(nullptr), active_accumulate_function_(nullptr) {}
+    ~DenseConvolutionEngine() {}
+
+    void Init(const DenseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              float* current_taps_buffer = nullptr, float* morph_target_buffer = nullptr)
+    {
+        init_state(handle, circ_buffer, buffer_size, num_channels, current_taps_buffer, morph_target_buffer);
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
 
         // Dispatch to the correct template specialization based on runtime channel count
         // and WrappingMode
@@ -79,56 +536,23 @@ public:
 		}
     }
 
+    /**
+     * @brief Writes size frames of output. in and out may be the same buffer (in-place),
+     * but must not otherwise overlap.
+     */
     void Process(const float* in, float* out, size_t size)
     {
         (this->*active_process_function_)(in, out, size);
     }
 
-    void MorphIRDense(const DenseIRHandle& target_handle, int morph_cycles)
-    {
-        assert(morph_cycles > 0);
-        assert(target_handle.taps);
-        assert(target_handle.num_taps == num_dense_taps_);
-        assert(current_taps_);
-        assert(morph_delta_);
-
-        target_taps_ = target_handle.taps;
-        morph_cycles_remaining_ = morph_cycles;
-        
-        // Calculate deltas for each tap (from current state to target)
-        for (size_t i = 0; i < num_dense_taps_; i++)
-        {
-            morph_delta_[i] = (target_taps_[i] - current_taps_[i]) / static_cast<float>(morph_cycles);
-        }
-        
-        // Switch to using current_taps_ for processing
-        dense_taps_ = current_taps_;
-        is_morphing_ = true;
-    }
-
-    void MorphIRDense_Update()
+    /**
+     * @brief Adds gain times the output to out instead of overwriting it, fused into the
+     * extraction, e.g. to mix several engines into one bus without a temporary buffer.
+     * When idle, out is left untouched.
+     */
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
     {
-        if (!is_morphing_ || morph_cycles_remaining_ <= 0)
-            return;
-
-        // Apply one step of linear interpolation
-        for (size_t i = 0; i < num_dense_taps_; i++)
-        {
-            current_taps_[i] += morph_delta_[i];
-        }
-
-        morph_cycles_remaining_--;
-        
-        if (morph_cycles_remaining_ == 0)
-        {
-            // Morphing complete - snap to target values and update main pointer
-            for (size_t i = 0; i < num_dense_taps_; i++)
-            {
-                current_taps_[i] = target_taps_[i];
-            }
-            dense_taps_ = current_taps_;
-            is_morphing_ = false;
-        }
+        (this->*active_accumulate_function_)(in, out, size, gain);
     }
 
 protected:
@@ -136,6 +560,7 @@ protected:
     void set_process_function(WrappingMode)
     {
         active_process_function_ = &DenseConvolutionEngine::ProcessImpl<WMode, CLayout>;
+        active_accumulate_function_ = &DenseConvolutionEngine::ProcessAccumulateImpl<WMode, CLayout>;
     }
 
     void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
@@ -154,51 +579,8 @@ protected:
         }
     }
 
-
-    template <WrappingMode WMode, ChannelLayout CLayout>
-    void ProcessImpl(const float* in, float* out, size_t size)
-    {
-        const size_t num_ch = num_channels_;
-
-        for (size_t smp = 0; smp < size; smp++)
-        {
-            // DENSE KERNEL
-            for (size_t t = 0; t < num_dense_taps_; t++)
-                ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) 
-                {
-                    const size_t tap_pos = ConvolutionUtils::wrap_address<WMode>(write_head_ + ch + t * num_ch, buffer_size_);
-                    circ_buffer_[tap_pos] += in[smp*num_ch + ch] * dense_taps_[t];
-                }, num_channels_);
-            
-            // Extract output and clear buffer
-            ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) {
-                out[smp * num_ch + ch] = circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)];
-				circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)] = 0.0f;
-            }, num_channels_);
-			
-			// Advance buffer head
-			write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + num_ch, buffer_size_);
-        }
-    }
-
-
     ProcessFunctionPtr active_process_function_;
-
-    size_t write_head_;
-    size_t buffer_size_;
-    size_t num_channels_;
-    float* circ_buffer_;
-
-	// Used for DENSE kernel
-    const float * dense_taps_;
-    size_t        num_dense_taps_;
-
-    // Morphing state
-    bool is_morphing_;
-    int morph_cycles_remaining_;
-    const float* target_taps_;
-    float* current_taps_;
-    float* morph_delta_;
+    AccumulateFunctionPtr active_accumulate_function_;
 };
 
-#endif // DENSE_CONVOLUTION_ENGINE_H
\ No newline at end of file
+#endif // DENSE_CONVOLUTION_ENGINE_H
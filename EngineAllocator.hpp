@@ -0,0 +1,297 @@
+#pragma once
+#ifndef ENGINE_ALLOCATOR_H
+#define ENGINE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Page size requested for a buffer, from the largest down.
+ */
+enum class HugePages
+{
+    NONE,          /**< Regular pages. */
+    TRANSPARENT,   /**< 2 MB aligned and advised for transparent huge pages (madvise). */
+    EXPLICIT       /**< Reserved 2 MB hugetlb pages (vm.nr_hugepages); falls back to TRANSPARENT. */
+};
+
+/**
+ * @brief Where EngineAllocator places a buffer.
+ */
+struct BufferPlacement
+{
+    static constexpr int kAnyNode = -1;             /**< No NUMA binding. */
+    static constexpr int kCallingThreadNode = -2;   /**< The node of the CPU running the allocating thread. */
+
+    HugePages huge_pages = HugePages::TRANSPARENT;
+    int       numa_node  = kCallingThreadNode;      /**< A node index, or one of the constants above. */
+};
+
+/**
+ * @brief Owning, movable buffer of floats returned by EngineAllocator, released on destruction.
+ */
+class PlacedBuffer
+{
+public:
+    PlacedBuffer() : data_(nullptr), size_(0), base_(nullptr), mapped_bytes_(0), huge_pages_(HugePages::NONE), numa_node_(-1) {}
+    ~PlacedBuffer() { Release(); }
+
+    PlacedBuffer(const PlacedBuffer&) = delete;
+    PlacedBuffer& operator=(const PlacedBuffer&) = delete;
+    PlacedBuffer(PlacedBuffer&& other) noexcept : PlacedBuffer() { swap(other); }
+    PlacedBuffer& operator=(PlacedBuffer&& other) noexcept
+    {
+        if (this != &other) { Release(); swap(other); }
+        return *this;
+    }
+
+    float* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // What was obtained, after fallbacks: TRANSPARENT means 2 MB aligned and advised
+    HugePages GetHugePages() const { return huge_pages_; }
+    // Node the pages are bound to (preferred, for EXPLICIT), or -1 if unbound
+    int GetNumaNode() const { return numa_node_; }
+
+    /**
+     * @brief Bytes of the buffer currently backed by huge pages: the whole mapping for
+     * EXPLICIT, else what the kernel reports for the mapping in /proc/self/smaps (transparent
+     * huge pages are only assigned on fault, e.g. by the clear in the engine's Init).
+     *
+     * smaps reports per VMA, not per address range. The allocator fences every buffer with
+     * PROT_NONE guard pages so its VMA never merges with a neighbour's, and the count is
+     * exactly the buffer's; a range split by later mprotect/madvise calls on the buffer is
+     * still summed correctly, as all of its VMAs lie inside the mapping.
+     */
+    size_t GetHugePageBytes() const
+    {
+        if (huge_pages_ == HugePages::EXPLICIT) return mapped_bytes_;
+#if defined(__linux__)
+        if (!base_) return 0;
+        FILE* smaps = std::fopen("/proc/self/smaps", "r");
+        if (!smaps) return 0;
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(base_), end = begin + mapped_bytes_;
+        size_t bytes = 0;
+        bool in_range = false;
+        char line[256];
+        while (std::fgets(line, sizeof(line), smaps))
+        {
+            unsigned long long from, to, kib;
+            if (std::sscanf(line, "%llx-%llx ", &from, &to) == 2)
+                in_range = from < end && to > begin;
+            else if (in_range && std::sscanf(line, "AnonHugePages: %llu kB", &kib) == 1)
+                bytes += static_cast<size_t>(kib) * 1024;
+        }
+        std::fclose(smaps);
+        return bytes;
+#else
+        return 0;
+#endif
+    }
+
+private:
+    friend class EngineAllocator;
+
+    void swap(PlacedBuffer& other)
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(base_, other.base_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+        std::swap(huge_pages_, other.huge_pages_);
+        std::swap(numa_node_, other.numa_node_);
+    }
+
+    void Release()
+    {
+        if (!base_) return;
+#if defined(__linux__)
+        munmap(base_, mapped_bytes_);
+#else
+        ::operator delete(base_, std::align_val_t(64));
+#endif
+        base_ = nullptr;
+        data_ = nullptr;
+        size_ = mapped_bytes_ = 0;
+    }
+
+    float*    data_;
+    size_t    size_;            // Floats requested
+    void*     base_;            // Start of the mapping, guard pages included
+    size_t    mapped_bytes_;
+    HugePages huge_pages_;
+    int       numa_node_;
+};
+
+/**
+ * @brief Allocates engine buffers on huge pages and on the NUMA node of the thread that
+ * processes them, to cut TLB misses of the scattered writes into large circular buffers.
+ *
+ * Each buffer is its own anonymous mapping, rounded up to whole 2 MB pages: explicit
+ * hugetlb pages if reserved, else a 2 MB aligned range advised for transparent huge
+ * pages (effective when /sys/kernel/mm/transparent_hugepage/enabled is "madvise" or
+ * "always") between two PROT_NONE guard pages, which keep it from merging with the
+ * mapping next to it. The range is bound to the node with mbind before any page is
+ * touched, so placement does not depend on which thread faults it in. Allocate from the
+ * worker thread with the default placement, or pass its node explicitly.
+ *
+ * Explicit pages are reserved from the global hugetlb pool when the range is mapped, not
+ * from the node's share, so a strict binding could leave the first touch without a page
+ * on that node and the process would get SIGBUS. They are placed with MPOL_PREFERRED
+ * instead: on the node while it has free pages, on another node otherwise.
+ *
+ * Not real-time safe; size requests with the engines' GetBufferSize. Elsewhere than on
+ * Linux buffers come from the aligned operator new, without huge pages or binding.
+ */
+class EngineAllocator
+{
+public:
+    static constexpr size_t kHugePageBytes = 2 * 1024 * 1024;
+
+    /**
+     * @brief NUMA node of the CPU the calling thread runs on, or -1 if unknown.
+     */
+    static int CurrentNumaNode()
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+        return -1;
+    }
+
+    /**
+     * @brief Zero-initialized buffer of num_floats floats, or an empty buffer (data() ==
+     * nullptr) if the memory cannot be mapped.
+     */
+    static PlacedBuffer Allocate(size_t num_floats, const BufferPlacement& placement = {})
+    {
+        PlacedBuffer buffer;
+        const size_t bytes = std::max<size_t>(num_floats, 1) * sizeof(float);
+#if defined(__linux__)
+        HugePages huge_pages = placement.huge_pages;
+        const size_t length = round_up(bytes, huge_pages == HugePages::NONE ? page_size() : kHugePageBytes);
+        void* base = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+        if (huge_pages == HugePages::EXPLICIT)
+        {
+            base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base == MAP_FAILED) huge_pages = HugePages::TRANSPARENT;
+        }
+#else
+        if (huge_pages == HugePages::EXPLICIT) huge_pages = HugePages::TRANSPARENT;
+#endif
+        size_t guard = 0;
+        if (huge_pages != HugePages::EXPLICIT)
+        {
+            void* start = map_guarded(length, huge_pages == HugePages::NONE ? page_size() : kHugePageBytes);
+            if (start == MAP_FAILED) return buffer;
+            guard = page_size();
+            base = static_cast<char*>(start) - guard;
+        }
+        if (huge_pages == HugePages::TRANSPARENT)
+        {
+#if defined(MADV_HUGEPAGE)
+            if (madvise(static_cast<char*>(base) + guard, length, MADV_HUGEPAGE) != 0) huge_pages = HugePages::NONE;
+#else
+            huge_pages = HugePages::NONE;
+#endif
+        }
+
+        void* data = static_cast<char*>(base) + guard;
+        buffer.base_         = base;
+        buffer.mapped_bytes_ = length + 2 * guard;
+        buffer.huge_pages_   = huge_pages;
+        buffer.numa_node_    = bind(data, length, placement.numa_node,
+                                    huge_pages == HugePages::EXPLICIT ? kMpolPreferred : kMpolBind);
+        buffer.data_ = static_cast<float*>(data);
+        buffer.size_ = num_floats;
+        return buffer;
+#else
+        buffer.base_         = ::operator new(bytes, std::align_val_t(64), std::nothrow);
+        if (!buffer.base_) return buffer;
+        buffer.mapped_bytes_ = bytes;
+        std::memset(buffer.base_, 0, bytes);
+        buffer.data_ = static_cast<float*>(buffer.base_);
+        buffer.size_ = num_floats;
+        return buffer;
+#endif
+    }
+
+    /**
+     * @brief Circular buffer for an engine and IR, sized by EngineType::GetBufferSize; size_args
+     * (max_block_frames, and max_morph_length for velvet) are passed on to it.
+     */
+    template <typename EngineType, typename HandleType, typename... SizeArgs>
+    static PlacedBuffer AllocateFor(const HandleType& handle, size_t num_channels, const BufferPlacement& placement = {},
+                                    SizeArgs... size_args)
+    {
+        return Allocate(EngineType::GetBufferSize(handle, num_channels, size_args...), placement);
+    }
+
+private:
+    static size_t round_up(size_t n, size_t alignment) { return (n + alignment - 1) / alignment * alignment; }
+
+#if defined(__linux__)
+    static size_t page_size()
+    {
+        const long size = sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t>(size) : 4096;
+    }
+
+    static constexpr int kMpolPreferred = 1;
+    static constexpr int kMpolBind = 2;
+
+    // Maps length bytes at an alignment-aligned start between two PROT_NONE guard pages;
+    // returns the start, or MAP_FAILED. The whole mapping is [start - page, start + length + page).
+    static void* map_guarded(size_t length, size_t alignment)
+    {
+        const size_t page = page_size();
+        const size_t raw_length = length + alignment + page;
+        void* raw = mmap(nullptr, raw_length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return MAP_FAILED;
+        const uintptr_t raw_begin = reinterpret_cast<uintptr_t>(raw), raw_end = raw_begin + raw_length;
+        const uintptr_t start = round_up(raw_begin + page, alignment);
+        const uintptr_t begin = start - page, end = start + length + page;
+        if (begin > raw_begin) munmap(raw, begin - raw_begin);
+        if (raw_end > end) munmap(reinterpret_cast<void*>(end), raw_end - end);
+        if (mprotect(reinterpret_cast<void*>(start), length, PROT_READ | PROT_WRITE) != 0)
+        {
+            munmap(reinterpret_cast<void*>(begin), end - begin);
+            return MAP_FAILED;
+        }
+        return reinterpret_cast<void*>(start);
+    }
+
+    // Sets the NUMA policy of the (untouched) range with mbind; returns the node, or -1
+    static int bind(void* base, size_t length, int node, int mode)
+    {
+        if (node == BufferPlacement::kCallingThreadNode) node = CurrentNumaNode();
+#if defined(SYS_mbind)
+        constexpr size_t kMaskWords = 16;                       // Up to 1024 nodes
+        constexpr size_t kBitsPerWord = sizeof(unsigned long) * 8;
+        if (node < 0 || static_cast<size_t>(node) >= kMaskWords * kBitsPerWord) return -1;
+        unsigned long mask[kMaskWords] = {};
+        mask[node / kBitsPerWord] = 1ul << (node % kBitsPerWord);
+        if (syscall(SYS_mbind, base, length, mode, mask, kMaskWords * kBitsPerWord + 1, 0) == 0) return node;
+#else
+        (void)base; (void)length; (void)mode;
+#endif
+        return -1;
+    }
+#endif
+};
+
+#endif // ENGINE_ALLOCATOR_H
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef FAN_OUT_CONVOLUTION_ENGINE_H
+#define FAN_OUT_CONVOLUTION_ENGINE_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+
+/**
+ * @brief Convolves one input stream with a list of impulse responses of mixed
+ * Dense/Sparse/Velvet types, producing one output stream per IR.
+ *
+ * Unlike the single-IR engines, which scatter each input sample into their own
+ * output accumulator, this engine keeps a single interleaved history of the input
+ * and gathers every output from it. The input is written once per block no matter
+ * how many IRs are attached, so the per-IR cost is only the multiply-accumulate:
+ * each tap adds one delayed, contiguous slice of the history to its output block.
+ */
+class FanOutConvolutionEngine
+{
+public:
+    FanOutConvolutionEngine() : handles_(nullptr), num_irs_(0), history_(nullptr), history_size_(0),
+                                num_channels_(0), write_head_(0), max_block_(0) {}
+    ~FanOutConvolutionEngine() {}
+
+    /**
+     * @param handles Array of num_irs IR references. Neither the array nor the handles are
+     * copied; they must outlive the engine.
+     * @param history_buffer Input history storage of history_size samples. It must hold the
+     * longest IR (history_size >= max ir_length * num_channels); any extra room lets Process
+     * handle longer blocks in a single pass.
+     * @return false if the history is too short; Process then writes silence.
+     */
+    bool Init(const IRHandleRef* handles, size_t num_irs, float* history_buffer, size_t history_size, size_t num_channels)
+    {
+        handles_      = handles;
+        num_irs_      = num_irs;
+        history_      = history_buffer;
+        history_size_ = history_size;
+        num_channels_ = num_channels;
+        write_head_   = 0;
+
+        assert(handles_ || (num_irs_ == 0)); // != NULL
+        assert(history_);                    // != NULL
+        assert(num_channels_);               // > 0
+
+        size_t max_length = 0;
+        for (size_t i = 0; i < num_irs_; i++)
+            max_length = std::max(max_length, ir_length(handles_[i]));
+
+        // Frames that can be appended before the oldest sample still needed is overwritten;
+        // a history shorter than the longest IR is rejected and Process writes silence
+        const size_t history_frames = history_size_ / num_channels_;
+        const size_t min_frames = std::max<size_t>(max_length, 1);
+        max_block_ = (history_frames >= min_frames) ? history_frames - min_frames + 1 : 0;
+
+        // Init empty history
+        std::fill(history_, history_ + history_size_, 0.0f);
+        return max_block_ > 0;
+    }
+
+    /**
+     * @param in Interleaved input of size frames.
+     * @param outs Array of num_irs interleaved outputs of size frames each; overwritten.
+     */
+    void Process(const float* in, float* const* outs, size_t size)
+    {
+        const size_t num_ch = num_channels_;
+
+        if (max_block_ == 0)
+        {
+            for (size_t i = 0; i < num_irs_; i++) std::fill(outs[i], outs[i] + size * num_ch, 0.0f);
+            return;
+        }
+
+        for (size_t done = 0; done < size; )
+        {
+            const size_t block = std::min(size - done, max_block_);
+            const size_t count = block * num_ch;
+
+            // Append the block to the shared history
+            const float* src = in + done * num_ch;
+            const size_t first = std::min(count, history_size_ - write_head_);
+            std::copy(src, src + first, history_ + write_head_);
+            std::copy(src + first, src + count, history_);
+
+            // Gather every output from it
+            for (size_t i = 0; i < num_irs_; i++)
+            {
+                float* out = outs[i] + done * num_ch;
+                std::fill(out, out + count, 0.0f);
+
+                const IRHandleRef& handle = handles_[i];
+                switch (handle.type)
+                {
+                    case IRHandleType::DENSE:
+                        for (size_t t = 0; t < handle.dense->num_taps; t++)
+                            gather_tap(out, t * num_ch, handle.dense->taps[t], count);
+                        break;
+                    case IRHandleType::SPARSE:
+                        for (size_t t = 0; t < handle.sparse->num_taps; t++)
+                            gather_tap(out, handle.sparse->positions[t] * num_ch, handle.sparse->values[t], count);
+                        break;
+                    case IRHandleType::VELVET:
+                        for (size_t t = 0; t < handle.velvet->num_pos_taps; t++)
+                            gather_tap(out, handle.velvet->pos_taps[t] * num_ch, 1.0f, count);
+                        for (size_t t = 0; t < handle.velvet->num_neg_taps; t++)
+                            gather_tap(out, handle.velvet->neg_taps[t] * num_ch, -1.0f, count);
+                        break;
+                }
+            }
+
+            // Advance history head
+            write_head_ += count;
+            if (write_head_ >= history_size_) write_head_ -= history_size_;
+            done += block;
+        }
+    }
+
+    size_t GetNumIRs() const { return num_irs_; }
+
+protected:
+    // Adds the block's input delayed by offset samples (< history_size_), scaled by gain, to out
+    void gather_tap(float* out, size_t offset, float gain, size_t count) const
+    {
+        size_t start = write_head_ + history_size_ - offset;
+        if (start >= history_size_) start -= history_size_;
+        ConvolutionUtils::gather_block(out, history_, history_size_, start, gain, count);
+    }
+
+    const IRHandleRef* handles_;
+    size_t             num_irs_;
+
+    // Shared interleaved input history
+    float*             history_;
+    size_t             history_size_;
+    size_t             num_channels_;
+    size_t             write_head_;
+    size_t             max_block_;
+};
+
+#endif // FAN_OUT_CONVOLUTION_ENGINE_H
@@ -0,0 +1,295 @@
+#pragma once
+#ifndef FEEDBACK_DELAY_NETWORK_H
+#define FEEDBACK_DELAY_NETWORK_H
+
+#include "ConvolutionUtils.hpp"
+#include "VelvetConvolutionEngine.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+enum class FeedbackMatrix
+{
+    HADAMARD,                    /**< Normalized Walsh-Hadamard, num_lines a power of two. */
+    HOUSEHOLDER                  /**< I - 2/N * ones, any num_lines. */
+};
+
+/**
+ * @brief Feedback delay network reverb: num_lines delay lines whose outputs are mixed
+ * by an orthogonal feedback matrix, attenuated for the decay time and fed back with
+ * the input.
+ *
+ * All lines share one circular buffer, interleaved like the engines' multichannel
+ * buffers with a "channel" per line, so a frame holds one cell per line and the
+ * lines are walked with the same layouts (QUAD for 4 lines, and so on). Line i is
+ * fed by audio channel i % num_channels and sums into it.
+ *
+ * A sample fed back now is read again no sooner than the shortest delay, so a whole
+ * block of that many frames depends only on what is already in the buffer. Process
+ * therefore runs block-wise: read every frame of the block, mix them all, then write
+ * each line's block back with one strided pass, instead of one frame at a time.
+ *
+ * Optional diffusers (e.g. a velvet or sparse engine with a short noise IR, same
+ * channel count) smear the input before the network and/or the output after it.
+ * They run in place on the output buffer.
+ */
+template <typename DiffuserType = VelvetConvolutionEngine>
+class FeedbackDelayNetwork
+{
+public:
+    using WrappingMode = ConvolutionUtils::WrappingMode;
+    using ChannelLayout = ConvolutionUtils::ChannelLayout;
+    using ProcessFunctionPtr = void (FeedbackDelayNetwork::*)(const float*, float*, size_t);
+
+    static constexpr size_t kMaxLines = 32;
+
+    FeedbackDelayNetwork() : input_diffuser_(nullptr), output_diffuser_(nullptr), active_process_function_(nullptr) {}
+    ~FeedbackDelayNetwork() {}
+
+    /**
+     * @param delays num_lines delays in frames, each >= 1. Mutually prime lengths give the densest echoes.
+     * @param num_lines In [1, kMaxLines], a power of two for HADAMARD, at least num_channels.
+     * @param rt60_frames Time for the recirculating energy to decay by 60 dB.
+     * @param delay_buffer Storage of buffer_size samples, at least GetMinBufferSize(delays, num_lines)
+     * and a multiple of num_lines. Room beyond the longest delay allows longer blocks.
+     */
+    void Init(const size_t* delays, size_t num_lines, FeedbackMatrix matrix, float rt60_frames,
+              float* delay_buffer, size_t buffer_size, size_t num_channels)
+    {
+        circ_buffer_  = delay_buffer;
+        buffer_size_  = buffer_size;
+        num_lines_    = num_lines;
+        num_channels_ = num_channels;
+        matrix_       = matrix;
+        write_head_   = 0;
+        input_diffuser_  = nullptr;
+        output_diffuser_ = nullptr;
+
+        assert(circ_buffer_);                                  // != NULL
+        assert(num_lines_ >= 1 && num_lines_ <= kMaxLines);
+        assert(num_channels_ >= 1 && num_channels_ <= num_lines_);
+        assert(matrix_ != FeedbackMatrix::HADAMARD || ConvolutionUtils::is_power_of_two(num_lines_));
+        assert(buffer_size_ % num_lines_ == 0);
+        assert(buffer_size_ >= GetMinBufferSize(delays, num_lines_));
+
+        size_t min_delay = SIZE_MAX, max_delay = 0;
+        for (size_t i = 0; i < num_lines_; i++)
+        {
+            assert(delays[i] >= 1);
+            delays_[i] = delays[i];
+            line_channel_[i] = i % num_channels_;
+            min_delay = std::min(min_delay, delays[i]);
+            max_delay = std::max(max_delay, delays[i]);
+        }
+
+        // Frames read before any of them is fed back (min_delay), and whose write-back,
+        // up to max_delay frames further on, cannot wrap onto the block itself
+        max_block_ = std::min(min_delay, buffer_size_ / num_lines_ - max_delay);
+
+		// Init empty buffer
+        std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
+        SetDecay(rt60_frames);
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+
+        // Dispatch to the correct template specialization based on the line count
+        // and WrappingMode
+        if (num_lines_ == 1)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MONO);
+		}
+        else if (num_lines_ == 2)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::STEREO);
+		}
+        else if (num_lines_ == 4)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::QUAD);
+		}
+        else
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MULTICHANNEL);
+		}
+    }
+
+    /**
+     * @brief Smallest delay buffer (in samples): the longest delay plus one frame, per line.
+     */
+    static size_t GetMinBufferSize(const size_t* delays, size_t num_lines)
+    {
+        const size_t max_delay = *std::max_element(delays, delays + num_lines);
+        return (max_delay + 1) * num_lines;
+    }
+
+    /**
+     * @brief Sets the per-line attenuation for a decay time, effective from the next Process.
+     */
+    void SetDecay(float rt60_frames)
+    {
+        assert(rt60_frames > 0.0f);
+        // The Hadamard normalization is folded into the gains
+        const float norm = (matrix_ == FeedbackMatrix::HADAMARD) ? 1.0f / std::sqrt(static_cast<float>(num_lines_)) : 1.0f;
+        for (size_t i = 0; i < num_lines_; i++)
+            line_gain_[i] = norm * std::pow(10.0f, -3.0f * static_cast<float>(delays_[i]) / rt60_frames);
+    }
+
+    /**
+     * @brief Attaches initialized diffusers with num_channels channels (nullptr for none).
+     * Each must support in-place Process.
+     */
+    void SetDiffusers(DiffuserType* input_diffuser, DiffuserType* output_diffuser = nullptr)
+    {
+        input_diffuser_  = input_diffuser;
+        output_diffuser_ = output_diffuser;
+    }
+
+    /**
+     * @brief Frames processed per block: the shortest delay, or less if the buffer has no spare room.
+     */
+    size_t GetMaxBlock() const { return max_block_; }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        (this->*active_process_function_)(in, out, size);
+    }
+
+protected:
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessImpl(const float* in, float* out, size_t size)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+
+        // The diffused input goes through the output buffer, which the network then reads in place
+        if (input_diffuser_)
+        {
+            input_diffuser_->Process(in, out, size);
+            in = out;
+        }
+
+        float* block_out = out;
+        for (size_t done = 0; done < size; )
+        {
+            const size_t block = std::min(size - done, max_block_);
+            ProcessBlock<WMode, CLayout>(in + done * num_ch, block_out, block);
+            block_out += block * num_ch;
+            done += block;
+        }
+
+        if (output_diffuser_) output_diffuser_->Process(out, out, size);
+    }
+
+    // One block of at most max_block_ frames
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessBlock(const float* in, float* out, size_t block)
+    {
+        const size_t num_ch = num_channels_;
+        const size_t num_lines = ConvolutionUtils::channel_count<CLayout>(num_lines_);
+
+        // 1) Every frame of the block: sum the line outputs into the output, then replace
+        // them, in place, by the signal to feed back: gain * (matrix * lines) + input
+        float input[kMaxLines];
+        for (size_t b = 0; b < block; b++)
+        {
+            float* frame = circ_buffer_ + ConvolutionUtils::wrap_address<WMode>(write_head_ + b * num_lines, buffer_size_);
+            float* y = out + b * num_ch;
+
+            std::copy(in + b * num_ch, in + (b + 1) * num_ch, input);  // in may alias out
+            std::fill(y, y + num_ch, 0.0f);
+            ConvolutionUtils::for_each_channel<CLayout>([&](size_t i) { y[line_channel_[i]] += frame[i]; }, num_lines);
+
+            mix<CLayout>(frame, num_lines);
+            ConvolutionUtils::for_each_channel<CLayout>([&](size_t i) {
+                frame[i] = frame[i] * line_gain_[i] + input[line_channel_[i]];
+            }, num_lines);
+        }
+
+        // 2) Each line writes its block back delay frames ahead. Nothing lands inside the
+        // block, which is no longer than the shortest delay.
+        for (size_t i = 0; i < num_lines; i++)
+        {
+            size_t src = ConvolutionUtils::wrap_address<WMode>(write_head_ + i, buffer_size_);
+            size_t dst = ConvolutionUtils::wrap_address<WMode>(write_head_ + delays_[i] * num_lines + i, buffer_size_);
+            for (size_t b = 0; b < block; b++)
+            {
+                circ_buffer_[dst] = circ_buffer_[src];
+                src = ConvolutionUtils::wrap_address<WMode>(src + num_lines, buffer_size_);
+                dst = ConvolutionUtils::wrap_address<WMode>(dst + num_lines, buffer_size_);
+            }
+        }
+
+        // Advance buffer head
+        write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + block * num_lines, buffer_size_);
+    }
+
+    // Applies the feedback matrix to one frame of line outputs, in place
+    template <ChannelLayout CLayout>
+    void mix(float* frame, size_t num_lines) const
+    {
+        if (matrix_ == FeedbackMatrix::HADAMARD)
+        {
+            // Fast Walsh-Hadamard transform, unnormalized (see SetDecay)
+            for (size_t h = 1; h < num_lines; h <<= 1)
+                for (size_t j = 0; j < num_lines; j += 2 * h)
+                    for (size_t k = j; k < j + h; k++)
+                    {
+                        const float a = frame[k], b = frame[k + h];
+                        frame[k]     = a + b;
+                        frame[k + h] = a - b;
+                    }
+        }
+        else
+        {
+            // Householder reflection: subtract 2/N of the sum from every line
+            float sum = 0.0f;
+            ConvolutionUtils::for_each_channel<CLayout>([&](size_t i) { sum += frame[i]; }, num_lines);
+            const float reflect = sum * 2.0f / static_cast<float>(num_lines);
+            ConvolutionUtils::for_each_channel<CLayout>([&](size_t i) { frame[i] -= reflect; }, num_lines);
+        }
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void set_process_function(WrappingMode)
+    {
+        active_process_function_ = &FeedbackDelayNetwork::template ProcessImpl<WMode, CLayout>;
+    }
+
+    void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
+    {
+		// POWER OF TWO
+        if (wrapping_mode == WrappingMode::POWER_OF_TWO) {
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        } else { // ARBITRARY
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        }
+    }
+
+    // Shared delay buffer, one interleaved cell per line and frame
+    size_t write_head_;
+    size_t buffer_size_;
+    size_t num_lines_;
+    size_t num_channels_;
+    float* circ_buffer_;
+    size_t max_block_;
+
+    // Network
+    FeedbackMatrix matrix_;
+    size_t delays_[kMaxLines];
+    float  line_gain_[kMaxLines];
+    size_t line_channel_[kMaxLines];
+
+    DiffuserType* input_diffuser_;
+    DiffuserType* output_diffuser_;
+
+    ProcessFunctionPtr active_process_function_;
+};
+
+#endif // FEEDBACK_DELAY_NETWORK_H
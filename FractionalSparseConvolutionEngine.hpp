@@ -0,0 +1,506 @@
+#pragma once
+#ifndef FRACTIONAL_SPARSE_CONVOLUTION_ENGINE_H
+#define FRACTIONAL_SPARSE_CONVOLUTION_ENGINE_H
+
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief A handle for a sparse impulse response whose tap positions are fractional.
+ */
+struct FractionalSparseIRHandle
+{
+    const float*  positions;     /**< Pointer to the array of tap positions, in frames (>= 0). */
+    const float*  values;        /**< Pointer to the array of corresponding tap values. */
+    size_t        num_taps;      /**< The number of sparse taps. */
+};
+
+/**
+ * @brief How a tap between two frames is spread over the circular buffer.
+ */
+enum class FractionalInterpolation
+{
+    LINEAR,                      /**< 2 cells; positions >= 0. */
+    CUBIC                        /**< 4-cell Lagrange, flatter passband; positions >= 1. */
+};
+
+/**
+ * @brief A sparse convolution engine with fractional, modulatable tap positions, for
+ * moving early reflections and Doppler.
+ *
+ * Each input frame is written at every tap through an interpolating kernel (2 or 4
+ * cells), so a tap position can move smoothly instead of jumping a whole frame.
+ * SetTapPositions glides the positions to new targets with per-frame ramping, which
+ * does not click. The kernel is a Farrow structure: while the taps are at rest, each
+ * block is filtered once into one stream per power of the fraction, and a tap adds a
+ * gain-weighted sum of the streams over all its cells in one pass. While ramping, a tap
+ * keeps its cells between the frames where it crosses into the next one; over each such
+ * span its weighted input is computed per sample into scratch rows and summed into the
+ * buffer in one pass. The inner loops run over fixed-length lanes, so they vectorize.
+ */
+class FractionalSparseConvolutionEngine
+{
+    friend class ConvolutionTest;
+    template<typename EngineType> friend class EngineWrapperImpl;
+public:
+    using WrappingMode = ConvolutionUtils::WrappingMode;
+    using ChannelLayout = ConvolutionUtils::ChannelLayout;
+    using ProcessFunctionPtr = void (FractionalSparseConvolutionEngine::*)(const float*, float*, size_t);
+
+    // Taps whose gains are held on the stack at once
+    static constexpr size_t kChunkTaps = 64;
+
+    // Samples of each scratch row on the stack: a block of input, or of one stream, with
+    // its interpolation padding. 512 frames mono, 256 stereo
+    static constexpr size_t kScratchSamples = 512 + 48;
+
+    FractionalSparseConvolutionEngine() : positions_(nullptr), steps_(nullptr), targets_(nullptr), values_(nullptr),
+                                          num_taps_(0), ramp_frames_left_(0), reach_(0), tail_length_(0),
+                                          active_process_function_(nullptr) {}
+    ~FractionalSparseConvolutionEngine() {}
+
+    /**
+     * @brief Floats of tap state storage Init needs for num_taps taps.
+     */
+    static size_t GetTapBufferSize(size_t num_taps) { return 3 * num_taps; }
+
+    /**
+     * @param handle Initial tap positions and the tap values; the values must outlive the engine,
+     * the positions are copied.
+     * @param tap_buffer Storage of GetTapBufferSize(handle.num_taps) floats for the modulated positions.
+     * @param buffer_size Must hold the furthest reach of any position the taps will take, plus the
+     * interpolation span: (floor(max position) + 2, or + 3 for CUBIC) * num_channels.
+     * @param num_channels At most kScratchSamples / 7 (80).
+     */
+    void Init(const FractionalSparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              float* tap_buffer, FractionalInterpolation interpolation = FractionalInterpolation::LINEAR)
+    {
+        circ_buffer_   = circ_buffer;
+        buffer_size_   = buffer_size;
+        num_channels_  = num_channels;
+        write_head_    = 0;
+        interpolation_ = interpolation;
+
+        assert(circ_buffer_);   // != NULL
+        assert(buffer_size_);   // > 0
+        assert(num_channels_);  // > 0
+        // A cubic block of one frame and its padding must fit a scratch row
+        assert(num_channels_ <= kScratchSamples / 7);
+
+        // Init empty buffer
+        std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
+        tail_.Reset();
+
+        values_   = handle.values;
+        num_taps_ = handle.num_taps;
+        assert((handle.positions && values_ && tap_buffer) || (num_taps_ == 0));
+        positions_ = tap_buffer;
+        steps_     = tap_buffer + num_taps_;
+        targets_   = tap_buffer + 2 * num_taps_;
+
+        ramp_frames_left_ = 0;
+        SetTapPositions(handle.positions, 0);
+        tail_length_ = reach_;
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+
+        // Dispatch to the correct template specialization based on runtime channel count
+        // and WrappingMode
+        if (num_channels_ == 1)
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MONO);
+        else if (num_channels_ == 2)
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::STEREO);
+        else if (num_channels_ == 4)
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::QUAD);
+        else
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MULTICHANNEL);
+    }
+
+    /**
+     * @brief Moves every tap to new positions (num_taps of them), linearly over ramp_frames
+     * output frames starting with the next processed frame, or at once if ramp_frames is 0.
+     * A ramp in progress continues from where it is. Real-time safe.
+     */
+    void SetTapPositions(const float* positions, size_t ramp_frames)
+    {
+        float max_position = 0.0f;
+        for (size_t t = 0; t < num_taps_; t++)
+        {
+            assert(positions[t] >= min_position());
+            targets_[t] = positions[t];
+            steps_[t]   = ramp_frames ? (positions[t] - positions_[t]) / static_cast<float>(ramp_frames) : 0.0f;
+            if (!ramp_frames) positions_[t] = positions[t];
+            max_position = std::max(max_position, std::max(positions_[t], positions[t]));
+        }
+        ramp_frames_left_ = ramp_frames;
+
+        // Frames ahead of the head that the taps can write while getting there
+        reach_ = num_taps_ ? static_cast<size_t>(max_position) + num_points() : 0;
+        assert(reach_ <= buffer_size_ / num_channels_);
+    }
+
+    /**
+     * @brief Current (possibly mid-ramp) position of a tap.
+     */
+    float GetTapPosition(size_t tap) const { assert(tap < num_taps_); return positions_[tap]; }
+
+    bool IsRamping() const { return ramp_frames_left_ > 0; }
+
+    /**
+     * @brief True while the input has been silent for at least the IR length, i.e. the
+     * output buffer is drained and Process only writes zeros.
+     */
+    bool IsIdle() const { return tail_.IsIdle(); }
+
+    /**
+     * @brief Attaches a counter, typically shared by all voices, of how many engines are idle.
+     */
+    void SetIdleCounter(std::atomic<size_t>* counter) { tail_.SetIdleCounter(counter); }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        (this->*active_process_function_)(in, out, size);
+    }
+
+protected:
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessImpl(const float* in, float* out, size_t size)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+        const size_t silent = ConvolutionUtils::trailing_silent_frames(in, size, num_ch);
+
+        // Writes made from longer positions than the current ones may still be in the buffer
+        tail_length_ = std::max(tail_length_, reach_);
+
+        // Drained buffer and silent input: the output stays zero, only the head and the taps move
+        if (tail_.IsIdle() && silent == size)
+        {
+            std::fill(out, out + size * num_ch, 0.0f);
+            write_head_ = (write_head_ + size * num_ch) % buffer_size_;
+            advance_ramp(size);
+        }
+        else if (interpolation_ == FractionalInterpolation::CUBIC)
+        {
+            ProcessKernel<WMode, CLayout, 4>(in, out, size);
+        }
+        else
+        {
+            ProcessKernel<WMode, CLayout, 2>(in, out, size);
+        }
+        tail_.Update(silent, size, tail_length_);
+        if (tail_.IsIdle()) tail_length_ = reach_;
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout, size_t Points>
+    void ProcessKernel(const float* in, float* out, size_t size)
+    {
+        const size_t num_ch = num_channels_;
+
+        // Writes reach (block + reach - 1) frames ahead, which must not wrap onto unread cells,
+        // and a block and its padding must fit the scratch rows
+        const size_t buffer_frames = buffer_size_ / num_ch;
+        const size_t max_block = std::min(buffer_frames - reach_ + 1, pass_frames<Points>());
+        while (size > 0)
+        {
+            size_t block = std::min(size, max_block);
+            if (ramp_frames_left_ == 0)
+            {
+                scatter_at_rest<WMode, Points>(in, block);
+            }
+            else
+            {
+                block = std::min(block, ramp_frames_left_);
+                scatter_ramping<WMode, CLayout, Points>(in, block);
+            }
+
+            for (size_t smp = 0; smp < block; smp++)
+            {
+                ConvolutionUtils::extract_frame<WMode, CLayout>(circ_buffer_, buffer_size_, write_head_, out + smp * num_ch, num_ch, nullptr);
+                write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + num_ch, buffer_size_);
+            }
+            advance_ramp(block);
+
+            in   += block * num_ch;
+            out  += block * num_ch;
+            size -= block;
+        }
+    }
+
+    /**
+     * Taps at rest, Farrow structure: each cell weight is a polynomial in the fraction d, so the
+     * block is filtered once into one stream per power of d, and a tap adds
+     * sum_k (value * d^k) * stream_k over its cells in a single pass.
+     */
+    template <WrappingMode WMode, size_t Points>
+    void scatter_at_rest(const float* in, size_t block)
+    {
+        const size_t num_ch = num_channels_;
+        const size_t pad = (Points - 1) * num_ch;
+        const size_t count = block * num_ch + pad;
+        float padded[kScratchSamples];
+        float basis[Points][kScratchSamples];
+
+        // The block between Points - 1 silent frames on each side, so every stream sample reads
+        // all its input frames
+        std::fill(padded, padded + pad, 0.0f);
+        std::copy(in, in + block * num_ch, padded + pad);
+        std::fill(padded + pad + block * num_ch, padded + count + pad, 0.0f);
+        farrow_basis<Points>(padded, num_ch, count, basis);
+
+        const float* rows[Points];
+        for (size_t k = 0; k < Points; k++) rows[k] = basis[k];
+
+        size_t offsets[kChunkTaps];
+        float  gains[Points][kChunkTaps];
+        for (size_t t0 = 0; t0 < num_taps_; t0 += kChunkTaps)
+        {
+            const size_t chunk = std::min(kChunkTaps, num_taps_ - t0);
+            compute_gains<Points>(t0, chunk, offsets, gains);
+
+            for (size_t t = 0; t < chunk; t++)
+            {
+                float tap_gains[Points];
+                for (size_t k = 0; k < Points; k++) tap_gains[k] = gains[k][t];
+                const size_t start = ConvolutionUtils::wrap_address<WMode>(write_head_ + offsets[t], buffer_size_);
+                ConvolutionUtils::scatter_basis<Points>(circ_buffer_, buffer_size_, start, rows, tap_gains, count);
+            }
+        }
+    }
+
+    /**
+     * Ramping taps over block frames: a tap's position moves linearly, so its cells stay put
+     * until it crosses into the next frame. Over each span between crossings the weighted
+     * input of every cell is computed per sample, from the fraction at that frame, into
+     * padded rows, and the cells are summed into the buffer in a single pass.
+     */
+    template <WrappingMode WMode, ChannelLayout CLayout, size_t Points>
+    void scatter_ramping(const float* in, size_t block)
+    {
+        const size_t num_ch = ConvolutionUtils::channel_count<CLayout>(num_channels_);
+        const size_t pad = (Points - 1) * num_ch;
+        float products[Points][kScratchSamples];
+
+        // Row p is read p frames late, so each span ends with a pad of silence; the leading pad
+        // is never written
+        const float* rows[Points];
+        for (size_t p = 0; p < Points; p++)
+        {
+            std::fill(products[p], products[p] + pad, 0.0f);
+            rows[p] = products[p] + pad - p * num_ch;
+        }
+
+        // Frame of each sample from the start of a span, shared by the taps
+        float frames[kScratchSamples];
+        for (size_t j = 0; j < block * num_ch; j++) frames[j] = static_cast<float>(j / num_ch);
+
+        for (size_t t = 0; t < num_taps_; t++)
+        {
+            const float position = positions_[t];
+            const float step = steps_[t];
+            const float value = values_[t];
+
+            for (size_t first = 0; first < block; )
+            {
+                // Frame of the tap over this span, and the first frame past its end
+                const float start_position = std::max(position + step * static_cast<float>(first), min_position());
+                const size_t whole = static_cast<size_t>(start_position);
+                float crossing = static_cast<float>(block);
+                if (step > 0.0f)      crossing = std::ceil((static_cast<float>(whole + 1) - position) / step);
+                else if (step < 0.0f) crossing = std::floor((position - static_cast<float>(whole)) / -step) + 1.0f;
+                const size_t last = crossing >= static_cast<float>(block) ? block
+                                  : std::max(first + 1, static_cast<size_t>(std::max(crossing, 0.0f)));
+                const size_t samples = (last - first) * num_ch;
+
+                const float base = position + step * static_cast<float>(first) - static_cast<float>(whole);
+                ramp_products<Points>(in + first * num_ch, frames, samples, base, step, value, products, pad);
+                for (size_t p = 0; p < Points; p++)
+                    std::fill(products[p] + pad + samples, products[p] + 2 * pad + samples, 0.0f);
+
+                const size_t cell = (Points == 2 ? whole : whole - 1) + first;
+                const size_t start = ConvolutionUtils::wrap_address<WMode>(write_head_ + cell * num_ch, buffer_size_);
+                ConvolutionUtils::scatter_basis<Points>(circ_buffer_, buffer_size_, start, rows, nullptr, samples + pad);
+                first = last;
+            }
+        }
+    }
+
+    /**
+     * Streams of the Farrow structure: stream k at sample j is sum_p c[p][k] * x[j - p * num_ch],
+     * j in [0, count), where c[p][k] is the coefficient of d^k in the weight of cell p and x
+     * is padded, read from Points - 1 frames in.
+     */
+    template <size_t Points>
+    static void farrow_basis(const float* __restrict padded, size_t num_ch, size_t count,
+                             float (*__restrict basis)[kScratchSamples])
+    {
+        size_t i = 0;
+        for (; i + ConvolutionUtils::kLaneBlock <= count; i += ConvolutionUtils::kLaneBlock)
+            for (size_t j = i; j < i + ConvolutionUtils::kLaneBlock; j++) farrow_sample<Points>(padded, num_ch, j, basis);
+        for (; i < count; i++) farrow_sample<Points>(padded, num_ch, i, basis);
+    }
+
+    template <size_t Points>
+    static void farrow_sample(const float* padded, size_t num_ch, size_t j, float (*basis)[kScratchSamples])
+    {
+        // x_p is the input p frames before sample j
+        const float x0 = padded[j + (Points - 1) * num_ch], x1 = padded[j + (Points - 2) * num_ch];
+        if constexpr (Points == 2)
+        {
+            // 1 - d, d
+            basis[0][j] = x0;
+            basis[1][j] = x1 - x0;
+        }
+        else
+        {
+            // -d (d - 1) (d - 2) / 6, (d + 1) (d - 1) (d - 2) / 2, -(d + 1) d (d - 2) / 2, (d + 1) d (d - 1) / 6
+            const float x2 = padded[j + num_ch], x3 = padded[j];
+            basis[0][j] = x1;
+            basis[1][j] = x2 - 0.5f * x1 - (1.0f / 3.0f) * x0 - (1.0f / 6.0f) * x3;
+            basis[2][j] = 0.5f * (x0 + x2) - x1;
+            basis[3][j] = 0.5f * (x1 - x2) + (1.0f / 6.0f) * (x3 - x0);
+        }
+    }
+
+    /**
+     * products[p][pad + j] = weight of cell p at the frame of sample j times in[j], j in
+     * [0, samples), with the fraction base + step * frames[j].
+     */
+    template <size_t Points>
+    static void ramp_products(const float* __restrict in, const float* __restrict frames, size_t samples, float base,
+                              float step, float value, float (*__restrict products)[kScratchSamples], size_t pad)
+    {
+        size_t i = 0;
+        for (; i + ConvolutionUtils::kLaneBlock <= samples; i += ConvolutionUtils::kLaneBlock)
+            for (size_t j = i; j < i + ConvolutionUtils::kLaneBlock; j++)
+                ramp_sample<Points>(in[j], base + step * frames[j], value, products, pad + j);
+        for (; i < samples; i++) ramp_sample<Points>(in[i], base + step * frames[i], value, products, pad + i);
+    }
+
+    /**
+     * Lagrange weights of fraction d, scaled by v, times x into rows[p][j]: cells whole and
+     * whole + 1 (LINEAR), or whole - 1 .. whole + 2 (CUBIC). The cubic weights
+     * -d (d - 1) (d - 2) / 6, (d + 1) (d - 1) (d - 2) / 2, -(d + 1) d (d - 2) / 2 and
+     * (d + 1) d (d - 1) / 6 share their products in pairs.
+     */
+    template <size_t Points>
+    static void ramp_sample(float x, float d, float v, float (*rows)[kScratchSamples], size_t j)
+    {
+        if constexpr (Points == 2)
+        {
+            const float upper = v * x * d;
+            rows[0][j] = v * x - upper;
+            rows[1][j] = upper;
+        }
+        else
+        {
+            const float dp1 = d + 1.0f, om = 1.0f - d, m2d = 2.0f - d;
+            const float outer = d * om * (x * v * (-1.0f / 6.0f));
+            const float inner = dp1 * m2d * (x * v * 0.5f);
+            rows[0][j] = outer * m2d;
+            rows[1][j] = inner * om;
+            rows[2][j] = inner * d;
+            rows[3][j] = outer * dp1;
+        }
+    }
+
+    /**
+     * Farrow gains value * d^k of taps [t0, t0 + count) and the channel strided offset of
+     * their first cell. Branch-free, so the loop vectorizes.
+     */
+    template <size_t Points>
+    void compute_gains(size_t t0, size_t count, size_t* offsets, float (*gains)[kChunkTaps]) const
+    {
+        const size_t num_ch = num_channels_;
+        const float* positions = positions_ + t0;
+        const float* values = values_ + t0;
+
+        for (size_t t = 0; t < count; t++)
+        {
+            const float position = positions[t];
+            // position >= 0, so truncation is floor
+            const size_t whole = static_cast<size_t>(position);
+            const float d = position - static_cast<float>(whole);
+            offsets[t] = (Points == 2 ? whole : whole - 1) * num_ch;
+            float gain = values[t];
+            for (size_t k = 0; k < Points; k++)
+            {
+                gains[k][t] = gain;
+                gain *= d;
+            }
+        }
+    }
+
+    // Longest block whose samples, with Points - 1 frames of padding on each side, fit a scratch row
+    template <size_t Points>
+    size_t pass_frames() const { return kScratchSamples / num_channels_ - 2 * (Points - 1); }
+
+    // Moves the taps frames output frames along their ramp, landing exactly on the targets
+    void advance_ramp(size_t frames)
+    {
+        if (ramp_frames_left_ == 0) return;
+        if (frames >= ramp_frames_left_)
+        {
+            std::copy(targets_, targets_ + num_taps_, positions_);
+            ramp_frames_left_ = 0;
+            return;
+        }
+        const float scale = static_cast<float>(frames);
+        for (size_t t = 0; t < num_taps_; t++) positions_[t] += steps_[t] * scale;
+        ramp_frames_left_ -= frames;
+    }
+
+    size_t num_points() const { return interpolation_ == FractionalInterpolation::CUBIC ? 3 : 2; }
+    float min_position() const { return interpolation_ == FractionalInterpolation::CUBIC ? 1.0f : 0.0f; }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void set_process_function(WrappingMode)
+    {
+        active_process_function_ = &FractionalSparseConvolutionEngine::ProcessImpl<WMode, CLayout>;
+    }
+
+    void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
+    {
+        // POWER OF TWO
+        if (wrapping_mode == WrappingMode::POWER_OF_TWO) {
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        } else { // ARBITRARY
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        }
+    }
+
+    size_t write_head_;
+    size_t buffer_size_;
+    size_t num_channels_;
+    float* circ_buffer_;
+    FractionalInterpolation interpolation_;
+
+    // Tap state in the caller's buffer: current positions, per-frame ramp steps, ramp targets
+    float*       positions_;
+    float*       steps_;
+    float*       targets_;
+    const float* values_;
+    size_t       num_taps_;
+    size_t       ramp_frames_left_;
+
+    // Frames the taps can reach while ramping, and the longest reach since the buffer drained
+    size_t       reach_;
+    size_t       tail_length_;
+
+    // Silence tracking for the idle fast path
+    ConvolutionUtils::TailTracker tail_;
+
+    ProcessFunctionPtr active_process_function_;
+};
+
+#endif // FRACTIONAL_SPARSE_CONVOLUTION_ENGINE_H
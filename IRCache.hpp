@@ -0,0 +1,402 @@
+#pragma once
+#ifndef IR_CACHE_H
+#define IR_CACHE_H
+
+#include "IRHandle.hpp"
+#include "SparseConvolutionEngine.hpp"
+#include "VelvetConvolutionEngine.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Bitwise comparison of n elements, as the cache hashes bytes (so -0.0f differs from 0.0f)
+template <typename T>
+inline bool same_bytes(const T* a, const T* b, size_t n)
+{
+    return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+}
+
+/**
+ * @brief Dense IR as held by IRCache: an owned copy of the taps.
+ */
+struct PreparedDenseIR
+{
+    explicit PreparedDenseIR(const DenseIRHandle& source)
+        : taps(source.taps, source.taps + source.num_taps)
+    {
+        handle = { taps.data(), taps.size() };
+        length = ir_length(handle);
+    }
+    PreparedDenseIR(const PreparedDenseIR&) = delete;
+    PreparedDenseIR& operator=(const PreparedDenseIR&) = delete;
+
+    size_t Bytes() const { return sizeof(*this) + taps.size() * sizeof(float); }
+
+    // Whether this was prepared from the given contents, compared bit for bit like the hash
+    bool Matches(const DenseIRHandle& source) const
+    {
+        return source.num_taps == taps.size() && same_bytes(source.taps, taps.data(), taps.size());
+    }
+
+    static constexpr IRHandleType kType = IRHandleType::DENSE;
+
+    std::vector<float> taps;
+    DenseIRHandle      handle;       /**< Points into taps; pass it to Init. */
+    size_t             length;       /**< ir_length(handle), computed once. */
+};
+
+/**
+ * @brief Sparse IR as held by IRCache: taps sorted by position, duplicates summed, so
+ * that adjacent taps form runs and tiles are cache-local. The run table for a channel
+ * count is grouped on the first IRCache::GetRuns for it and kept with the taps.
+ */
+struct PreparedSparseIR
+{
+    explicit PreparedSparseIR(const SparseIRHandle& source)
+    {
+        std::vector<std::pair<size_t, float>> taps(source.num_taps);
+        for (size_t t = 0; t < source.num_taps; t++) taps[t] = { source.positions[t], source.values[t] };
+        std::stable_sort(taps.begin(), taps.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& tap : taps)
+        {
+            if (!positions.empty() && positions.back() == tap.first) values.back() += tap.second;
+            else { positions.push_back(tap.first); values.push_back(tap.second); }
+        }
+        handle = { positions.data(), values.data(), positions.size() };
+        length = ir_length(handle);
+    }
+    PreparedSparseIR(const PreparedSparseIR&) = delete;
+    PreparedSparseIR& operator=(const PreparedSparseIR&) = delete;
+
+    size_t Bytes() const
+    {
+        std::lock_guard<std::mutex> lock(derived_mutex_);
+        size_t bytes = sizeof(*this) + positions.size() * (sizeof(size_t) + sizeof(float));
+        for (const auto& runs : runs_) bytes += runs.second.size() * sizeof(SparseRun);
+        return bytes;
+    }
+
+    // Whether this was prepared from the given contents; sources not already sorted and
+    // free of duplicates are prepared again for the comparison
+    bool Matches(const SparseIRHandle& source) const
+    {
+        bool prepared = true;
+        for (size_t t = 1; t < source.num_taps && prepared; t++) prepared = source.positions[t - 1] < source.positions[t];
+        if (!prepared) return Matches(PreparedSparseIR(source).handle);
+        return source.num_taps == positions.size() && same_bytes(source.positions, positions.data(), positions.size())
+            && same_bytes(source.values, values.data(), values.size());
+    }
+
+    static constexpr IRHandleType kType = IRHandleType::SPARSE;
+
+    std::vector<size_t> positions;
+    std::vector<float>  values;
+    SparseIRHandle      handle;      /**< Points into positions and values; pass it to Init. */
+    size_t              length;      /**< ir_length(handle), computed once. */
+
+private:
+    friend class IRCache;
+
+    // Run table for num_channels, grouped on first use; tables are never changed once built
+    SparseRunTable runs_for(size_t num_channels) const
+    {
+        std::lock_guard<std::mutex> lock(derived_mutex_);
+        auto it = runs_.find(num_channels);
+        if (it == runs_.end())
+        {
+            std::vector<SparseRun> runs(positions.size());
+            runs.resize(SparseConvolutionEngineCore::GroupRuns(handle, num_channels, runs.data()));
+            runs.shrink_to_fit();
+            it = runs_.emplace(num_channels, std::move(runs)).first;
+        }
+        return { it->second.data(), it->second.size(), num_channels };
+    }
+
+    mutable std::mutex                               derived_mutex_;
+    mutable std::map<size_t, std::vector<SparseRun>> runs_;     // By channel count
+};
+
+/**
+ * @brief Velvet IR as held by IRCache: positive and negative taps, each sorted by position.
+ * The prescaled offsets for a channel count are computed on the first IRCache::GetOffsets
+ * for it and kept with the taps.
+ */
+struct PreparedVelvetIR
+{
+    explicit PreparedVelvetIR(const VelvetIRHandle& source)
+        : pos_taps(source.pos_taps, source.pos_taps + source.num_pos_taps),
+          neg_taps(source.neg_taps, source.neg_taps + source.num_neg_taps)
+    {
+        std::sort(pos_taps.begin(), pos_taps.end());
+        std::sort(neg_taps.begin(), neg_taps.end());
+        handle = { pos_taps.data(), pos_taps.size(), neg_taps.data(), neg_taps.size() };
+        length = ir_length(handle);
+    }
+    PreparedVelvetIR(const PreparedVelvetIR&) = delete;
+    PreparedVelvetIR& operator=(const PreparedVelvetIR&) = delete;
+
+    size_t Bytes() const
+    {
+        std::lock_guard<std::mutex> lock(derived_mutex_);
+        return sizeof(*this) + (pos_taps.size() + neg_taps.size()) * sizeof(size_t) * (1 + offsets_.size());
+    }
+
+    // Whether this was prepared from the given contents; unsorted sources are sorted again
+    bool Matches(const VelvetIRHandle& source) const
+    {
+        if (!std::is_sorted(source.pos_taps, source.pos_taps + source.num_pos_taps)
+            || !std::is_sorted(source.neg_taps, source.neg_taps + source.num_neg_taps))
+            return Matches(PreparedVelvetIR(source).handle);
+        return source.num_pos_taps == pos_taps.size() && source.num_neg_taps == neg_taps.size()
+            && same_bytes(source.pos_taps, pos_taps.data(), pos_taps.size())
+            && same_bytes(source.neg_taps, neg_taps.data(), neg_taps.size());
+    }
+
+    static constexpr IRHandleType kType = IRHandleType::VELVET;
+
+    std::vector<size_t> pos_taps;
+    std::vector<size_t> neg_taps;
+    VelvetIRHandle      handle;      /**< Points into pos_taps and neg_taps; pass it to Init. */
+    size_t              length;      /**< ir_length(handle), computed once. */
+
+private:
+    friend class IRCache;
+
+    // Positive then negative offsets for num_channels, prescaled on first use; never changed once built
+    VelvetOffsetTable offsets_for(size_t num_channels) const
+    {
+        std::lock_guard<std::mutex> lock(derived_mutex_);
+        auto it = offsets_.find(num_channels);
+        if (it == offsets_.end())
+        {
+            std::vector<size_t> offsets(pos_taps.size() + neg_taps.size());
+            VelvetConvolutionEngineCore::PrescaleOffsets(pos_taps.data(), pos_taps.size(), num_channels, offsets.data());
+            VelvetConvolutionEngineCore::PrescaleOffsets(neg_taps.data(), neg_taps.size(), num_channels,
+                                                         offsets.data() + pos_taps.size());
+            it = offsets_.emplace(num_channels, std::move(offsets)).first;
+        }
+        return { it->second.data(), it->second.data() + pos_taps.size(), num_channels };
+    }
+
+    mutable std::mutex                            derived_mutex_;
+    mutable std::map<size_t, std::vector<size_t>> offsets_;     // By channel count
+};
+
+/**
+ * @brief Thread-safe cache of prepared IRs, found by a hash of their contents.
+ *
+ * A hit is only returned once the entry's type and contents compare equal to the
+ * caller's, so a hash collision costs an extra entry, never another IR.
+ *
+ * Get returns an immutable, reference-counted view of the prepared IR; every caller
+ * passing the same contents (from any buffer) shares one copy, prepared once. Any
+ * number of engines may read a view concurrently, and it stays valid for as long as
+ * a reference is held, even after eviction. GetRuns and GetOffsets likewise derive the
+ * per-channel-count kernel tables once per IR, so engines sharing an IR skip that work
+ * at Init too.
+ *
+ * Entries no longer referenced outside the cache are evicted, least recently used
+ * first, while the total size exceeds the memory budget. Referenced entries are
+ * never dropped for the budget, since their memory could not be released anyway.
+ * Not real-time safe: Get allocates on a miss and takes a lock, call it from Init.
+ */
+class IRCache
+{
+public:
+    static constexpr size_t kDefaultBudgetBytes = size_t(64) << 20;
+
+    explicit IRCache(size_t budget_bytes = kDefaultBudgetBytes) : budget_(budget_bytes), bytes_(0), hits_(0), misses_(0) {}
+
+    std::shared_ptr<const PreparedDenseIR>  Get(const DenseIRHandle& handle)  { return get<PreparedDenseIR>(handle, Hash(handle)); }
+    std::shared_ptr<const PreparedSparseIR> Get(const SparseIRHandle& handle) { return get<PreparedSparseIR>(handle, Hash(handle)); }
+    std::shared_ptr<const PreparedVelvetIR> Get(const VelvetIRHandle& handle) { return get<PreparedVelvetIR>(handle, Hash(handle)); }
+
+    /**
+     * @brief Run table of ir for num_channels, grouped once per channel count: pass it with
+     * ir->handle to SparseConvolutionEngine::Init. Valid for as long as ir is.
+     */
+    SparseRunTable GetRuns(const std::shared_ptr<const PreparedSparseIR>& ir, size_t num_channels)
+    {
+        const SparseRunTable runs = ir->runs_for(num_channels);
+        recount(ir.get(), ir->Bytes());
+        return runs;
+    }
+
+    /**
+     * @brief Prescaled offsets of ir for num_channels, computed once per channel count: pass them
+     * with ir->handle to VelvetConvolutionEngine::Init (without morphing). Valid for as long as ir is.
+     */
+    VelvetOffsetTable GetOffsets(const std::shared_ptr<const PreparedVelvetIR>& ir, size_t num_channels)
+    {
+        const VelvetOffsetTable offsets = ir->offsets_for(num_channels);
+        recount(ir.get(), ir->Bytes());
+        return offsets;
+    }
+
+    /**
+     * @brief 64-bit FNV-1a hash of an IR's contents (type, sizes and taps).
+     */
+    static uint64_t Hash(const DenseIRHandle& handle)
+    {
+        uint64_t hash = fnv1a(kFnvOffset, IRHandleType::DENSE);
+        hash = fnv1a(hash, handle.num_taps);
+        return fnv1a_bytes(hash, handle.taps, handle.num_taps * sizeof(float));
+    }
+
+    static uint64_t Hash(const SparseIRHandle& handle)
+    {
+        uint64_t hash = fnv1a(kFnvOffset, IRHandleType::SPARSE);
+        hash = fnv1a(hash, handle.num_taps);
+        hash = fnv1a_bytes(hash, handle.positions, handle.num_taps * sizeof(size_t));
+        return fnv1a_bytes(hash, handle.values, handle.num_taps * sizeof(float));
+    }
+
+    static uint64_t Hash(const VelvetIRHandle& handle)
+    {
+        uint64_t hash = fnv1a(kFnvOffset, IRHandleType::VELVET);
+        hash = fnv1a(hash, handle.num_pos_taps);
+        hash = fnv1a(hash, handle.num_neg_taps);
+        hash = fnv1a_bytes(hash, handle.pos_taps, handle.num_pos_taps * sizeof(size_t));
+        return fnv1a_bytes(hash, handle.neg_taps, handle.num_neg_taps * sizeof(size_t));
+    }
+
+    // Evicts right away if the new budget is exceeded
+    void SetBudget(size_t budget_bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = budget_bytes;
+        evict();
+    }
+
+    // Drops every entry no longer referenced outside the cache
+    void Trim()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t budget = budget_;
+        budget_ = 0;
+        evict();
+        budget_ = budget;
+    }
+
+    size_t GetBudget() const    { std::lock_guard<std::mutex> lock(mutex_); return budget_; }
+    size_t GetBytes() const     { std::lock_guard<std::mutex> lock(mutex_); return bytes_; }
+    size_t GetNumEntries() const { std::lock_guard<std::mutex> lock(mutex_); return entries_.size(); }
+    size_t GetHits() const      { std::lock_guard<std::mutex> lock(mutex_); return hits_; }
+    size_t GetMisses() const    { std::lock_guard<std::mutex> lock(mutex_); return misses_; }
+
+protected:
+    static constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+    static constexpr uint64_t kFnvPrime  = 1099511628211ull;
+
+    static uint64_t fnv1a_bytes(uint64_t hash, const void* data, size_t bytes)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) hash = (hash ^ p[i]) * kFnvPrime;
+        return hash;
+    }
+
+    template <typename T>
+    static uint64_t fnv1a(uint64_t hash, const T& value) { return fnv1a_bytes(hash, &value, sizeof(T)); }
+
+    // The type is part of the hash, but entries sharing a key are still told apart by
+    // type and contents
+    using Key = uint64_t;
+
+    struct Entry
+    {
+        Key                         key;
+        IRHandleType                type;
+        std::shared_ptr<const void> ir;
+        size_t                      bytes;
+    };
+
+    template <typename Prepared, typename HandleType>
+    std::shared_ptr<const Prepared> get(const HandleType& handle, Key key)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto ir = find<Prepared>(handle, key)) return ir;
+        }
+
+        // Prepare outside the lock; if another thread got there first, its copy wins
+        auto prepared = std::make_shared<const Prepared>(handle);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto ir = find<Prepared>(handle, key)) return ir;
+        misses_++;
+        lru_.push_front({ key, Prepared::kType, prepared, prepared->Bytes() });
+        entries_.emplace(key, lru_.begin());
+        bytes_ += prepared->Bytes();
+        evict();
+        return prepared;
+    }
+
+    // Lookup with the lock held, marking the entry as most recently used
+    template <typename Prepared, typename HandleType>
+    std::shared_ptr<const Prepared> find(const HandleType& handle, Key key)
+    {
+        const auto range = entries_.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->type != Prepared::kType) continue;
+            auto ir = std::static_pointer_cast<const Prepared>(it->second->ir);
+            if (!ir->Matches(handle)) continue;
+            hits_++;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return ir;
+        }
+        return nullptr;
+    }
+
+    // Updates the size of ir's entry after tables were derived; an evicted ir is no longer counted
+    void recount(const void* ir, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : lru_)
+        {
+            if (entry.ir.get() != ir) continue;
+            bytes_ += bytes - entry.bytes;
+            entry.bytes = bytes;
+            evict();
+            return;
+        }
+    }
+
+    // With the lock held: drops unreferenced entries, oldest first, until within budget
+    void evict()
+    {
+        for (auto it = lru_.end(); bytes_ > budget_ && it != lru_.begin(); )
+        {
+            --it;
+            if (it->ir.use_count() > 1) continue;
+            bytes_ -= it->bytes;
+            const auto range = entries_.equal_range(it->key);
+            for (auto entry = range.first; entry != range.second; ++entry)
+            {
+                if (entry->second != it) continue;
+                entries_.erase(entry);
+                break;
+            }
+            it = lru_.erase(it);
+        }
+    }
+
+    using Lru = std::list<Entry>;
+
+    mutable std::mutex                  mutex_;
+    std::multimap<Key, Lru::iterator>   entries_;   // Several entries may share a key
+    Lru                                 lru_;       // Most recently used first
+    size_t                              budget_;
+    size_t                              bytes_;
+    size_t                              hits_;
+    size_t                              misses_;
+};
+
+#endif // IR_CACHE_H
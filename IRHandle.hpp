@@ -3,6 +3,7 @@
 #define IR_HANDLE_H
 
 #include <cstddef>
+#include <algorithm>
 
 /**
  * @brief A handle for a standard, dense impulse response.
@@ -31,5 +32,114 @@ struct VelvetIRHandle
     size_t        num_neg_taps;  /**< The number of negative taps. */
 };
 
+/**
+ * @brief Kind of impulse response referenced by an IRHandleRef.
+ */
+enum class IRHandleType { DENSE, SPARSE, VELVET };
+
+/**
+ * @brief Non-owning reference to any one of the IR handles, for engines that accept
+ * a mixed list of IRs. The referenced handle must outlive the reference.
+ */
+struct IRHandleRef
+{
+    IRHandleType type;           /**< Which member of the union is valid. */
+    union
+    {
+        const DenseIRHandle*  dense;
+        const SparseIRHandle* sparse;
+        const VelvetIRHandle* velvet;
+    };
+
+    IRHandleRef(const DenseIRHandle& handle)  : type(IRHandleType::DENSE),  dense(&handle) {}
+    IRHandleRef(const SparseIRHandle& handle) : type(IRHandleType::SPARSE), sparse(&handle) {}
+    IRHandleRef(const VelvetIRHandle& handle) : type(IRHandleType::VELVET), velvet(&handle) {}
+};
+
+/**
+ * @brief Number of samples spanned by an impulse response (last tap position + 1).
+ */
+inline size_t ir_length(const DenseIRHandle& handle)
+{
+    return handle.num_taps;
+}
+
+inline size_t ir_length(const SparseIRHandle& handle)
+{
+    size_t length = 0;
+    for (size_t t = 0; t < handle.num_taps; t++)
+        if (handle.positions[t] + 1 > length) length = handle.positions[t] + 1;
+    return length;
+}
+
+inline size_t ir_length(const VelvetIRHandle& handle)
+{
+    size_t length = 0;
+    for (size_t t = 0; t < handle.num_pos_taps; t++)
+        if (handle.pos_taps[t] + 1 > length) length = handle.pos_taps[t] + 1;
+    for (size_t t = 0; t < handle.num_neg_taps; t++)
+        if (handle.neg_taps[t] + 1 > length) length = handle.neg_taps[t] + 1;
+    return length;
+}
+
+inline size_t ir_length(const IRHandleRef& handle)
+{
+    switch (handle.type)
+    {
+        case IRHandleType::DENSE:  return ir_length(*handle.dense);
+        case IRHandleType::SPARSE: return ir_length(*handle.sparse);
+        case IRHandleType::VELVET: return ir_length(*handle.velvet);
+    }
+    return 0;
+}
+
+/**
+ * @brief Splits an impulse response at position split into a head (taps before split,
+ * positions unchanged) and a tail (remaining taps, positions shifted down by split).
+ * Running the tail split samples late and adding the head reproduces the original IR.
+ */
+inline void split_ir(const DenseIRHandle& handle, size_t split, DenseIRHandle& head, DenseIRHandle& tail)
+{
+    const size_t head_taps = std::min(split, handle.num_taps);
+    head = { handle.taps, head_taps };
+    tail = { handle.taps + head_taps, handle.num_taps - head_taps };
+}
+
+/**
+ * @param positions_buffer, values_buffer Storage for num_taps taps, shared by head and tail.
+ * Both keep the handle order of their taps.
+ */
+inline void split_ir(const SparseIRHandle& handle, size_t split, size_t* positions_buffer, float* values_buffer,
+                     SparseIRHandle& head, SparseIRHandle& tail)
+{
+    size_t k = 0;
+    for (size_t t = 0; t < handle.num_taps; t++)
+        if (handle.positions[t] < split) { positions_buffer[k] = handle.positions[t]; values_buffer[k++] = handle.values[t]; }
+    head = { positions_buffer, values_buffer, k };
+    for (size_t t = 0; t < handle.num_taps; t++)
+        if (handle.positions[t] >= split) { positions_buffer[k] = handle.positions[t] - split; values_buffer[k++] = handle.values[t]; }
+    tail = { positions_buffer + head.num_taps, values_buffer + head.num_taps, k - head.num_taps };
+}
+
+/**
+ * @param pos_buffer, neg_buffer Storage for num_pos_taps and num_neg_taps positions, shared by head and tail.
+ */
+inline void split_ir(const VelvetIRHandle& handle, size_t split, size_t* pos_buffer, size_t* neg_buffer,
+                     VelvetIRHandle& head, VelvetIRHandle& tail)
+{
+    auto split_positions = [split](const size_t* taps, size_t num_taps, size_t* buffer, size_t& num_head)
+    {
+        size_t k = 0;
+        for (size_t t = 0; t < num_taps; t++) if (taps[t] < split)  buffer[k++] = taps[t];
+        num_head = k;
+        for (size_t t = 0; t < num_taps; t++) if (taps[t] >= split) buffer[k++] = taps[t] - split;
+    };
+    size_t num_head_pos, num_head_neg;
+    split_positions(handle.pos_taps, handle.num_pos_taps, pos_buffer, num_head_pos);
+    split_positions(handle.neg_taps, handle.num_neg_taps, neg_buffer, num_head_neg);
+    head = { pos_buffer, num_head_pos, neg_buffer, num_head_neg };
+    tail = { pos_buffer + num_head_pos, handle.num_pos_taps - num_head_pos,
+             neg_buffer + num_head_neg, handle.num_neg_taps - num_head_neg };
+}
 
 #endif // IR_HANDLE_H
@@ -0,0 +1,261 @@
+#pragma once
+#ifndef MULTI_RATE_CONVOLUTION_ENGINE_H
+#define MULTI_RATE_CONVOLUTION_ENGINE_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include "DenseConvolutionEngine.hpp"
+#include "SparseConvolutionEngine.hpp"
+#include "PolyphaseConvolutionEngine.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief How MultiRateConvolutionEngine splits an IR.
+ */
+struct MultiRateConfig
+{
+    size_t split_taps;           /**< Taps convolved at full rate, before the crossfade (>= 2 * filter_taps). */
+    size_t rate_factor;          /**< Decimation of the late part: 2 or 4. */
+    size_t filter_taps;          /**< Odd length of the anti-alias filter. Longer filters keep more of the
+                                      late part's band (up to 0.5 / rate_factor of the sample rate). */
+};
+
+/**
+ * @brief Dense convolution with the late part of the IR run at a reduced rate.
+ *
+ * Late reverb carries little high-frequency energy, so past split_taps the IR is
+ * low-passed and convolved at 1 / R of the sample rate, at R^2 times fewer multiplies
+ * per frame. The early part [0, split_taps) stays exact, on a DenseConvolutionEngine;
+ * the two parts overlap over filter_taps frames with a raised-cosine crossfade.
+ *
+ * The late path is PolyphaseConvolutionEngine decimating by R through a windowed-sinc
+ * low-pass g, a DenseConvolutionEngine at the low rate, and a PolyphaseConvolutionEngine
+ * interpolating by R through R * g. Its latency (the two filter delays) is compensated
+ * by advancing the low-rate IR, whose leading zeros are replaced by a delay. The
+ * interpolator emits R frames at a time, so up to R - 1 frames carry over to the next
+ * call. Inputs are accurate up to the filter passband; above it only the early part is.
+ */
+class MultiRateConvolutionEngine
+{
+public:
+    // Input frames per pass through the late path; sizes the scratch
+    static constexpr size_t kChunkFrames = 256;
+
+    MultiRateConvolutionEngine() : num_channels_(0), rate_(1), has_late_(false), has_delay_(false), carry_frames_(0) {}
+    ~MultiRateConvolutionEngine() {}
+
+    /**
+     * @brief Floats of work storage Init needs, for the IR copies, the engines' buffers and the scratch.
+     */
+    static size_t GetWorkBufferSize(size_t num_taps, const MultiRateConfig& config, size_t num_channels)
+    {
+        return Layout(num_taps, config, num_channels).total;
+    }
+
+    /**
+     * @param handle IR to split; read during Init only.
+     * @param work_buffer Storage of GetWorkBufferSize(handle.num_taps, config, num_channels) floats.
+     * Init is not real-time safe: it filters the late part of the IR.
+     */
+    void Init(const DenseIRHandle& handle, const MultiRateConfig& config, float* work_buffer, size_t num_channels)
+    {
+        assert(config.rate_factor == 2 || config.rate_factor == 4);
+        assert(config.filter_taps >= 3 && config.filter_taps % 2 == 1);
+        assert(config.split_taps >= 2 * config.filter_taps);
+        assert(work_buffer);                       // != NULL
+        assert(num_channels);                      // > 0
+
+        const Layout layout(handle.num_taps, config, num_channels);
+        num_channels_ = num_channels;
+        rate_         = config.rate_factor;
+        has_late_     = layout.late_taps > 0;
+        carry_frames_ = 0;
+        scratch_      = work_buffer + layout.scratch;
+
+        // Early part, faded out over the crossfade when there is a late part
+        float* early = work_buffer + layout.early;
+        for (size_t n = 0; n < layout.early_taps; n++)
+            early[n] = has_late_ ? handle.taps[n] * (1.0f - late_weight(n, config)) : handle.taps[n];
+        early_.Init({early, layout.early_taps}, work_buffer + layout.early_buffer, layout.early_buffer_size, num_channels_);
+        if (!has_late_) return;
+
+        // Anti-alias low-pass: windowed sinc with its stopband from 0.5 / R, unity gain at DC
+        const size_t num_filter = config.filter_taps;
+        const size_t delay = (num_filter - 1) / 2;
+        float* filter = work_buffer + layout.filter;
+        const double cutoff = std::max(0.25, 0.5 - 2.75 * rate_ / num_filter) / rate_;
+        double sum = 0.0;
+        for (size_t k = 0; k < num_filter; k++)
+        {
+            const double t = static_cast<double>(k) - delay;
+            const double sinc = (t == 0.0) ? 2.0 * cutoff : std::sin(2.0 * kPi * cutoff * t) / (kPi * t);
+            const double window = 0.42 - 0.5 * std::cos(2.0 * kPi * k / (num_filter - 1)) + 0.08 * std::cos(4.0 * kPi * k / (num_filter - 1));
+            filter[k] = static_cast<float>(sinc * window);
+            sum += filter[k];
+        }
+        for (size_t k = 0; k < num_filter; k++) filter[k] = static_cast<float>(filter[k] / sum);
+
+        // Low-rate IR: the late part low-passed (zero phase) and sampled every R taps, scaled
+        // by R, advanced by the 2 * delay frames of latency of the decimator and interpolator
+        float* late = work_buffer + layout.late;
+        for (size_t j = 0; j < layout.late_taps; j++)
+        {
+            const size_t center = (layout.first_late + j) * rate_ + 2 * delay;
+            double acc = 0.0;
+            for (size_t k = 0; k < num_filter; k++)
+            {
+                const size_t n = center + delay - k;
+                if (n < handle.num_taps) acc += filter[k] * handle.taps[n] * late_weight(n, config);
+            }
+            late[j] = static_cast<float>(acc * rate_);
+        }
+        late_.Init({late, layout.late_taps}, work_buffer + layout.late_buffer, layout.late_buffer_size, num_channels_);
+
+        // The skipped leading zeros of the low-rate IR, as a delay
+        has_delay_ = layout.first_late > 0;
+        delay_position_ = layout.first_late;
+        if (has_delay_)
+            delay_.Init({&delay_position_, &kUnity, 1}, work_buffer + layout.delay_buffer, layout.delay_buffer_size, num_channels_);
+
+        // Decimator through g, interpolator through R * g
+        const DenseIRHandle filter_handle = {filter, num_filter};
+        decimator_.Init(filter_handle, 1, rate_, work_buffer + layout.decimator_buffer, layout.decimator_buffer_size,
+                        num_channels_, work_buffer + layout.decimator_phases);
+        float* interpolation = work_buffer + layout.interpolation;
+        for (size_t k = 0; k < num_filter; k++) interpolation[k] = filter[k] * rate_;
+        interpolator_.Init({interpolation, num_filter}, rate_, 1, work_buffer + layout.interpolator_buffer,
+                           layout.interpolator_buffer_size, num_channels_, work_buffer + layout.interpolator_phases);
+    }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        const size_t num_ch = num_channels_;
+        early_.Process(in, out, size);
+        if (!has_late_) return;
+
+        // Scratch: two low-rate blocks, then the full-rate output of the late path
+        float* low_a = scratch_;
+        float* low_b = low_a + low_block_frames() * num_ch;
+        float* high  = low_b + low_block_frames() * num_ch;
+
+        while (size > 0)
+        {
+            const size_t chunk = std::min(size, kChunkFrames);
+
+            const size_t low_frames = decimator_.Process(in, low_a, chunk);
+            late_.Process(low_a, low_b, low_frames);
+            const float* late_out = low_b;
+            if (has_delay_)
+            {
+                delay_.Process(low_b, low_a, low_frames);
+                late_out = low_a;
+            }
+            const size_t high_frames = carry_frames_ + interpolator_.Process(late_out, high + carry_frames_ * num_ch, low_frames);
+
+            // R frames come out per low-rate frame, so up to R - 1 are ahead of the input
+            assert(high_frames >= chunk);
+            for (size_t i = 0; i < chunk * num_ch; i++) out[i] += high[i];
+            carry_frames_ = high_frames - chunk;
+            std::copy(high + chunk * num_ch, high + high_frames * num_ch, high);
+
+            in   += chunk * num_ch;
+            out  += chunk * num_ch;
+            size -= chunk;
+        }
+    }
+
+    // False when the whole IR fits in the early part
+    bool HasLatePart() const { return has_late_; }
+
+protected:
+    static constexpr double kPi = 3.14159265358979323846;
+    static constexpr float kUnity = 1.0f;
+
+    // Weight of tap n in the late part: 0 before the split, a raised-cosine ramp over
+    // filter_taps, then 1; the early part gets the complement
+    static float late_weight(size_t n, const MultiRateConfig& config)
+    {
+        if (n < config.split_taps) return 0.0f;
+        if (n >= config.split_taps + config.filter_taps) return 1.0f;
+        const double x = (n - config.split_taps + 0.5) / config.filter_taps;
+        return static_cast<float>(0.5 - 0.5 * std::cos(kPi * x));
+    }
+
+    size_t low_block_frames() const { return kChunkFrames / rate_ + 1; }
+
+    // Offsets (in floats) of everything carved out of the work buffer
+    struct Layout
+    {
+        size_t early_taps = 0, late_taps = 0, first_late = 0;
+        size_t early = 0, filter = 0, late = 0, interpolation = 0, decimator_phases = 0, interpolator_phases = 0;
+        size_t early_buffer = 0, late_buffer = 0, delay_buffer = 0, decimator_buffer = 0, interpolator_buffer = 0;
+        size_t early_buffer_size = 0, late_buffer_size = 0, delay_buffer_size = 0;
+        size_t decimator_buffer_size = 0, interpolator_buffer_size = 0;
+        size_t scratch = 0, total = 0;
+
+        Layout(size_t num_taps, const MultiRateConfig& config, size_t num_ch)
+        {
+            const size_t rate = config.rate_factor, num_filter = config.filter_taps;
+            const size_t delay = (num_filter - 1) / 2;
+            early_taps = std::min(num_taps, config.split_taps + num_filter);
+
+            // Low-rate taps j cover IR taps (j * R + 2 * delay) +- delay; the late part, with the
+            // spread of the filter, starts at split_taps - delay
+            if (num_taps > early_taps)
+            {
+                const size_t late_start = config.split_taps - delay;
+                first_late = (late_start - 2 * delay) / rate;
+                const size_t end = (num_taps + delay - 2 * delay + rate - 1) / rate;
+                late_taps = end - first_late;
+            }
+
+            auto carve = [&](size_t& offset, size_t count) { offset = total; total += count; };
+            auto ring = [&](size_t frames) { return ConvolutionUtils::next_power_of_two((frames + kChunkFrames) * num_ch); };
+            early_buffer_size = ring(early_taps);
+            carve(early, early_taps);
+            carve(early_buffer, early_buffer_size);
+            if (late_taps == 0)
+            {
+                carve(scratch, 0);
+                return;
+            }
+            late_buffer_size = ring(late_taps);
+            delay_buffer_size = first_late ? ring(first_late + 1) : 0;
+            decimator_buffer_size = PolyphaseConvolutionEngine::GetMinBufferSize({nullptr, num_filter}, rate, num_ch);
+            interpolator_buffer_size = PolyphaseConvolutionEngine::GetMinBufferSize({nullptr, num_filter}, 1, num_ch);
+            carve(filter, num_filter);
+            carve(late, late_taps);
+            carve(interpolation, num_filter);
+            carve(decimator_phases, num_filter);
+            carve(interpolator_phases, num_filter);
+            carve(late_buffer, late_buffer_size);
+            carve(delay_buffer, delay_buffer_size);
+            carve(decimator_buffer, decimator_buffer_size);
+            carve(interpolator_buffer, interpolator_buffer_size);
+            // Two low-rate blocks and the late path's output, with room for the carried frames
+            const size_t low_frames = kChunkFrames / rate + 1;
+            carve(scratch, (2 * low_frames + low_frames * rate + rate) * num_ch);
+        }
+    };
+
+    size_t num_channels_;
+    size_t rate_;
+    bool   has_late_;
+    bool   has_delay_;
+
+    DenseConvolutionEngine     early_;
+    DenseConvolutionEngine     late_;
+    SparseConvolutionEngine    delay_;
+    PolyphaseConvolutionEngine decimator_;
+    PolyphaseConvolutionEngine interpolator_;
+    size_t                     delay_position_;
+
+    // Full-rate frames of the late path produced ahead of the input, at the start of the scratch's high block
+    float* scratch_;
+    size_t carry_frames_;
+};
+
+#endif // MULTI_RATE_CONVOLUTION_ENGINE_H
@@ -0,0 +1,194 @@
+#pragma once
+#ifndef OFFLINE_RENDERER_H
+#define OFFLINE_RENDERER_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Multi-threaded offline convolution of long signals.
+ *
+ * The input is split into chunks that are convolved independently on all cores,
+ * each by its own instance of EngineType, and stitched back together with
+ * overlap-add. Render() can be called repeatedly on consecutive pieces of a
+ * stream; the tail overlapping the next piece is carried over internally and
+ * Flush() returns whatever is left after the last piece.
+ *
+ * Every chunk drains its IR tail through the engine, so by default chunks are sized
+ * to kChunkTailRatio tails (at least kMinChunkFrames) to keep that drain a small
+ * fraction of the work. Chunk tails are held until the overlap-add; a piece is
+ * rendered in waves of as many chunks as fit the tail budget (at least one per
+ * thread), so their memory does not grow with the length of the piece.
+ *
+ * Not real-time safe: Init allocates and Render spawns worker threads.
+ */
+template <typename EngineType, typename HandleType>
+class OfflineRenderer
+{
+public:
+    static constexpr size_t kAutoChunkFrames        = 0;          // Sized from the IR length
+    static constexpr size_t kMinChunkFrames         = 1 << 16;
+    static constexpr size_t kChunkTailRatio         = 8;          // Auto chunks span this many IR tails
+    static constexpr size_t kDefaultTailBudgetBytes = 64 << 20;
+
+    OfflineRenderer() : num_channels_(0), chunk_frames_(0), tail_frames_(0), buffer_size_(0), wave_chunks_(0) {}
+
+    void Init(const HandleType& handle, size_t num_channels,
+              size_t chunk_frames = kAutoChunkFrames, size_t num_threads = 0,
+              size_t tail_budget_bytes = kDefaultTailBudgetBytes)
+    {
+        assert(num_channels);   // > 0
+
+        handle_       = handle;
+        num_channels_ = num_channels;
+
+        const size_t length = ir_length(handle);
+        tail_frames_ = (length > 0) ? length - 1 : 0;
+        buffer_size_ = ConvolutionUtils::buffer_size_for(length, num_channels_, kZeroBlockFrames);
+        chunk_frames_ = (chunk_frames != kAutoChunkFrames) ? chunk_frames
+                                                           : std::max(kMinChunkFrames, kChunkTailRatio * tail_frames_);
+
+        if (num_threads == 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        workers_.assign(num_threads, Worker());
+        for (auto& worker : workers_)
+        {
+            worker.circ_buffer.resize(buffer_size_);
+            worker.zeros.assign(kZeroBlockFrames * num_channels_, 0.0f);
+        }
+
+        const size_t tail_bytes = std::max<size_t>(tail_frames_ * num_channels_ * sizeof(float), 1);
+        wave_chunks_ = std::max(num_threads, tail_budget_bytes / tail_bytes);
+
+        carry_.assign(tail_frames_ * num_channels_, 0.0f);
+    }
+
+    /**
+     * @brief Convolves num_frames interleaved frames, writing exactly num_frames frames to out.
+     */
+    void Render(const float* in, float* out, size_t num_frames)
+    {
+        const size_t wave_frames = wave_chunks_ * chunk_frames_;
+        for (size_t start = 0; start < num_frames; start += wave_frames)
+        {
+            const size_t frames = std::min(wave_frames, num_frames - start);
+            RenderWave(in + start * num_channels_, out + start * num_channels_, frames);
+        }
+    }
+
+    /**
+     * @brief Writes the remaining GetTailFrames() frames after the last Render() call.
+     */
+    void Flush(float* out)
+    {
+        std::copy(carry_.begin(), carry_.end(), out);
+        std::fill(carry_.begin(), carry_.end(), 0.0f);
+    }
+
+    size_t GetTailFrames() const { return tail_frames_; }
+    size_t GetChunkFrames() const { return chunk_frames_; }
+    size_t GetNumThreads() const { return workers_.size(); }
+
+private:
+    static constexpr size_t kZeroBlockFrames = 1024;
+
+    struct Worker
+    {
+        EngineType         engine;
+        std::vector<float> circ_buffer;
+        std::vector<float> zeros;
+    };
+
+    // Renders at most wave_chunks_ chunks in parallel and overlap-adds their tails
+    void RenderWave(const float* in, float* out, size_t num_frames)
+    {
+        const size_t num_ch     = num_channels_;
+        const size_t num_chunks = (num_frames + chunk_frames_ - 1) / chunk_frames_;
+        const size_t tail_len   = tail_frames_ * num_ch;
+
+        // Every chunk writes its body straight into out and its tail into a private slot
+        tails_.resize(num_chunks * tail_len);
+
+        std::atomic<size_t> next_chunk(0);
+        auto run_worker = [&](Worker& worker)
+        {
+            for (size_t c = next_chunk.fetch_add(1); c < num_chunks; c = next_chunk.fetch_add(1))
+            {
+                const size_t start  = c * chunk_frames_;
+                const size_t frames = std::min(chunk_frames_, num_frames - start);
+                RenderChunk(worker, in + start * num_ch, out + start * num_ch, frames,
+                            tails_.data() + c * tail_len);
+            }
+        };
+
+        const size_t num_threads = std::min(workers_.size(), std::max<size_t>(num_chunks, 1));
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < num_threads; i++)
+            threads.emplace_back(run_worker, std::ref(workers_[i]));
+        run_worker(workers_[0]);
+        for (auto& thread : threads)
+            thread.join();
+
+        // Overlap-add: the tail carried from the previous call, then every chunk tail
+        // in order. Samples past the end of this piece go to the new carry.
+        std::vector<float>& next_carry = scratch_carry_;
+        next_carry.assign(tail_len, 0.0f);
+        const size_t total = num_frames * num_ch;
+
+        auto add_at = [&](const float* src, size_t dst_offset)
+        {
+            for (size_t i = 0; i < tail_len; i++)
+            {
+                const size_t dst = dst_offset + i;
+                if (dst < total) out[dst] += src[i];
+                else             next_carry[dst - total] += src[i];
+            }
+        };
+
+        add_at(carry_.data(), 0);
+        for (size_t c = 0; c < num_chunks; c++)
+        {
+            const size_t frames = std::min(chunk_frames_, num_frames - c * chunk_frames_);
+            add_at(tails_.data() + c * tail_len, (c * chunk_frames_ + frames) * num_ch);
+        }
+        carry_.swap(next_carry);
+    }
+
+    void RenderChunk(Worker& worker, const float* in, float* out, size_t frames, float* tail)
+    {
+        const size_t num_ch = num_channels_;
+
+        worker.engine.Init(handle_, worker.circ_buffer.data(), buffer_size_, num_ch);
+        worker.engine.Process(in, out, frames);
+
+        // Drain the ringing of this chunk by feeding silence
+        for (size_t done = 0; done < tail_frames_; )
+        {
+            const size_t block = std::min(kZeroBlockFrames, tail_frames_ - done);
+            worker.engine.Process(worker.zeros.data(), tail + done * num_ch, block);
+            done += block;
+        }
+    }
+
+    HandleType         handle_;
+    size_t             num_channels_;
+    size_t             chunk_frames_;
+    size_t             tail_frames_;
+    size_t             buffer_size_;
+    size_t             wave_chunks_;    // Chunks rendered (and tails held) at once
+
+    std::vector<Worker> workers_;
+    std::vector<float>  tails_;
+    std::vector<float>  carry_;
+    std::vector<float>  scratch_carry_;
+};
+
+#endif // OFFLINE_RENDERER_H
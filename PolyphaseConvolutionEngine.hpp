@@ -0,0 +1,199 @@
+#pragma once
+#ifndef POLYPHASE_CONVOLUTION_ENGINE_H
+#define POLYPHASE_CONVOLUTION_ENGINE_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+
+/**
+ * @brief Rational-rate dense convolution: upsample by U, filter, downsample by D,
+ * without ever touching the zeros of the upsampled signal or the discarded outputs.
+ *
+ * With x_up the input zero-stuffed by U, the output is y[m] = sum_k h[k] x_up[m*D - k].
+ * Input frame n only reaches the outputs m for which k = m*D - n*U is a tap index,
+ * i.e. one polyphase component h[r], h[r + D], h[r + 2D], ... of the IR, landing on
+ * consecutive output frames. The IR is split into its D phases at Init, and each
+ * input frame scatters a single phase into the output accumulator with the dense
+ * inner loop. Per input frame that is num_taps / D multiplies instead of U * num_taps
+ * for the zero-stuffed filter at the high rate.
+ */
+class PolyphaseConvolutionEngine
+{
+public:
+    using WrappingMode = ConvolutionUtils::WrappingMode;
+    using ChannelLayout = ConvolutionUtils::ChannelLayout;
+    using ProcessFunctionPtr = size_t (PolyphaseConvolutionEngine::*)(const float*, float*, size_t);
+
+    static constexpr size_t kMaxFactor = 16;
+
+    PolyphaseConvolutionEngine() : active_process_function_(nullptr) {}
+    ~PolyphaseConvolutionEngine() {}
+
+    /**
+     * @param upsample_factor, downsample_factor Rate change U / D, each in [1, kMaxFactor].
+     * @param circ_buffer Output accumulator of buffer_size samples, at least
+     * GetMinBufferSize(handle, downsample_factor, num_channels).
+     * @param phase_buffer Storage for num_taps floats, holding the IR reordered phase by phase.
+     */
+    void Init(const DenseIRHandle& handle, size_t upsample_factor, size_t downsample_factor,
+              float* circ_buffer, size_t buffer_size, size_t num_channels, float* phase_buffer)
+    {
+        circ_buffer_  = circ_buffer;
+        buffer_size_  = buffer_size;
+        num_channels_ = num_channels;
+        write_head_   = 0;
+        up_           = upsample_factor;
+        down_         = downsample_factor;
+        phase_        = 0;
+
+        assert(circ_buffer_);   // != NULL
+        assert(num_channels_);  // > 0
+        assert(up_ >= 1 && up_ <= kMaxFactor);
+        assert(down_ >= 1 && down_ <= kMaxFactor);
+        assert(phase_buffer || (handle.num_taps == 0));
+        assert(buffer_size_ >= GetMinBufferSize(handle, down_, num_channels_));
+
+		// Init empty buffer
+        std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
+
+        // Split the IR into its D polyphase components, stored one after the other
+        phase_taps_ = phase_buffer;
+        size_t offset = 0;
+        for (size_t r = 0; r < down_; r++)
+        {
+            phase_offset_[r] = offset;
+            for (size_t k = r; k < handle.num_taps; k += down_)
+                phase_taps_[offset++] = handle.taps[k];
+            phase_length_[r] = offset - phase_offset_[r];
+        }
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+
+        // Dispatch to the correct template specialization based on runtime channel count
+        // and WrappingMode
+        if (num_channels_ == 1)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MONO);
+		}
+        else if (num_channels_ == 2)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::STEREO);
+		}
+        else if (num_channels_ == 4)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::QUAD);
+		}
+        else
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MULTICHANNEL);
+		}
+    }
+
+    /**
+     * @brief Smallest accumulator (in samples) for an IR: the longest phase, in frames.
+     */
+    static size_t GetMinBufferSize(const DenseIRHandle& handle, size_t downsample_factor, size_t num_channels)
+    {
+        const size_t longest_phase = (handle.num_taps + downsample_factor - 1) / downsample_factor;
+        return std::max<size_t>(longest_phase, 1) * num_channels;
+    }
+
+    /**
+     * @brief Exact number of frames the next Process call will write for in_frames input frames.
+     */
+    size_t GetOutputFrames(size_t in_frames) const
+    {
+        // Outputs m are emitted once m * D < n * U, counted from the current phase
+        return (in_frames * up_ + down_ - 1 - phase_) / down_;
+    }
+
+    /**
+     * @brief Upper bound of GetOutputFrames over all phases, for sizing output buffers.
+     */
+    size_t GetMaxOutputFrames(size_t in_frames) const
+    {
+        return (in_frames * up_ + down_ - 1) / down_;
+    }
+
+    /**
+     * @brief Consumes in_frames input frames and writes GetOutputFrames(in_frames) output frames.
+     * @return The number of output frames written.
+     */
+    size_t Process(const float* in, float* out, size_t in_frames)
+    {
+        return (this->*active_process_function_)(in, out, in_frames);
+    }
+
+protected:
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    size_t ProcessImpl(const float* in, float* out, size_t in_frames)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+        size_t written = 0;
+
+        for (size_t smp = 0; smp < in_frames; smp++)
+        {
+            // POLYPHASE KERNEL: phase_ = m * D - n * U for the next output m, which picks
+            // the taps h[phase_ + j * D] hitting outputs m + j
+            ConvolutionUtils::scatter_run<WMode, CLayout>(circ_buffer_, buffer_size_, write_head_, in + smp * num_ch,
+                                                          phase_taps_ + phase_offset_[phase_], phase_length_[phase_], num_ch);
+
+            // Outputs that no later input frame can reach: m * D < (n + 1) * U
+            const size_t emit = (phase_ < up_) ? (up_ - 1 - phase_) / down_ + 1 : 0;
+            for (size_t e = 0; e < emit; e++, written++)
+            {
+                ConvolutionUtils::extract_frame<WMode, CLayout>(circ_buffer_, buffer_size_, write_head_,
+                                                                out + written * num_ch, num_ch, nullptr);
+                write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + num_ch, buffer_size_);
+            }
+            phase_ = phase_ + emit * down_ - up_;
+        }
+        return written;
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void set_process_function(WrappingMode)
+    {
+        active_process_function_ = &PolyphaseConvolutionEngine::ProcessImpl<WMode, CLayout>;
+    }
+
+    void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
+    {
+		// POWER OF TWO
+        if (wrapping_mode == WrappingMode::POWER_OF_TWO) {
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        } else { // ARBITRARY
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        }
+    }
+
+    size_t write_head_;
+    size_t buffer_size_;
+    size_t num_channels_;
+    float* circ_buffer_;
+
+    // Rate change and current phase (m * D - n * U, in [0, D))
+    size_t up_;
+    size_t down_;
+    size_t phase_;
+
+    // Polyphase components of the IR
+    float* phase_taps_;
+    size_t phase_offset_[kMaxFactor];
+    size_t phase_length_[kMaxFactor];
+
+    ProcessFunctionPtr active_process_function_;
+};
+
+#endif // POLYPHASE_CONVOLUTION_ENGINE_H
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef REBLOCKING_ENGINE_H
+#define REBLOCKING_ENGINE_H
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+
+/**
+ * @brief Adapter that feeds an engine fixed-size blocks whatever the callback size.
+ *
+ * Input frames are queued until a full block of block_frames is available, which is
+ * then processed in one call; the result is queued and played out as the callbacks
+ * ask for it. This adds block_frames - 1 frames of latency (see GetLatency).
+ *
+ * In zero-latency mode the IR is split at that latency (see split_ir): a second,
+ * head engine runs the first taps direct-form on every callback, while the block
+ * engine runs the remaining taps, shifted down by the latency, through the queues.
+ * The sum is the full convolution with no added delay.
+ *
+ * Works with any engine providing Process(const float*, float*, size_t). Both
+ * engines are owned and initialized by the caller; the adapter never allocates.
+ */
+template <typename EngineType>
+class ReblockingEngine
+{
+public:
+    /**
+     * @brief Samples of FIFO storage needed for a block size and channel count:
+     * one input block and an output ring of two blocks.
+     */
+    static constexpr size_t GetFifoSize(size_t block_frames, size_t num_channels)
+    {
+        return 3 * block_frames * num_channels;
+    }
+
+    ReblockingEngine() : block_engine_(nullptr), head_engine_(nullptr), num_channels_(0), block_frames_(0),
+                         in_fifo_(nullptr), out_fifo_(nullptr), in_fill_(0), out_read_(0), out_write_(0) {}
+
+    /**
+     * @param block_engine Initialized engine that receives every block of block_frames.
+     * @param fifo_buffer Storage of GetFifoSize(block_frames, num_channels) samples.
+     * @param head_engine Optional initialized engine for zero-latency mode. It must hold the
+     * taps before GetLatency() and block_engine the rest, shifted down by GetLatency().
+     */
+    void Init(EngineType* block_engine, size_t num_channels, size_t block_frames, float* fifo_buffer,
+              EngineType* head_engine = nullptr)
+    {
+        block_engine_ = block_engine;
+        head_engine_  = head_engine;
+        num_channels_ = num_channels;
+        block_frames_ = block_frames;
+
+        assert(block_engine_);  // != NULL
+        assert(fifo_buffer);    // != NULL
+        assert(num_channels_);  // > 0
+        assert(block_frames_);  // > 0
+
+        in_fifo_  = fifo_buffer;
+        out_fifo_ = fifo_buffer + block_frames_ * num_channels_;
+        std::fill(fifo_buffer, fifo_buffer + GetFifoSize(block_frames_, num_channels_), 0.0f);
+
+        // The output ring starts with block_frames - 1 frames of silence in front of the
+        // first block, just enough for a full block to be ready when its last frame arrives.
+        // Blocks are then always written at frame 0 or block_frames of the ring, unwrapped.
+        in_fill_   = 0;
+        out_write_ = 0;
+        out_read_  = (block_frames_ + 1) % (2 * block_frames_);
+    }
+
+    /**
+     * @brief Added latency in frames: block_frames - 1, or 0 in zero-latency mode.
+     */
+    size_t GetLatency() const { return head_engine_ ? 0 : block_frames_ - 1; }
+
+    size_t GetBlockFrames() const { return block_frames_; }
+
+    /**
+     * @brief in and out may be the same buffer (in-place), but must not otherwise overlap.
+     */
+    void Process(const float* in, float* out, size_t size)
+    {
+        const size_t num_ch = num_channels_;
+        const size_t ring_frames = 2 * block_frames_;
+
+        for (size_t done = 0; done < size; )
+        {
+            const size_t frames = std::min(size - done, block_frames_ - in_fill_);
+            float* queued = in_fifo_ + in_fill_ * num_ch;
+            std::copy(in + done * num_ch, in + (done + frames) * num_ch, queued);
+            in_fill_ += frames;
+
+            // Zero-latency head, written straight to the output; the queued tail is added on top.
+            // It reads the queued copy, so in may be the same buffer as out.
+            if (head_engine_) head_engine_->Process(queued, out + done * num_ch, frames);
+
+            if (in_fill_ == block_frames_)
+            {
+                block_engine_->Process(in_fifo_, out_fifo_ + out_write_ * num_ch, block_frames_);
+                out_write_ = (out_write_ + block_frames_) % ring_frames;
+                in_fill_ = 0;
+            }
+
+            // Play out as many frames as were queued, in at most two contiguous pieces
+            for (size_t played = 0; played < frames; )
+            {
+                const size_t n = std::min(frames - played, ring_frames - out_read_);
+                const float* src = out_fifo_ + out_read_ * num_ch;
+                float* dst = out + (done + played) * num_ch;
+                if (head_engine_)
+                    for (size_t i = 0; i < n * num_ch; i++) dst[i] += src[i];
+                else
+                    std::copy(src, src + n * num_ch, dst);
+                played += n;
+                out_read_ = (out_read_ + n) % ring_frames;
+            }
+            done += frames;
+        }
+    }
+
+protected:
+    EngineType* block_engine_;
+    EngineType* head_engine_;
+    size_t      num_channels_;
+    size_t      block_frames_;
+
+    float*      in_fifo_;       // One block, filled from the callbacks
+    float*      out_fifo_;      // Ring of two blocks, played out to the callbacks
+    size_t      in_fill_;       // Frames queued in in_fifo_
+    size_t      out_read_;      // Frame positions in out_fifo_
+    size_t      out_write_;
+};
+
+#endif // REBLOCKING_ENGINE_H
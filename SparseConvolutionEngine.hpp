@@ -5,28 +5,185 @@
 #include "IRHandle.hpp"
 #include "ConvolutionUtils.hpp"
 #include <cstddef>   
+#include <cassert>
 #include <algorithm> 
 #include <cmath>     
 #include <type_traits> 
 
 /**
- * @brief A generic, real-time safe convolution engine supporting sparse
- * impulse responses with compile-time optimization for channel layout.
+ * @brief A run of taps at adjacent positions, stored in the handle at consecutive indices.
  */
-class SparseConvolutionEngine
+struct SparseRun
+{
+    size_t offset;               /**< Position of the first tap, prescaled by the channel count. */
+    size_t first_tap;            /**< Index of the first tap in the handle's arrays. */
+    size_t length;               /**< Number of taps in the run. */
+};
+
+/**
+ * @brief Read-only run table built once for an IR and a channel count, which any number of
+ * engines can share (see IRCache::GetRuns).
+ */
+struct SparseRunTable
+{
+    const SparseRun* runs;
+    size_t           num_runs;
+    size_t           num_channels;   /**< Channel count the run offsets are prescaled by. */
+};
+
+/**
+ * @brief State and kernels shared by the runtime-dispatch SparseConvolutionEngine
+ * and the statically dispatched SparseConvolutionEngineT.
+ */
+class SparseConvolutionEngineCore
 {
-    friend class ConvolutionEngineTest;
-    template<typename EngineType> friend class EngineWrapperImpl;
 public:
     using WrappingMode = ConvolutionUtils::WrappingMode;
     using ChannelLayout = ConvolutionUtils::ChannelLayout;
 
-    using ProcessFunctionPtr = void (SparseConvolutionEngine::*)(const float*, float*, size_t);
+    /**
+     * @brief Circular buffer size (in samples) to allocate for Init with handle: the span of the IR
+     * in frames plus max_block_frames - 1, rounded up to a power of two so that the masked wrapping
+     * kernels are used. Process calls of up to max_block_frames frames then run as one block.
+     */
+    static size_t GetBufferSize(const SparseIRHandle& handle, size_t num_channels,
+                                size_t max_block_frames = ConvolutionUtils::kDefaultMaxBlockFrames)
+    {
+        return ConvolutionUtils::buffer_size_for(ir_length(handle), num_channels, max_block_frames);
+    }
 
-    SparseConvolutionEngine() : active_process_function_(nullptr) {}
-    ~SparseConvolutionEngine() {}
+    // Runs shorter than this stay on the per-tap path
+    static constexpr size_t kMinRunLength = 4;
+    // Blocks of fewer samples are scattered without the split at the wrap point
+    static constexpr size_t kMinBlockScatterSamples = 8;
+
+    SparseConvolutionEngineCore() : sparse_runs_(nullptr), num_sparse_runs_(0), channel_gains_(nullptr) {}
+
+    /**
+     * @brief Groups taps at adjacent positions (in handle order) into runs, with offsets prescaled
+     * by num_channels. runs needs room for handle.num_taps entries.
+     * @return The number of runs written.
+     */
+    static size_t GroupRuns(const SparseIRHandle& handle, size_t num_channels, SparseRun* runs)
+    {
+        size_t num_runs = 0;
+        for (size_t t = 0; t < handle.num_taps; t++)
+        {
+            if (num_runs > 0)
+            {
+                SparseRun& last = runs[num_runs - 1];
+                if (handle.positions[t] * num_channels == last.offset + last.length * num_channels)
+                {
+                    last.length++;
+                    continue;
+                }
+            }
+            runs[num_runs++] = { handle.positions[t] * num_channels, t, 1 };
+        }
+        return num_runs;
+    }
+
+    /**
+     * @brief True while the input has been silent for at least the IR length, i.e. the
+     * output buffer is drained and Process only writes zeros.
+     */
+    bool IsIdle() const { return tail_.IsIdle(); }
+
+    /**
+     * @brief Attaches a counter, typically shared by all voices, of how many engines are idle.
+     */
+    void SetIdleCounter(std::atomic<size_t>* counter) { tail_.SetIdleCounter(counter); }
+
+    /**
+     * @brief Attaches storage for num_channels per-channel output gains, all starting at unity.
+     * Call after Init; pass nullptr to detach.
+     */
+    void SetChannelGainBuffer(ConvolutionUtils::ChannelGain* gains)
+    {
+        channel_gains_ = gains;
+        if (channel_gains_)
+            for (size_t ch = 0; ch < num_channels_; ch++) channel_gains_[ch] = { 1.0f, 1.0f, 0.0f, 0 };
+    }
+
+    /**
+     * @brief Ramps the output gain of one channel to target over ramp_frames output frames,
+     * sample-accurately from the next processed frame. Requires a gain buffer.
+     */
+    void SetChannelGain(size_t channel, float target, size_t ramp_frames)
+    {
+        assert(channel_gains_);
+        assert(channel < num_channels_);
+        channel_gains_[channel].Set(target, ramp_frames);
+    }
+
+    /**
+     * @brief Overrides the tiling picked at Init (see ConvolutionUtils::auto_tiling);
+     * tile_taps == 0 selects the untiled kernel. Tiles follow handle order, so they are
+     * cache-local when the handle is sorted by position. Call after Init.
+     */
+    void SetTiling(const ConvolutionUtils::TilingConfig& tiling)
+    {
+        assert(tiling.tile_taps == 0 || tiling.block_frames > 0);
+        tiling_ = tiling;
+    }
+
+    ConvolutionUtils::TilingConfig GetTiling() const { return tiling_; }
+
+    /**
+     * @brief Bytes SaveState needs for the current state.
+     */
+    size_t GetStateSize() const
+    {
+        ConvolutionUtils::StateWriter writer(nullptr, 0);
+        const_cast<SparseConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Size();
+    }
+
+    /**
+     * @brief Snapshots the engine into state: the live part of the buffer (the IR span
+     * ahead of the write head, not the whole buffer) plus the silence tracking and gain
+     * state. Real-time safe.
+     * @return Bytes written, 0 if capacity is below GetStateSize().
+     */
+    size_t SaveState(void* state, size_t capacity) const
+    {
+        ConvolutionUtils::StateWriter writer(state, capacity);
+        const_cast<SparseConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Ok() ? writer.Size() : 0;
+    }
+
+    /**
+     * @brief Restores a SaveState snapshot, e.g. to seek or to hand a voice over. The engine
+     * must be initialized with the same IR, buffer size, channel count and optional buffers;
+     * otherwise false is returned and the engine is left untouched. Real-time safe.
+     */
+    bool RestoreState(const void* state, size_t size)
+    {
+        ConvolutionUtils::StateReader check(state, size, false);
+        transfer_state(check);
+        if (!check.Done()) return false;
+
+        Reset();
+        ConvolutionUtils::StateReader reader(state, size, true);
+        transfer_state(reader);
+        return true;
+    }
+
+    /**
+     * @brief Drops the tail, as a new Init would, but clears only the cells that can hold
+     * it: none when idle, else the IR span ahead of the write head. IR, morph and gain
+     * state are kept. Real-time safe.
+     */
+    void Reset()
+    {
+        if (!tail_.IsIdle())
+            ConvolutionUtils::clear_ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Reset();
+    }
 
-    void Init(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels)
+protected:
+    void init_state(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+                    SparseRun* runs_buffer)
     {
         circ_buffer_  = circ_buffer;
         buffer_size_  = buffer_size;
@@ -39,16 +196,292 @@ public:
 
 		// Init empty buffer
         std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
-
-        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
-        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+        tail_.Reset();
+        channel_gains_ = nullptr;
 
         sparse_positions_ 			= handle.positions;
         sparse_values_    			= handle.values;
         num_sparse_taps_  			= handle.num_taps;
+        sparse_ir_length_           = ir_length(handle);
+        tiling_                     = ConvolutionUtils::auto_tiling(sparse_ir_length_, num_channels_);
         assert(sparse_positions_    || (num_sparse_taps_ == 0));        // != NULL
         assert(sparse_values_       || (num_sparse_taps_ == 0));        // != NULL
 
+        // Group clustered taps into runs if storage is provided
+        sparse_runs_ = runs_buffer;
+        num_sparse_runs_ = runs_buffer ? GroupRuns(handle, num_channels_, runs_buffer) : 0;
+    }
+
+    // Switches to a prebuilt run table of the Init handle, after init_state
+    void use_runs(const SparseRunTable& runs)
+    {
+        assert(runs.num_channels == num_channels_);
+        assert(runs.runs || runs.num_runs == 0);
+        sparse_runs_ = runs.runs;
+        num_sparse_runs_ = runs.num_runs;
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessImpl(const float* in, float* out, size_t size)
+    {
+        ProcessMix<WMode, CLayout, false>(in, out, size, 1.0f);
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessAccumulateImpl(const float* in, float* out, size_t size, float gain)
+    {
+        ProcessMix<WMode, CLayout, true>(in, out, size, gain);
+    }
+
+    // Overwrites out with the output, or with Accumulate adds gain times it; in == out is allowed
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessMix(const float* in, float* out, size_t size, float gain)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+        const size_t silent = ConvolutionUtils::trailing_silent_frames(in, size, num_ch);
+
+        // Drained buffer and silent input: the output stays zero (or untouched), only the head moves
+        if (tail_.IsIdle() && silent == size)
+        {
+            if constexpr (!Accumulate) std::fill(out, out + size * num_ch, 0.0f);
+            write_head_ = (write_head_ + size * num_ch) % buffer_size_;
+            if (channel_gains_)
+                for (size_t ch = 0; ch < num_ch; ch++) channel_gains_[ch].Skip(size);
+        }
+        else
+        {
+            ProcessKernel<WMode, CLayout, Accumulate>(in, out, size, gain);
+        }
+        tail_.Update(silent, size, sparse_ir_length_);
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessKernel(const float* in, float* out, size_t size, float gain)
+    {
+        const size_t num_ch = ConvolutionUtils::channel_count<CLayout>(num_channels_);
+        // Runs if grouped, else single taps
+        const size_t num_items = sparse_runs_ ? num_sparse_runs_ : num_sparse_taps_;
+
+        // SPARSE KERNEL: a block of frames per tile of items, then the block is extracted in bulk.
+        // Untiled, the whole IR is one tile. The writes reach (block + IR length - 1) frames
+        // ahead, which must not wrap onto unread cells.
+        const size_t buffer_frames = buffer_size_ / num_ch;
+        const size_t max_block = (sparse_ir_length_ < buffer_frames) ? buffer_frames - sparse_ir_length_ + 1 : 1;
+        const size_t tile = tiling_.tile_taps ? tiling_.tile_taps : num_items;
+        const size_t block_frames = tiling_.tile_taps ? std::min(tiling_.block_frames, max_block) : max_block;
+
+        while (size > 0)
+        {
+            const size_t block = std::min(size, block_frames);
+
+            for (size_t i0 = 0; i0 < num_items; i0 += tile)
+            {
+                const size_t i1 = std::min(i0 + tile, num_items);
+                if (sparse_runs_)
+                {
+                    for (size_t smp = 0; smp < block; smp++)
+                        ScatterRuns<WMode, CLayout>(in + smp * num_ch,
+                                                    ConvolutionUtils::wrap_address<WMode>(write_head_ + smp * num_ch, buffer_size_), i0, i1);
+                }
+                else
+                {
+                    ScatterTaps<WMode, CLayout>(in, block, i0, i1);
+                }
+            }
+
+            // Extract output and clear buffer
+            write_head_ = ConvolutionUtils::extract_frames<WMode, CLayout, Accumulate>(circ_buffer_, buffer_size_, write_head_, out, block,
+                                                                                        num_ch, channel_gains_, gain);
+
+            in   += block * num_ch;
+            out  += block * num_ch;
+            size -= block;
+        }
+    }
+
+    // Samples ahead of the write head that can still hold a tail
+    size_t live_size() const { return std::min(sparse_ir_length_ * num_channels_, buffer_size_); }
+
+    // Walks the state with a StateWriter or StateReader, in one fixed order
+    template <typename Archive>
+    void transfer_state(Archive& archive)
+    {
+        archive.Check(kStateTag);
+        archive.Check(buffer_size_);
+        archive.Check(num_channels_);
+        archive.Check(num_sparse_taps_);
+        archive.Check(sparse_ir_length_);
+        archive.Check(channel_gains_ ? 1 : 0);
+
+        archive.Ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Transfer(archive);
+        if (channel_gains_) archive.IoArray(channel_gains_, num_channels_);
+    }
+
+    static constexpr size_t kStateTag = 0x53505253; // "SPRS"
+
+    // Scatters runs [begin, end) of one input frame arriving at head
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ScatterRuns(const float* frame, size_t head, size_t begin, size_t end)
+    {
+        const size_t num_ch = num_channels_;
+
+        for (size_t r = begin; r < end; r++)
+        {
+            const SparseRun& run = sparse_runs_[r];
+            if (run.length >= kMinRunLength)
+            {
+                const size_t start = ConvolutionUtils::wrap_address<WMode>(head + run.offset, buffer_size_);
+                ConvolutionUtils::scatter_run<WMode, CLayout>(circ_buffer_, buffer_size_, start, frame,
+                                                              sparse_values_ + run.first_tap, run.length, num_ch);
+            }
+            else
+            {
+                size_t offset = head + run.offset;
+                for (size_t t = run.first_tap; t < run.first_tap + run.length; t++, offset += num_ch)
+                    ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) 
+                    {
+                        const size_t tap_pos = ConvolutionUtils::wrap_address<WMode>(offset + ch, buffer_size_);
+                        circ_buffer_[tap_pos] += frame[ch] * sparse_values_[t];
+                    }, num_channels_);
+            }
+        }
+    }
+
+    // Adds a block of interleaved input frames, scaled, at taps [begin, end). The block lands
+    // on consecutive cells, so each tap is one vector add whose position is scaled by the
+    // channel count once per block rather than per frame. Blocks of a frame or few (under
+    // kMinBlockScatterSamples samples) stay frame by frame, below the cost of the split at
+    // the wrap point.
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ScatterTaps(const float* in, size_t frames, size_t begin, size_t end)
+    {
+        const size_t num_ch = ConvolutionUtils::channel_count<CLayout>(num_channels_);
+        const size_t count = frames * num_ch;
+        const size_t head = write_head_;
+        const size_t buffer_size = buffer_size_;
+        float* const buffer = circ_buffer_;
+
+        if (count < kMinBlockScatterSamples)
+        {
+            for (size_t smp = 0; smp < frames; smp++)
+            {
+                const float* frame = in + smp * num_ch;
+                const size_t frame_head = head + smp * num_ch;
+                for (size_t t = begin; t < end; t++)
+                {
+                    const size_t start = frame_head + sparse_positions_[t] * num_ch;
+                    ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch)
+                    {
+                        buffer[ConvolutionUtils::wrap_address<WMode>(start + ch, buffer_size)] += frame[ch] * sparse_values_[t];
+                    }, num_ch);
+                }
+            }
+        }
+        else
+        {
+            for (size_t t = begin; t < end; t++)
+            {
+                const size_t start = ConvolutionUtils::wrap_address<WMode>(head + sparse_positions_[t] * num_ch, buffer_size);
+                ConvolutionUtils::scatter_block(buffer, buffer_size, start, in, sparse_values_[t], count);
+            }
+        }
+    }
+
+    size_t write_head_;
+    size_t buffer_size_;
+    size_t num_channels_;
+    float* circ_buffer_;
+
+	// Used for SPARSE kernel
+    const size_t* sparse_positions_;
+    const float*  sparse_values_;
+    size_t        num_sparse_taps_;
+    size_t        sparse_ir_length_;
+
+    // Cache tiling of the kernel, sized on the span of the IR
+    ConvolutionUtils::TilingConfig tiling_;
+
+    // Run-length grouping of the taps, with channel-strided offsets (optional, possibly shared)
+    const SparseRun* sparse_runs_;
+    size_t        num_sparse_runs_;
+
+    // Silence tracking for the idle fast path
+    ConvolutionUtils::TailTracker tail_;
+
+    // Per-channel output gain ramps (optional)
+    ConvolutionUtils::ChannelGain* channel_gains_;
+};
+
+/**
+ * @brief Sparse engine with wrapping mode and channel layout fixed at compile time.
+ * Process is a direct call into the kernel that the compiler can inline into the
+ * caller's loop; use it when the configuration is known up front.
+ */
+template <ConvolutionUtils::WrappingMode WMode, ConvolutionUtils::ChannelLayout CLayout>
+class SparseConvolutionEngineT : public SparseConvolutionEngineCore
+{
+public:
+    // Same arguments as SparseConvolutionEngine::Init; the configuration must match WMode and CLayout
+    void Init(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              SparseRun* runs_buffer = nullptr)
+    {
+        assert(num_channels == ConvolutionUtils::channel_count<CLayout>(num_channels));
+        assert(WMode == WrappingMode::ARBITRARY || ConvolutionUtils::is_power_of_two(buffer_size));
+
+        init_state(handle, circ_buffer, buffer_size, num_channels, runs_buffer);
+    }
+
+    // Same as above, with a prebuilt run table of handle for num_channels
+    void Init(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              const SparseRunTable& runs)
+    {
+        Init(handle, circ_buffer, buffer_size, num_channels);
+        use_runs(runs);
+    }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        this->template ProcessImpl<WMode, CLayout>(in, out, size);
+    }
+
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
+    {
+        this->template ProcessAccumulateImpl<WMode, CLayout>(in, out, size, gain);
+    }
+};
+
+/**
+ * @brief A generic, real-time safe convolution engine supporting sparse
+ * impulse responses with compile-time optimization for channel layout.
+ * Picks the kernel at Init from the runtime channel count and buffer size.
+ */
+class SparseConvolutionEngine : public SparseConvolutionEngineCore
+{
+    friend class ConvolutionEngineTest;
+    template<typename EngineType> friend class EngineWrapperImpl;
+public:
+    using ProcessFunctionPtr = void (SparseConvolutionEngine::*)(const float*, float*, size_t);
+    using AccumulateFunctionPtr = void (SparseConvolutionEngine::*)(const float*, float*, size_t, float);
+
+    SparseConvolutionEngine() : active_process_function_(nullptr), active_accumulate_function_(nullptr) {}
+    ~SparseConvolutionEngine() {}
+
+    /**
+     * @param runs_buffer Optional storage for num_taps SparseRun entries. When provided, taps at
+     * adjacent positions (in handle order) are grouped into runs at Init and each run of at least
+     * kMinRunLength taps is processed with the contiguous dense inner loop. Run offsets are
+     * prescaled by num_channels so the kernel never multiplies positions.
+     */
+    void Init(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              SparseRun* runs_buffer = nullptr)
+    {
+        init_state(handle, circ_buffer, buffer_size, num_channels, runs_buffer);
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+
         // Dispatch to the correct template specialization based on runtime channel count
         // and WrappingMode
         if (num_channels_ == 1)
@@ -69,16 +502,42 @@ public:
 		}
     }
 
+    /**
+     * @brief Init with a prebuilt run table of handle for num_channels (e.g. from IRCache::GetRuns),
+     * read-only and shared with other engines: no grouping work at Init.
+     */
+    void Init(const SparseIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              const SparseRunTable& runs)
+    {
+        Init(handle, circ_buffer, buffer_size, num_channels);
+        use_runs(runs);
+    }
+
+    /**
+     * @brief Writes size frames of output. in and out may be the same buffer (in-place),
+     * but must not otherwise overlap.
+     */
     void Process(const float* in, float* out, size_t size)
     {
         (this->*active_process_function_)(in, out, size);
     }
 
+    /**
+     * @brief Adds gain times the output to out instead of overwriting it, fused into the
+     * extraction, e.g. to mix several engines into one bus without a temporary buffer.
+     * When idle, out is left untouched.
+     */
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
+    {
+        (this->*active_accumulate_function_)(in, out, size, gain);
+    }
+
 protected:
     template <WrappingMode WMode, ChannelLayout CLayout>
     void set_process_function(WrappingMode)
     {
         active_process_function_ = &SparseConvolutionEngine::ProcessImpl<WMode, CLayout>;
+        active_accumulate_function_ = &SparseConvolutionEngine::ProcessAccumulateImpl<WMode, CLayout>;
     }
 
     void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
@@ -97,45 +556,8 @@ protected:
         }
     }
 
-
-    template <WrappingMode WMode, ChannelLayout CLayout>
-    void ProcessImpl(const float* in, float* out, size_t size)
-    {
-        const size_t num_ch = num_channels_;
-
-        for (size_t smp = 0; smp < size; smp++)
-        {
-            // SPARSE KERNEL
-            for (size_t t = 0; t < num_sparse_taps_; t++)
-                ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) 
-                {
-                    const size_t tap_pos = ConvolutionUtils::wrap_address<WMode>(write_head_ + ch + sparse_positions_[t] * num_ch, buffer_size_);
-                    circ_buffer_[tap_pos] += in[smp*num_ch + ch] * sparse_values_[t];
-                }, num_channels_);
-            
-            // Extract output and clear buffer
-            ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) {
-                out[smp * num_ch + ch] = circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)];
-				circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)] = 0.0f;
-            }, num_channels_);
-			
-			// Advance buffer head
-			write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + num_ch, buffer_size_);
-        }
-    }
-
-
     ProcessFunctionPtr active_process_function_;
-
-    size_t write_head_;
-    size_t buffer_size_;
-    size_t num_channels_;
-    float* circ_buffer_;
-
-	// Used for SPARSE kernel
-    const size_t* sparse_positions_;
-    const float*  sparse_values_;
-    size_t        num_sparse_taps_;
+    AccumulateFunctionPtr active_accumulate_function_;
 };
 
-#endif // SPARSE_CONVOLUTION_ENGINE_H
\ No newline at end of file
+#endif // SPARSE_CONVOLUTION_ENGINE_H
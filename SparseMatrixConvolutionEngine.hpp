@@ -0,0 +1,210 @@
+#pragma once
+#ifndef SPARSE_MATRIX_CONVOLUTION_ENGINE_H
+#define SPARSE_MATRIX_CONVOLUTION_ENGINE_H
+
+#include "IRHandle.hpp"
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+
+/**
+ * @brief One nonzero of the (position x output) tap matrix.
+ */
+struct SparseMatrixEntry
+{
+    size_t position;             /**< Tap position (the matrix row). */
+    size_t output;               /**< Index of the IR / output stream (the matrix column). */
+    float  value;                /**< Tap gain. */
+};
+
+/**
+ * @brief One row of the tap matrix: every tap, over all outputs, at one position.
+ */
+struct SparseMatrixRow
+{
+    size_t offset;               /**< Position, prescaled by the channel count. */
+    size_t first_entry;          /**< Index of the row's first entry. */
+    size_t num_entries;          /**< Number of entries in the row. */
+};
+
+/**
+ * @brief Convolves one input stream with many sparse IRs at once, producing one
+ * output stream per IR (e.g. the taps of a feedback delay network).
+ *
+ * The IRs are merged at Init into one sparse matrix in CSR form, rows being tap
+ * positions and columns outputs, and each block is computed as the product of that
+ * matrix with the input history. Every delayed input slice is loaded once per
+ * position, then added into each output tapping it, so positions shared by several
+ * IRs cost one load instead of one per IR. Work goes in chunks of kChunkSamples, so
+ * the slice and the output chunks stay in L1 across the rows.
+ */
+class SparseMatrixConvolutionEngine
+{
+public:
+    // Samples per chunk: one slice held on the stack while the row's entries consume it
+    static constexpr size_t kChunkSamples = 64;
+
+    SparseMatrixConvolutionEngine() : rows_(nullptr), num_rows_(0), entries_(nullptr), num_entries_(0), num_irs_(0),
+                                      history_(nullptr), history_size_(0), num_channels_(0), write_head_(0), max_block_(0) {}
+    ~SparseMatrixConvolutionEngine() {}
+
+    /**
+     * @brief Number of matrix entries (the total tap count), which sizes both Init buffers.
+     */
+    static size_t GetNumEntries(const SparseIRHandle* handles, size_t num_irs)
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < num_irs; i++) total += handles[i].num_taps;
+        return total;
+    }
+
+    /**
+     * @param handles Array of num_irs sparse IRs; copied into the matrix, they need not outlive Init.
+     * @param history_buffer Input history storage of history_size samples, holding at least the
+     * longest IR (history_size >= max ir_length * num_channels); extra room allows longer passes.
+     * @param row_buffer, entry_buffer Storage of GetNumEntries(handles, num_irs) elements each.
+     * @return false if the history is too short; Process then writes silence.
+     */
+    bool Init(const SparseIRHandle* handles, size_t num_irs, float* history_buffer, size_t history_size,
+              size_t num_channels, SparseMatrixRow* row_buffer, SparseMatrixEntry* entry_buffer)
+    {
+        num_irs_      = num_irs;
+        history_      = history_buffer;
+        history_size_ = history_size;
+        num_channels_ = num_channels;
+        write_head_   = 0;
+        rows_         = row_buffer;
+        entries_      = entry_buffer;
+        num_entries_  = GetNumEntries(handles, num_irs);
+
+        assert(handles || (num_irs_ == 0));        // != NULL
+        assert(history_);                          // != NULL
+        assert(num_channels_);                     // > 0
+        assert((rows_ && entries_) || (num_entries_ == 0));
+
+        // Collect the taps of all IRs, then sort them into rows of equal position
+        size_t max_length = 0;
+        size_t e = 0;
+        for (size_t i = 0; i < num_irs_; i++)
+        {
+            const SparseIRHandle& handle = handles[i];
+            for (size_t t = 0; t < handle.num_taps; t++)
+            {
+                entries_[e++] = { handle.positions[t], i, handle.values[t] };
+                max_length = std::max(max_length, handle.positions[t] + 1);
+            }
+        }
+        std::sort(entries_, entries_ + num_entries_, [](const SparseMatrixEntry& a, const SparseMatrixEntry& b)
+                  { return (a.position != b.position) ? a.position < b.position : a.output < b.output; });
+
+        num_rows_ = 0;
+        for (size_t i = 0; i < num_entries_; i++)
+        {
+            if (num_rows_ == 0 || entries_[i].position * num_channels_ != rows_[num_rows_ - 1].offset)
+                rows_[num_rows_++] = { entries_[i].position * num_channels_, i, 0 };
+            rows_[num_rows_ - 1].num_entries++;
+        }
+
+        // Frames that can be appended before the oldest sample still needed is overwritten;
+        // a history shorter than the longest IR is rejected and Process writes silence
+        const size_t history_frames = history_size_ / num_channels_;
+        const size_t min_frames = std::max<size_t>(max_length, 1);
+        max_block_ = (history_frames >= min_frames) ? history_frames - min_frames + 1 : 0;
+
+        // Init empty history
+        std::fill(history_, history_ + history_size_, 0.0f);
+        return max_block_ > 0;
+    }
+
+    /**
+     * @param in Interleaved input of size frames.
+     * @param outs Array of num_irs interleaved outputs of size frames each; overwritten.
+     */
+    void Process(const float* in, float* const* outs, size_t size)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+
+        if (max_block_ == 0)
+        {
+            for (size_t i = 0; i < num_irs_; i++) std::fill(outs[i], outs[i] + size * num_ch, 0.0f);
+            return;
+        }
+
+        for (size_t done = 0; done < size; )
+        {
+            const size_t block = std::min(size - done, max_block_);
+            const size_t count = block * num_ch;
+
+            // Append the block to the shared history
+            const float* src = in + done * num_ch;
+            const size_t first = std::min(count, history_size_ - write_head_);
+            std::copy(src, src + first, history_ + write_head_);
+            std::copy(src + first, src + count, history_);
+
+            for (size_t i = 0; i < num_irs_; i++)
+                std::fill(outs[i] + done * num_ch, outs[i] + done * num_ch + count, 0.0f);
+
+            // MATRIX KERNEL: per chunk, each row loads its delayed slice once and adds it
+            // into every output of the row
+            float slice[kChunkSamples];
+            for (size_t c0 = 0; c0 < count; c0 += kChunkSamples)
+            {
+                const size_t n = std::min(kChunkSamples, count - c0);
+                for (size_t r = 0; r < num_rows_; r++)
+                {
+                    const SparseMatrixRow& row = rows_[r];
+                    load_slice(slice, row.offset, c0, n);
+
+                    const SparseMatrixEntry* entry = entries_ + row.first_entry;
+                    for (size_t k = 0; k < row.num_entries; k++, entry++)
+                    {
+                        float* out = outs[entry->output] + done * num_ch + c0;
+                        const float value = entry->value;
+                        for (size_t s = 0; s < n; s++)
+                            out[s] += slice[s] * value;
+                    }
+                }
+            }
+
+            // Advance history head
+            write_head_ += count;
+            if (write_head_ >= history_size_) write_head_ -= history_size_;
+            done += block;
+        }
+    }
+
+    size_t GetNumIRs() const { return num_irs_; }
+
+    // Distinct tap positions over all IRs, i.e. slice loads per chunk
+    size_t GetNumRows() const { return num_rows_; }
+
+protected:
+    // Copies n samples of the block's input, delayed by offset samples and starting
+    // chunk_start samples into the block, into dst
+    void load_slice(float* dst, size_t offset, size_t chunk_start, size_t n) const
+    {
+        size_t start = write_head_ + chunk_start + history_size_ - offset;
+        while (start >= history_size_) start -= history_size_;
+        const size_t first = std::min(n, history_size_ - start);
+        std::copy(history_ + start, history_ + start + first, dst);
+        std::copy(history_, history_ + (n - first), dst + first);
+    }
+
+    // Tap matrix in CSR form
+    SparseMatrixRow*   rows_;
+    size_t             num_rows_;
+    SparseMatrixEntry* entries_;
+    size_t             num_entries_;
+    size_t             num_irs_;
+
+    // Shared interleaved input history
+    float*             history_;
+    size_t             history_size_;
+    size_t             num_channels_;
+    size_t             write_head_;
+    size_t             max_block_;
+};
+
+#endif // SPARSE_MATRIX_CONVOLUTION_ENGINE_H
@@ -0,0 +1,178 @@
+#pragma once
+#ifndef STREAMING_DENSE_CONVOLUTION_ENGINE_H
+#define STREAMING_DENSE_CONVOLUTION_ENGINE_H
+
+#include "ConvolutionUtils.hpp"
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+
+/**
+ * @brief Dense convolution with an IR that is still loading: processing starts with the
+ * taps available at Init, and later segments become active as a loader thread publishes them.
+ *
+ * The engine keeps the input history instead of scattering into an output buffer, and
+ * computes each block as one contiguous multiply-add per tap over that history (the
+ * read-side counterpart of the dense kernel, as in SparseMatrixConvolutionEngine). A
+ * segment published late therefore also applies to the input that arrived before it, so
+ * the output is exact from the moment the segment is visible, with no catch-up work.
+ *
+ * The IR storage is owned by the caller and sized for the whole IR. One loader thread
+ * writes the taps past the published count, then publishes them (PublishTaps, or
+ * AppendTaps to copy and publish). The tap count is an atomic, so publishing is lock-free
+ * and the audio thread sees it at the start of its next Process call.
+ */
+class StreamingDenseConvolutionEngine
+{
+public:
+    StreamingDenseConvolutionEngine() : ir_(nullptr), max_taps_(0), num_taps_(0), active_taps_(0), history_(nullptr),
+                                        history_size_(0), num_channels_(0), write_head_(0), max_block_(0) {}
+    ~StreamingDenseConvolutionEngine() {}
+
+    /**
+     * @brief History samples needed for an IR of max_taps taps, processed in blocks of up to
+     * max_block frames without splitting.
+     */
+    static size_t GetHistorySize(size_t max_taps, size_t max_block, size_t num_channels)
+    {
+        return (std::max<size_t>(max_taps, 1) + max_block - 1) * num_channels;
+    }
+
+    /**
+     * @param ir_buffer Storage for the whole IR (max_taps floats), whose first num_ready_taps
+     * taps are already loaded. Must outlive the engine.
+     * @param history_buffer Input history of history_size samples, at least
+     * GetHistorySize(max_taps, 1, num_channels); larger histories allow longer blocks.
+     */
+    void Init(float* ir_buffer, size_t max_taps, size_t num_ready_taps, float* history_buffer, size_t history_size,
+              size_t num_channels)
+    {
+        ir_           = ir_buffer;
+        max_taps_     = max_taps;
+        history_      = history_buffer;
+        history_size_ = history_size;
+        num_channels_ = num_channels;
+        write_head_   = 0;
+
+        assert(ir_ || (max_taps_ == 0));           // != NULL
+        assert(num_ready_taps <= max_taps_);
+        assert(history_);                          // != NULL
+        assert(num_channels_);                     // > 0
+        assert(history_size_ >= GetHistorySize(max_taps_, 1, num_channels_));
+
+        // Frames that can be appended before the oldest sample still needed is overwritten
+        max_block_ = history_size_ / num_channels_ - std::max<size_t>(max_taps_, 1) + 1;
+
+        num_taps_.store(num_ready_taps, std::memory_order_relaxed);
+        active_taps_ = num_ready_taps;
+
+        // Init empty history
+        std::fill(history_, history_ + history_size_, 0.0f);
+        tail_.Reset();
+    }
+
+    /**
+     * @brief Loader thread: makes the first num_taps taps of the IR buffer active. They must be
+     * written before the call; the count can only grow. Lock-free.
+     */
+    void PublishTaps(size_t num_taps)
+    {
+        assert(num_taps >= num_taps_.load(std::memory_order_relaxed));
+        assert(num_taps <= max_taps_);
+        num_taps_.store(num_taps, std::memory_order_release);
+    }
+
+    /**
+     * @brief Loader thread: copies the next count taps after the published ones into the IR
+     * buffer and publishes them.
+     */
+    void AppendTaps(const float* taps, size_t count)
+    {
+        const size_t num_taps = num_taps_.load(std::memory_order_relaxed);
+        assert(num_taps + count <= max_taps_);
+        std::copy(taps, taps + count, ir_ + num_taps);
+        PublishTaps(num_taps + count);
+    }
+
+    // Taps published so far; from any thread
+    size_t GetNumTaps() const { return num_taps_.load(std::memory_order_acquire); }
+    size_t GetMaxTaps() const { return max_taps_; }
+    bool IsComplete() const { return GetNumTaps() == max_taps_; }
+
+    /**
+     * @brief True while the input has been silent for at least the active IR length, i.e.
+     * Process only writes zeros.
+     */
+    bool IsIdle() const { return tail_.IsIdle(); }
+
+    /**
+     * @brief Attaches a counter, typically shared by all voices, of how many engines are idle.
+     */
+    void SetIdleCounter(std::atomic<size_t>* counter) { tail_.SetIdleCounter(counter); }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
+        const size_t num_ch = num_channels_;
+        const size_t frames = size;
+        const size_t silent = ConvolutionUtils::trailing_silent_frames(in, size, num_ch);
+
+        // Segments published since the last call; with a longer IR the input that went
+        // silent may be back in reach, so the idle state is re-evaluated
+        const size_t num_taps = num_taps_.load(std::memory_order_acquire);
+        if (num_taps != active_taps_)
+        {
+            active_taps_ = num_taps;
+            tail_.Update(0, 0, active_taps_);
+        }
+
+        // Drained history and silent input: the output stays zero, only the history moves
+        const bool idle = tail_.IsIdle() && silent == frames;
+
+        while (size > 0)
+        {
+            const size_t block = std::min(size, max_block_);
+            const size_t count = block * num_ch;
+
+            // Append the block to the history
+            const size_t first = std::min(count, history_size_ - write_head_);
+            std::copy(in, in + first, history_ + write_head_);
+            std::copy(in + first, in + count, history_);
+
+            // Output cells of tap k read the history k frames behind the block
+            std::fill(out, out + count, 0.0f);
+            if (!idle)
+            {
+                for (size_t k = 0; k < active_taps_; k++)
+                {
+                    const size_t start = (write_head_ + history_size_ - k * num_ch) % history_size_;
+                    ConvolutionUtils::gather_block(out, history_, history_size_, start, ir_[k], count);
+                }
+            }
+
+            write_head_ = (write_head_ + count) % history_size_;
+            in   += count;
+            out  += count;
+            size -= block;
+        }
+        tail_.Update(silent, frames, active_taps_);
+    }
+
+protected:
+    float*              ir_;
+    size_t              max_taps_;
+    std::atomic<size_t> num_taps_;       // Published by the loader thread
+    size_t              active_taps_;    // Taps used by the audio thread, read once per Process
+
+    float*  history_;
+    size_t  history_size_;
+    size_t  num_channels_;
+    size_t  write_head_;
+    size_t  max_block_;
+
+    // Silence tracking for the idle fast path
+    ConvolutionUtils::TailTracker tail_;
+};
+
+#endif // STREAMING_DENSE_CONVOLUTION_ENGINE_H
@@ -0,0 +1,342 @@
+// batch_render: convolves many short files, each with its own impulse response, in
+// one process. Jobs are spread over worker threads; each thread keeps a small pool
+// of initialized engines, and IRs are loaded once and shared by all jobs using them
+// at the same time (they are released once no pool holds them).
+//
+// usage: batch_render [options] <manifest>
+//   --type dense|sparse|velvet  engine type (default dense)
+//   --threads N                 worker threads (default: all cores)
+//   --pool N                    engines kept per thread (default 8)
+//   --quiet                     no per-job lines
+//
+// The manifest has one job per line, "input.wav|ir.wav|output.wav"; blank lines and
+// lines starting with '#' are skipped. Outputs include the IR tail. Sparse and velvet
+// IRs are derived from the IR file as in offline_render.
+
+#include "../../DenseConvolutionEngine.hpp"
+#include "../../SparseConvolutionEngine.hpp"
+#include "../../VelvetConvolutionEngine.hpp"
+#include "wav_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BatchOptions {
+    std::string type = "dense";
+    size_t threads = 0;
+    size_t pool_size = 8;
+    bool quiet = false;
+};
+
+struct Job {
+    std::string input, ir, output;
+};
+
+// An IR file with the handles of every engine type
+struct LoadedIR {
+    std::vector<float> samples;
+    std::vector<size_t> positions, velvet_pos, velvet_neg;
+    std::vector<float> values;
+    DenseIRHandle dense;
+    SparseIRHandle sparse;
+    VelvetIRHandle velvet;
+
+    const DenseIRHandle& Handle(const DenseConvolutionEngine*) const { return dense; }
+    const SparseIRHandle& Handle(const SparseConvolutionEngine*) const { return sparse; }
+    const VelvetIRHandle& Handle(const VelvetConvolutionEngine*) const { return velvet; }
+};
+
+// IRs by path, loaded by the first job that needs them. The file is read outside the lock, so
+// other workers only wait for IRs being loaded, not for each other; jobs asking for an IR
+// in flight wait for that one load. Only weak references are kept: an IR is freed once no
+// job or engine pool uses it and reloaded if needed again. Failed loads are remembered.
+class IRLibrary {
+public:
+    std::shared_ptr<const LoadedIR> Get(const std::string& path) {
+        std::shared_future<std::shared_ptr<const LoadedIR>> pending;
+        std::promise<std::shared_ptr<const LoadedIR>> promise;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Slot& slot = slots_[path];
+            if (slot.failed) return nullptr;
+            if (auto ir = slot.ir.lock()) {
+                hits_++;
+                return ir;
+            }
+            if (slot.pending.valid()) {
+                hits_++;
+                pending = slot.pending;
+            } else {
+                slot.pending = promise.get_future().share();
+                loads_++;
+            }
+        }
+        if (pending.valid()) return pending.get();
+
+        const auto ir = Load(path);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Slot& slot = slots_[path];
+            slot.ir = ir;
+            slot.failed = !ir;
+            slot.pending = {};
+            // Forget the IRs nobody holds any more
+            for (auto it = slots_.begin(); it != slots_.end(); )
+                it = (!it->second.failed && !it->second.pending.valid() && it->second.ir.expired()) ? slots_.erase(it) : std::next(it);
+        }
+        promise.set_value(ir);
+        return ir;
+    }
+
+    size_t loads() const { return loads_; }
+    size_t hits() const { return hits_; }
+
+private:
+    struct Slot {
+        std::weak_ptr<const LoadedIR> ir;
+        std::shared_future<std::shared_ptr<const LoadedIR>> pending;   // Valid while loading
+        bool failed = false;
+    };
+
+    static std::shared_ptr<const LoadedIR> Load(const std::string& path) {
+        auto ir = std::make_shared<LoadedIR>();
+        if (!LoadWavMono(path, ir->samples)) return nullptr;
+        for (size_t i = 0; i < ir->samples.size(); i++) {
+            const float sample = ir->samples[i];
+            if (sample == 0.0f) continue;
+            ir->positions.push_back(i);
+            ir->values.push_back(sample);
+            (sample < 0.0f ? ir->velvet_neg : ir->velvet_pos).push_back(i);
+        }
+        ir->dense = {ir->samples.data(), ir->samples.size()};
+        ir->sparse = {ir->positions.data(), ir->values.data(), ir->positions.size()};
+        ir->velvet = {ir->velvet_pos.data(), ir->velvet_pos.size(), ir->velvet_neg.data(), ir->velvet_neg.size()};
+        return ir;
+    }
+
+    std::mutex mutex_;
+    std::map<std::string, Slot> slots_;
+    size_t loads_ = 0;
+    size_t hits_ = 0;
+};
+
+// Initialized engines of one worker, reused (after a Reset) by jobs with the same IR and channel count
+template<typename EngineType>
+class EnginePool {
+public:
+    static constexpr size_t kBlockFrames = 4096;
+
+    explicit EnginePool(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    EngineType& Acquire(const std::shared_ptr<const LoadedIR>& ir, size_t num_channels) {
+        clock_++;
+        for (auto& entry : entries_) {
+            if (entry->ir == ir && entry->num_channels == num_channels) {
+                entry->last_use = clock_;
+                entry->engine.Reset();
+                reuses_++;
+                return entry->engine;
+            }
+        }
+
+        // Replace the least recently used engine, keeping its buffer if it is large enough
+        if (entries_.size() < capacity_) entries_.push_back(std::make_unique<Entry>());
+        Entry& entry = **std::min_element(entries_.begin(), entries_.end(),
+                                          [](const auto& a, const auto& b) { return a->last_use < b->last_use; });
+        const auto& handle = ir->Handle(static_cast<const EngineType*>(nullptr));
+        const size_t size = EngineType::GetBufferSize(handle, num_channels, kBlockFrames);
+        if (entry.buffer.size() < size) entry.buffer.resize(size);
+        entry.ir = ir;
+        entry.num_channels = num_channels;
+        entry.last_use = clock_;
+        entry.engine.Init(handle, entry.buffer.data(), size, num_channels);
+        inits_++;
+        return entry.engine;
+    }
+
+    size_t inits() const { return inits_; }
+    size_t reuses() const { return reuses_; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const LoadedIR> ir;
+        size_t num_channels = 0;
+        size_t last_use = 0;
+        std::vector<float> buffer;
+        EngineType engine;
+    };
+
+    size_t capacity_;
+    size_t clock_ = 0;
+    size_t inits_ = 0, reuses_ = 0;
+    std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+struct JobResult {
+    bool ok = false;
+    size_t frames = 0, channels = 0;
+    uint32_t sample_rate = 0;
+    double seconds = 0.0;
+};
+
+template<typename EngineType>
+static JobResult RunJob(const Job& job, IRLibrary& library, EnginePool<EngineType>& pool, std::vector<float>& in, std::vector<float>& out) {
+    JobResult result;
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto ir = library.Get(job.ir);
+    WavReader reader;
+    if (!ir || !reader.Open(job.input)) return result;
+    WavWriter writer;
+    if (!writer.Open(job.output, reader.channels(), reader.sample_rate())) return result;
+
+    const size_t num_ch = reader.channels();
+    const size_t block = EnginePool<EngineType>::kBlockFrames;
+    EngineType& engine = pool.Acquire(ir, num_ch);
+    in.resize(block * num_ch);
+    out.resize(block * num_ch);
+
+    // The input, then the IR tail driven by silence
+    size_t tail = ir_length(ir->Handle(static_cast<const EngineType*>(nullptr)));
+    tail = tail ? tail - 1 : 0;
+    for (;;) {
+        size_t got = reader.Read(in.data(), block);
+        if (got == 0) {
+            if (tail == 0) break;
+            got = std::min(tail, block);
+            std::fill(in.begin(), in.begin() + got * num_ch, 0.0f);
+            tail -= got;
+        }
+        engine.Process(in.data(), out.data(), got);
+        if (!writer.Write(out.data(), got)) return result;
+        result.frames += got;
+    }
+
+    result.ok = true;
+    result.channels = num_ch;
+    result.sample_rate = reader.sample_rate();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+template<typename EngineType>
+static int RunBatch(const std::vector<Job>& jobs, const BatchOptions& options) {
+    const size_t num_threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    IRLibrary library;
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<size_t> next_job(0);
+    std::atomic<size_t> inits(0), reuses(0);
+    std::mutex print_mutex;
+
+    // Jobs sharing an IR run back to back, so the engine pools mostly hit
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return jobs[a].ir < jobs[b].ir; });
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < num_threads; t++) {
+        workers.emplace_back([&] {
+            EnginePool<EngineType> pool(options.pool_size);
+            std::vector<float> in, out;
+            for (size_t n; (n = next_job.fetch_add(1)) < jobs.size(); ) {
+                const size_t j = order[n];
+                results[j] = RunJob(jobs[j], library, pool, in, out);
+                if (!options.quiet || !results[j].ok) {
+                    std::lock_guard<std::mutex> lock(print_mutex);
+                    if (results[j].ok)
+                        std::printf("job %zu: %s, %zu frames x %zu ch, %.2f ms (%.0fx realtime)\n", j, jobs[j].output.c_str(),
+                                    results[j].frames, results[j].channels, results[j].seconds * 1e3,
+                                    results[j].frames / results[j].seconds / results[j].sample_rate);
+                    else
+                        std::fprintf(stderr, "job %zu: failed (%s, %s -> %s)\n", j, jobs[j].input.c_str(),
+                                     jobs[j].ir.c_str(), jobs[j].output.c_str());
+                }
+            }
+            inits += pool.inits();
+            reuses += pool.reuses();
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0, samples = 0;
+    double job_seconds = 0.0, slowest = 0.0;
+    for (const auto& result : results) {
+        if (!result.ok) { failed++; continue; }
+        samples += result.frames * result.channels;
+        job_seconds += result.seconds;
+        slowest = std::max(slowest, result.seconds);
+    }
+    const size_t done = jobs.size() - failed;
+    std::printf("%zu jobs (%zu failed) in %.3f s on %zu threads\n", jobs.size(), failed, seconds, num_threads);
+    std::printf("throughput: %.3f Msamples/s, %.1f jobs/s\n", samples / seconds / 1e6, done / seconds);
+    std::printf("per job: %.2f ms mean, %.2f ms max\n", done ? job_seconds / done * 1e3 : 0.0, slowest * 1e3);
+    std::printf("IR loads: %zu (%zu shared), engines initialized: %zu (%zu reused)\n",
+                library.loads(), library.hits(), inits.load(), reuses.load());
+    return failed ? 1 : 0;
+}
+
+static bool ReadManifest(const std::string& path, std::vector<Job>& jobs) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        for (std::string field; std::getline(stream, field, '|'); ) fields.push_back(field);
+        if (fields.size() != 3) {
+            std::fprintf(stderr, "error: bad manifest line: %s\n", line.c_str());
+            return false;
+        }
+        jobs.push_back({fields[0], fields[1], fields[2]});
+    }
+    return true;
+}
+
+static void PrintUsage() {
+    std::fprintf(stderr, "usage: batch_render [--type dense|sparse|velvet] [--threads N] [--pool N] [--quiet] <manifest>\n");
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--type" && i + 1 < argc) options.type = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) options.threads = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--pool" && i + 1 < argc) options.pool_size = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--quiet") options.quiet = true;
+        else paths.push_back(arg);
+    }
+    if (paths.size() != 1) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+    if (!ReadManifest(paths[0], jobs)) {
+        std::fprintf(stderr, "error: cannot read %s\n", paths[0].c_str());
+        return 1;
+    }
+
+    if (options.type == "dense") return RunBatch<DenseConvolutionEngine>(jobs, options);
+    if (options.type == "sparse") return RunBatch<SparseConvolutionEngine>(jobs, options);
+    if (options.type == "velvet") return RunBatch<VelvetConvolutionEngine>(jobs, options);
+    PrintUsage();
+    return 1;
+}
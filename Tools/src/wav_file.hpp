@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Minimal streaming WAV reader/writer for the command line tools.
+// Reads 16/24/32-bit PCM and 32-bit float, writes 32-bit float.
+// Both sides go through large stdio buffers so hour-long files stream without
+// ever being fully resident.
+
+static constexpr size_t kWavIOBufferBytes = 8 << 20;
+
+class WavReader {
+public:
+    ~WavReader() { Close(); }
+
+    bool Open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) return false;
+        std::setvbuf(file_, nullptr, _IOFBF, kWavIOBufferBytes);
+
+        char riff[12];
+        if (std::fread(riff, 1, 12, file_) != 12 || std::memcmp(riff, "RIFF", 4) || std::memcmp(riff + 8, "WAVE", 4))
+            return false;
+
+        bool have_fmt = false;
+        char id[4];
+        uint32_t size;
+        while (std::fread(id, 1, 4, file_) == 4 && std::fread(&size, 4, 1, file_) == 1) {
+            if (!std::memcmp(id, "fmt ", 4)) {
+                std::vector<uint8_t> fmt(size);
+                if (std::fread(fmt.data(), 1, size, file_) != size || size < 16) return false;
+                uint16_t format_tag;
+                std::memcpy(&format_tag, &fmt[0], 2);
+                std::memcpy(&channels_, &fmt[2], 2);
+                std::memcpy(&sample_rate_, &fmt[4], 4);
+                std::memcpy(&bits_, &fmt[14], 2);
+                if (format_tag == 0xFFFE && size >= 26) std::memcpy(&format_tag, &fmt[24], 2); // WAVE_FORMAT_EXTENSIBLE
+                is_float_ = (format_tag == 3);
+                if (format_tag != 1 && format_tag != 3) return false;
+                if (is_float_ && bits_ != 32) return false;
+                if (!is_float_ && bits_ != 16 && bits_ != 24 && bits_ != 32) return false;
+                if (size & 1) std::fseek(file_, 1, SEEK_CUR);
+                have_fmt = true;
+            } else if (!std::memcmp(id, "data", 4)) {
+                if (!have_fmt || channels_ == 0) return false;
+                num_frames_ = size / (channels_ * (bits_ / 8));
+                frames_left_ = num_frames_;
+                return true;
+            } else {
+                std::fseek(file_, size + (size & 1), SEEK_CUR);
+            }
+        }
+        return false;
+    }
+
+    // Reads up to `frames` interleaved frames, returns the number actually read
+    size_t Read(float* dst, size_t frames) {
+        frames = frames < frames_left_ ? frames : frames_left_;
+        const size_t bytes_per_sample = bits_ / 8;
+        const size_t num_samples = frames * channels_;
+        raw_.resize(num_samples * bytes_per_sample);
+        const size_t got = std::fread(raw_.data(), bytes_per_sample * channels_, frames, file_);
+        const uint8_t* p = raw_.data();
+        for (size_t i = 0; i < got * channels_; i++, p += bytes_per_sample) {
+            if (is_float_) {
+                std::memcpy(&dst[i], p, 4);
+            } else if (bits_ == 16) {
+                int16_t v; std::memcpy(&v, p, 2);
+                dst[i] = v / 32768.0f;
+            } else if (bits_ == 24) {
+                int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24);
+                dst[i] = (v >> 8) / 8388608.0f;
+            } else {
+                int32_t v; std::memcpy(&v, p, 4);
+                dst[i] = v / 2147483648.0f;
+            }
+        }
+        frames_left_ -= got;
+        return got;
+    }
+
+    void Close() {
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    size_t channels() const { return channels_; }
+    uint32_t sample_rate() const { return sample_rate_; }
+    size_t num_frames() const { return num_frames_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    uint16_t channels_ = 0;
+    uint16_t bits_ = 0;
+    uint32_t sample_rate_ = 0;
+    bool is_float_ = false;
+    size_t num_frames_ = 0;
+    size_t frames_left_ = 0;
+    std::vector<uint8_t> raw_;
+};
+
+class WavWriter {
+public:
+    ~WavWriter() { Close(); }
+
+    bool Open(const std::string& path, size_t channels, uint32_t sample_rate) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) return false;
+        std::setvbuf(file_, nullptr, _IOFBF, kWavIOBufferBytes);
+        channels_ = channels;
+        sample_rate_ = sample_rate;
+        data_bytes_ = 0;
+        WriteHeader(); // Sizes are patched in Close()
+        return true;
+    }
+
+    // Fails once the 4 GB RIFF limit would be exceeded
+    bool Write(const float* src, size_t frames) {
+        const uint64_t bytes = (uint64_t)frames * channels_ * 4;
+        if (data_bytes_ + bytes > 0xFFFFFFFFull - 36) return false;
+        data_bytes_ += bytes;
+        return std::fwrite(src, channels_ * 4, frames, file_) == frames;
+    }
+
+    void Close() {
+        if (!file_) return;
+        std::fseek(file_, 0, SEEK_SET);
+        WriteHeader();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    void WriteHeader() {
+        const uint32_t data_bytes = (uint32_t)data_bytes_;
+        const uint32_t riff_size = 36 + data_bytes;
+        const uint16_t format_tag = 3, channels = (uint16_t)channels_, bits = 32;
+        const uint16_t block_align = (uint16_t)(channels_ * 4);
+        const uint32_t byte_rate = sample_rate_ * block_align;
+        const uint32_t fmt_size = 16;
+        std::fwrite("RIFF", 1, 4, file_); std::fwrite(&riff_size, 4, 1, file_);
+        std::fwrite("WAVEfmt ", 1, 8, file_); std::fwrite(&fmt_size, 4, 1, file_);
+        std::fwrite(&format_tag, 2, 1, file_); std::fwrite(&channels, 2, 1, file_);
+        std::fwrite(&sample_rate_, 4, 1, file_); std::fwrite(&byte_rate, 4, 1, file_);
+        std::fwrite(&block_align, 2, 1, file_); std::fwrite(&bits, 2, 1, file_);
+        std::fwrite("data", 1, 4, file_); std::fwrite(&data_bytes, 4, 1, file_);
+    }
+
+    std::FILE* file_ = nullptr;
+    size_t channels_ = 0;
+    uint32_t sample_rate_ = 0;
+    uint64_t data_bytes_ = 0;
+};
+
+// Loads the first channel of a WAV file, used for impulse responses
+inline bool LoadWavMono(const std::string& path, std::vector<float>& samples, uint32_t* sample_rate = nullptr) {
+    WavReader reader;
+    if (!reader.Open(path)) return false;
+    std::vector<float> interleaved(reader.num_frames() * reader.channels());
+    const size_t frames = reader.Read(interleaved.data(), reader.num_frames());
+    samples.resize(frames);
+    for (size_t i = 0; i < frames; i++) samples[i] = interleaved[i * reader.channels()];
+    if (sample_rate) *sample_rate = reader.sample_rate();
+    return true;
+}
@@ -0,0 +1,316 @@
+// rt_safety: checks that the real-time entry points of the engines never allocate, free
+// or take a lock, and records their worst-case execution time.
+//
+// malloc/calloc/realloc/free, operator new/delete and pthread_mutex_lock/trylock are
+// replaced in this executable. While a thread is "armed" each call is counted; the calls
+// still go through, so a violation is reported instead of crashing. Process, the morph
+// updates and the other real-time safe calls run armed, over randomized runs of every
+// configuration of the unit test matrix (block sizes, silence, morphs, gain ramps,
+// snapshots). Init and the buffers are set up disarmed.
+//
+// usage: rt_safety [--runs N] [--seed N] [--max-ns-per-frame N]
+//   --runs N               randomized runs per configuration (default 20)
+//   --seed N               seed of the randomization (default 1); runs are deterministic
+//   --max-ns-per-frame N   also fail if a call's time per frame exceeds N (default: report only)
+//
+// Linux / glibc only. Returns non-zero on any allocation or lock in an armed call.
+
+#include "../src/test_configs.hpp"
+#include "../src/generated_test_data.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <new>
+#include <pthread.h>
+#include <random>
+#include <string>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+}
+
+namespace {
+
+enum Violation { kMalloc, kFree, kNew, kDelete, kMutex, kNumViolations };
+const char* const kViolationNames[kNumViolations] = {"malloc", "free", "operator new", "operator delete", "mutex lock"};
+
+// Per thread, so that other threads (none today) cannot trip the check
+thread_local bool t_armed = false;
+thread_local size_t t_hits[kNumViolations] = {};
+
+inline void Record(Violation violation) {
+    if (t_armed) t_hits[violation]++;
+}
+
+size_t TotalHits() {
+    size_t total = 0;
+    for (size_t hits : t_hits) total += hits;
+    return total;
+}
+
+} // namespace
+
+// --- Interposed allocator and locks ---
+
+extern "C" {
+
+void* malloc(size_t size) { Record(kMalloc); return __libc_malloc(size); }
+void* calloc(size_t count, size_t size) { Record(kMalloc); return __libc_calloc(count, size); }
+void* realloc(void* ptr, size_t size) { Record(kMalloc); return __libc_realloc(ptr, size); }
+void* aligned_alloc(size_t alignment, size_t size) { Record(kMalloc); return __libc_memalign(alignment, size); }
+void* memalign(size_t alignment, size_t size) { Record(kMalloc); return __libc_memalign(alignment, size); }
+void free(void* ptr) { if (ptr) Record(kFree); __libc_free(ptr); }
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    using LockFn = int (*)(pthread_mutex_t*);
+    static LockFn real = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    Record(kMutex);
+    return real(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    using LockFn = int (*)(pthread_mutex_t*);
+    static LockFn real = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_trylock"));
+    Record(kMutex);
+    return real(mutex);
+}
+
+} // extern "C"
+
+void* operator new(size_t size) {
+    Record(kNew);
+    if (void* ptr = __libc_malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { Record(kNew); return __libc_malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { Record(kNew); return __libc_malloc(size ? size : 1); }
+void operator delete(void* ptr) noexcept { if (ptr) Record(kDelete); __libc_free(ptr); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+struct Options {
+    size_t runs = 20;
+    unsigned seed = 1;
+    double max_ns_per_frame = 0.0;
+};
+
+// Worst case of one configuration, and where violations happened
+struct Report {
+    double worst_ns = 0.0;           // Slowest single armed call
+    double worst_ns_per_frame = 0.0; // Slowest armed call per frame processed
+    size_t calls = 0;
+    size_t violations = 0;
+    std::string first_violation;
+};
+
+// Runs one real-time call armed, timing it and charging any hit to report
+template<typename Call>
+void Armed(const char* what, size_t frames, Report& report, Call&& call) {
+    std::fill(t_hits, t_hits + kNumViolations, 0);
+    const auto start = std::chrono::steady_clock::now();
+    t_armed = true;
+    call();
+    t_armed = false;
+    const auto stop = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+    report.calls++;
+    report.worst_ns = std::max(report.worst_ns, ns);
+    if (frames) report.worst_ns_per_frame = std::max(report.worst_ns_per_frame, ns / frames);
+
+    if (const size_t hits = TotalHits()) {
+        report.violations += hits;
+        if (report.first_violation.empty()) {
+            report.first_violation = what;
+            for (size_t v = 0; v < kNumViolations; v++)
+                if (t_hits[v]) report.first_violation += std::string(" ") + kViolationNames[v] + " x" + std::to_string(t_hits[v]);
+        }
+    }
+}
+
+// Input of the run: signal bursts and stretches of silence long enough to reach the idle path
+void FillInput(std::vector<float>& in, size_t num_ch, std::mt19937& rng) {
+    size_t frame = 0;
+    const size_t frames = in.size() / num_ch;
+    while (frame < frames) {
+        const size_t length = std::min(frames - frame, size_t(rng() % 3000 + 1));
+        const bool silent = rng() % 3 == 0;
+        for (size_t i = frame; i < frame + length; i++)
+            for (size_t ch = 0; ch < num_ch; ch++)
+                in[i * num_ch + ch] = silent ? 0.0f : input_signal[i % input_signal_size] * (ch + 1);
+        frame += length;
+    }
+}
+
+// Engine-specific setup and real-time calls
+struct DenseCase {
+    using Engine = DenseConvolutionEngine;
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    std::vector<float> target, current, delta;
+
+    DenseCase() : target(dense_ir, dense_ir + dense_ir_size), current(dense_ir_size), delta(dense_ir_size) {
+        std::reverse(target.begin(), target.end());
+    }
+    void Init(Engine& engine, std::vector<float>& buffer, size_t num_ch, std::mt19937&) {
+        engine.Init(handle, buffer.data(), buffer.size(), num_ch, current.data(), delta.data());
+    }
+    void StartMorph(Engine& engine, std::mt19937& rng) { engine.MorphIRDense({target.data(), target.size()}, int(rng() % 64 + 1)); }
+    void UpdateMorph(Engine& engine) { engine.MorphIRDense_Update(); }
+    static const char* MorphName() { return "MorphIRDense_Update"; }
+};
+
+struct SparseCase {
+    using Engine = SparseConvolutionEngine;
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    std::vector<SparseRun> runs = std::vector<SparseRun>(sparse_ir_positions_size);
+
+    void Init(Engine& engine, std::vector<float>& buffer, size_t num_ch, std::mt19937& rng) {
+        engine.Init(handle, buffer.data(), buffer.size(), num_ch, rng() % 2 ? runs.data() : nullptr);
+    }
+    void StartMorph(Engine&, std::mt19937&) {}
+    void UpdateMorph(Engine&) {}
+    static const char* MorphName() { return nullptr; }
+};
+
+struct VelvetCase {
+    using Engine = VelvetConvolutionEngine;
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    // Morph target: half the positive taps, all the negative ones
+    VelvetIRHandle target = {velvet_ir_pos_positions, velvet_ir_pos_positions_size / 2,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    size_t max_taps = std::max(velvet_ir_pos_positions_size, velvet_ir_neg_positions_size);
+    std::vector<size_t> work = std::vector<size_t>(8 * max_taps);
+
+    void Init(Engine& engine, std::vector<float>& buffer, size_t num_ch, std::mt19937& rng) {
+        size_t* w = work.data();
+        const bool offsets = rng() % 2;
+        engine.Init(handle, buffer.data(), buffer.size(), num_ch, w, w + max_taps, w + 2 * max_taps, w + 3 * max_taps,
+                    w + 4 * max_taps, w + 5 * max_taps, max_taps, max_taps,
+                    offsets ? w + 6 * max_taps : nullptr, offsets ? w + 7 * max_taps : nullptr);
+    }
+    void StartMorph(Engine& engine, std::mt19937& rng) { engine.MorphIRVelvet(rng() % 2 ? target : handle); }
+    void UpdateMorph(Engine& engine) { engine.MorphIRVelvet_Update(); }
+    static const char* MorphName() { return "MorphIRVelvet_Update"; }
+};
+
+template<typename Case>
+Report RunConfig(const TestConfig& config, const Options& options, std::mt19937& rng) {
+    using Engine = typename Case::Engine;
+    const size_t num_ch = config.num_channels;
+    const size_t frames = 20000;
+    Report report;
+
+    Case setup;
+    std::vector<float> buffer(config.buffer_size), in(frames * num_ch), out(frames * num_ch);
+    std::vector<ConvolutionUtils::ChannelGain> gains(num_ch);
+    Engine engine;
+
+    for (size_t run = 0; run < options.runs; run++) {
+        FillInput(in, num_ch, rng);
+        setup.Init(engine, buffer, num_ch, rng);
+        const bool with_gains = rng() % 2;
+        if (with_gains) engine.SetChannelGainBuffer(gains.data());
+        std::vector<unsigned char> state(engine.GetStateSize() + 4096);
+
+        for (size_t pos = 0; pos < frames; ) {
+            // Block sizes from 1 to twice the configuration's
+            const size_t block = std::min(frames - pos, size_t(rng() % (2 * config.block_size) + 1));
+            Armed("Process", block, report, [&] { engine.Process(in.data() + pos * num_ch, out.data() + pos * num_ch, block); });
+            pos += block;
+
+            const unsigned event = rng() % 16;
+            if (event == 0 && Case::MorphName())
+                Armed("morph start", 0, report, [&] { setup.StartMorph(engine, rng); });
+            else if (event == 1 && with_gains)
+                Armed("SetChannelGain", 0, report, [&] { engine.SetChannelGain(rng() % num_ch, (rng() % 100) / 50.0f, rng() % 500); });
+            else if (event == 2)
+                Armed("SaveState/RestoreState", 0, report, [&] {
+                    const size_t size = engine.SaveState(state.data(), state.size());
+                    engine.RestoreState(state.data(), size);
+                });
+            else if (event == 3)
+                Armed("Reset", 0, report, [&] { engine.Reset(); });
+
+            if (Case::MorphName())
+                Armed(Case::MorphName(), 0, report, [&] { setup.UpdateMorph(engine); });
+        }
+    }
+    return report;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--runs") && has_value) options.runs = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seed") && has_value) options.seed = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--max-ns-per-frame") && has_value) options.max_ns_per_frame = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--runs N] [--seed N] [--max-ns-per-frame N]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// The check is only meaningful if the interposition is live: trip it on purpose once
+bool InterpositionWorks() {
+    Report report;
+    Armed("self test", 0, report, [] {
+        void* volatile ptr = std::malloc(16);
+        std::free(ptr);
+        int* volatile object = new int(1);
+        delete object;
+        pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+        pthread_mutex_lock(&mutex);
+        pthread_mutex_unlock(&mutex);
+    });
+    return report.violations == 5;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+    if (!InterpositionWorks()) {
+        std::fprintf(stderr, "rt_safety: allocator/lock interposition is not active, nothing would be detected\n");
+        return 2;
+    }
+
+    std::mt19937 rng(options.seed);
+    size_t failures = 0;
+    std::printf("%-32s %8s %12s %14s  %s\n", "config", "calls", "worst us", "worst ns/frame", "result");
+    for (const auto& config : test_configs) {
+        Report report;
+        switch (config.ir_type) {
+            case IRType::DENSE:  report = RunConfig<DenseCase>(config, options, rng); break;
+            case IRType::SPARSE: report = RunConfig<SparseCase>(config, options, rng); break;
+            case IRType::VELVET: report = RunConfig<VelvetCase>(config, options, rng); break;
+        }
+
+        std::string result = "ok";
+        if (report.violations) {
+            result = "FAIL: " + std::to_string(report.violations) + " hits, first in " + report.first_violation;
+        } else if (options.max_ns_per_frame > 0.0 && report.worst_ns_per_frame > options.max_ns_per_frame) {
+            result = "FAIL: over the time budget";
+        }
+        if (result != "ok") failures++;
+        std::printf("%-32s %8zu %12.1f %14.1f  %s\n", ConfigName(config).c_str(), report.calls,
+                    report.worst_ns * 1e-3, report.worst_ns_per_frame, result.c_str());
+    }
+    std::printf("%zu of %zu configurations failed\n", failures, test_configs.size());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+
+using WMode = ConvolutionUtils::WrappingMode;
+using CLayout = ConvolutionUtils::ChannelLayout;
+
+// Runs Process out of place, Process in place and ProcessAccumulate into a prefilled bus
+// over the same input in uneven blocks, on three engines initialized alike
+template<typename EngineType, typename HandleType, typename Setup>
+static void ExpectInPlaceAndAccumulate(const HandleType& handle, size_t buffer_size, size_t num_ch, Setup setup) {
+    const auto in = MakeInterleavedInput(input_signal_size, num_ch);
+    std::vector<float> buffers[3] = {std::vector<float>(buffer_size), std::vector<float>(buffer_size), std::vector<float>(buffer_size)};
+    EngineType engines[3];
+    for (size_t e = 0; e < 3; e++) {
+        engines[e].Init(handle, buffers[e].data(), buffer_size, num_ch);
+        setup(engines[e]);
+    }
+
+    const float gain = 0.5f;
+    std::vector<float> expected(in.size()), in_place(in), bus(in.size());
+    for (size_t i = 0; i < bus.size(); i++) bus[i] = 0.25f * std::sin(0.1f * i);
+    const std::vector<float> bus_before = bus;
+
+    for (size_t start = 0; start < input_signal_size; start += 29) {
+        const size_t frames = std::min<size_t>(29, input_signal_size - start);
+        const size_t offset = start * num_ch;
+        engines[0].Process(in.data() + offset, expected.data() + offset, frames);
+        engines[1].Process(in_place.data() + offset, in_place.data() + offset, frames);
+        engines[2].ProcessAccumulate(in.data() + offset, bus.data() + offset, frames, gain);
+    }
+    for (size_t i = 0; i < in.size(); i++) {
+        ASSERT_EQ(in_place[i], expected[i]) << "in place, sample " << i;
+        ASSERT_NEAR(bus[i], bus_before[i] + gain * expected[i], 1e-6) << "accumulate, sample " << i;
+    }
+}
+
+static const auto kNoSetup = [](auto&) {};
+
+TEST(AccumulateTest, Dense) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    ExpectInPlaceAndAccumulate<DenseConvolutionEngine>(handle, 512, 1, kNoSetup);
+    ExpectInPlaceAndAccumulate<DenseConvolutionEngine>(handle, 600, 2, kNoSetup);
+    ExpectInPlaceAndAccumulate<DenseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::MULTICHANNEL>>(handle, 2048, 3, kNoSetup);
+    // Tiled kernel: blocks of input are scattered before any of their frames is extracted
+    ExpectInPlaceAndAccumulate<DenseConvolutionEngine>(handle, 2048, 2, [](auto& engine) { engine.SetTiling({16, 32}); });
+}
+
+TEST(AccumulateTest, Sparse) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    ExpectInPlaceAndAccumulate<SparseConvolutionEngine>(handle, 2048, 2, kNoSetup);
+    ExpectInPlaceAndAccumulate<SparseConvolutionEngineT<WMode::ARBITRARY, CLayout::QUAD>>(handle, 4000, 4, kNoSetup);
+}
+
+TEST(AccumulateTest, Velvet) {
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    ExpectInPlaceAndAccumulate<VelvetConvolutionEngine>(handle, 8192, 1, kNoSetup);
+    ExpectInPlaceAndAccumulate<VelvetConvolutionEngineT<WMode::ARBITRARY, CLayout::MULTICHANNEL>>(handle, 5000, 5, kNoSetup);
+}
+
+TEST(AccumulateTest, ChannelGainsApplyBeforeMixGain) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    std::vector<ConvolutionUtils::ChannelGain> gains[3] = {std::vector<ConvolutionUtils::ChannelGain>(2),
+                                                           std::vector<ConvolutionUtils::ChannelGain>(2),
+                                                           std::vector<ConvolutionUtils::ChannelGain>(2)};
+    size_t next = 0;
+    ExpectInPlaceAndAccumulate<DenseConvolutionEngine>(handle, 1024, 2, [&](auto& engine) {
+        engine.SetChannelGainBuffer(gains[next++].data());
+        engine.SetChannelGain(1, 0.25f, 100);
+    });
+}
+
+TEST(AccumulateTest, IdleLeavesBusUntouched) {
+    // An idle engine adds nothing and does not even write the bus
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    std::vector<float> buffer(1024), in(256 * 2, 0.0f), bus(in.size(), 0.75f);
+    DenseConvolutionEngine engine;
+    engine.Init(handle, buffer.data(), buffer.size(), 2);
+    engine.ProcessAccumulate(in.data(), bus.data(), 256, 2.0f);
+    EXPECT_TRUE(engine.IsIdle());
+    for (float sample : bus) ASSERT_EQ(sample, 0.75f);
+}
@@ -0,0 +1,101 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../EngineAllocator.hpp"
+
+TEST(AllocatorTest, BufferSizeQueries) {
+    DenseIRHandle dense = {dense_ir, dense_ir_size};
+    SparseIRHandle sparse = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    VelvetIRHandle velvet = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    for (size_t num_ch : {1, 2, 3}) {
+        for (size_t block : {size_t(1), size_t(256), ConvolutionUtils::kDefaultMaxBlockFrames}) {
+            const auto size = [&](size_t length) { return ConvolutionUtils::next_power_of_two((length + block - 1) * num_ch); };
+            EXPECT_EQ(DenseConvolutionEngine::GetBufferSize(dense, num_ch, block), size(dense_ir_size));
+            EXPECT_EQ(SparseConvolutionEngine::GetBufferSize(sparse, num_ch, block), size(ir_length(sparse)));
+            EXPECT_EQ(VelvetConvolutionEngine::GetBufferSize(velvet, num_ch, block), size(ir_length(velvet)));
+            EXPECT_EQ(VelvetConvolutionEngine::GetBufferSize(velvet, num_ch, block, 5000), size(5000));
+        }
+        EXPECT_EQ(DenseConvolutionEngine::GetBufferSize(dense, num_ch),
+                  DenseConvolutionEngine::GetBufferSize(dense, num_ch, ConvolutionUtils::kDefaultMaxBlockFrames));
+    }
+    EXPECT_EQ(DenseConvolutionEngine::GetBufferSize({nullptr, 0}, 2, 1), 2u);
+
+    // An IR span just under a power of two still leaves room for whole blocks
+    std::vector<float> taps(1000, 0.5f);
+    const DenseIRHandle pow2 = {taps.data(), taps.size()};
+    EXPECT_GE(DenseConvolutionEngine::GetBufferSize(pow2, 1, 256), taps.size() + 255);
+    EXPECT_EQ(DenseConvolutionEngine::GetBufferSize(pow2, 1, 256), 2048u);
+}
+
+TEST(AllocatorTest, PlacementsAreZeroedAndAligned) {
+    const size_t num_floats = 3 * EngineAllocator::kHugePageBytes / sizeof(float) + 5;
+    for (HugePages huge_pages : {HugePages::NONE, HugePages::TRANSPARENT, HugePages::EXPLICIT}) {
+        BufferPlacement placement;
+        placement.huge_pages = huge_pages;
+        PlacedBuffer buffer = EngineAllocator::Allocate(num_floats, placement);
+        ASSERT_NE(buffer.data(), nullptr);
+        EXPECT_EQ(buffer.size(), num_floats);
+        for (size_t i = 0; i < num_floats; i += 1021) ASSERT_EQ(buffer.data()[i], 0.0f);
+        buffer.data()[num_floats - 1] = 1.0f;
+
+        // Explicit pages fall back to transparent ones when none are reserved
+        if (huge_pages == HugePages::NONE) {
+            EXPECT_EQ(buffer.GetHugePages(), HugePages::NONE);
+        } else {
+            EXPECT_NE(buffer.GetHugePages(), HugePages::NONE);
+        }
+        if (buffer.GetHugePages() != HugePages::NONE) {
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % EngineAllocator::kHugePageBytes, 0u);
+        }
+        EXPECT_LE(buffer.GetHugePageBytes(), 4 * EngineAllocator::kHugePageBytes);
+
+        // Bound to the calling thread's node when the kernel allows it
+        EXPECT_TRUE(buffer.GetNumaNode() == -1 || buffer.GetNumaNode() == EngineAllocator::CurrentNumaNode());
+    }
+}
+
+TEST(AllocatorTest, MoveTransfersOwnership) {
+    PlacedBuffer first = EngineAllocator::Allocate(1000);
+    float* data = first.data();
+    PlacedBuffer second = std::move(first);
+    EXPECT_EQ(first.data(), nullptr);
+    EXPECT_EQ(second.data(), data);
+    second = EngineAllocator::Allocate(10);
+    EXPECT_NE(second.data(), nullptr);
+    EXPECT_EQ(second.size(), 10u);
+}
+
+TEST(AllocatorTest, EngineRunsOnPlacedBuffer) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const size_t num_ch = 2;
+    std::vector<float> in(input_signal_size * num_ch), expected(in.size()), out(in.size());
+    for (size_t i = 0; i < input_signal_size; i++) in[2 * i] = in[2 * i + 1] = input_signal[i];
+
+    std::vector<float> reference_buffer(DenseConvolutionEngine::GetBufferSize(handle, num_ch));
+    DenseConvolutionEngine reference;
+    reference.Init(handle, reference_buffer.data(), reference_buffer.size(), num_ch);
+    reference.Process(in.data(), expected.data(), input_signal_size);
+
+    PlacedBuffer buffer = EngineAllocator::AllocateFor<DenseConvolutionEngine>(handle, num_ch);
+    ASSERT_NE(buffer.data(), nullptr);
+    DenseConvolutionEngine engine;
+    engine.Init(handle, buffer.data(), buffer.size(), num_ch);
+    engine.Process(in.data(), out.data(), input_signal_size);
+    EXPECT_EQ(out, expected);
+}
+
+TEST(AllocatorTest, HugePageBytesCountOnlyTheBuffer) {
+    // Untouched buffers next to a fully touched one: none of its huge pages are theirs
+    BufferPlacement placement;
+    placement.huge_pages = HugePages::TRANSPARENT;
+    const size_t num_floats = 2 * EngineAllocator::kHugePageBytes / sizeof(float);
+    PlacedBuffer before = EngineAllocator::Allocate(num_floats, placement);
+    PlacedBuffer touched = EngineAllocator::Allocate(num_floats, placement);
+    PlacedBuffer after = EngineAllocator::Allocate(num_floats, placement);
+    ASSERT_NE(touched.data(), nullptr);
+    for (size_t i = 0; i < num_floats; i++) touched.data()[i] = 1.0f;
+
+    EXPECT_LE(touched.GetHugePageBytes(), num_floats * sizeof(float));
+    EXPECT_EQ(before.GetHugePageBytes(), 0u);
+    EXPECT_EQ(after.GetHugePageBytes(), 0u);
+}
@@ -0,0 +1,125 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include <iterator>
+
+static_assert(std::size(dense_ir_2) == dense_ir_size, "per-channel IRs must match the base IR length");
+
+// One channel of an interleaved input, fed to the mono reference engine for that channel
+static std::vector<float> ChannelInput(const std::vector<float>& in, size_t ch, size_t num_channels) {
+    std::vector<float> channel_in(in.size() / num_channels);
+    for (size_t i = 0; i < channel_in.size(); i++) channel_in[i] = in[i * num_channels + ch];
+    return channel_in;
+}
+
+TEST(ChannelMorphTest, PerChannelIRsMatchMonoEngines) {
+    const size_t num_channels = 4;
+    const size_t frames = 2048;
+    DenseIRHandle ir_1 = {dense_ir, dense_ir_size};
+    DenseIRHandle ir_2 = {dense_ir_2, std::size(dense_ir_2)};
+
+    // QUAD engine: channels 1 and 3 get the second IR
+    DenseConvolutionEngine quad;
+    std::vector<float> quad_buffer(1024 * num_channels);
+    std::vector<float> channel_taps(dense_ir_size * num_channels);
+    quad.Init(ir_1, quad_buffer.data(), quad_buffer.size(), num_channels);
+    quad.EnableChannelIRs(channel_taps.data());
+    quad.SetChannelIR(1, ir_2);
+    quad.SetChannelIR(3, ir_2);
+
+    const auto in = MakeInterleavedInput(frames, num_channels);
+    std::vector<float> out(in.size());
+    for (size_t start = 0; start < frames; start += 64)
+        quad.Process(in.data() + start * num_channels, out.data() + start * num_channels, 64);
+
+    for (size_t ch = 0; ch < num_channels; ch++) {
+        DenseConvolutionEngine mono;
+        std::vector<float> mono_buffer(1024), mono_out(frames);
+        mono.Init((ch & 1) ? ir_2 : ir_1, mono_buffer.data(), mono_buffer.size(), 1);
+        const auto channel_in = ChannelInput(in, ch, num_channels);
+        mono.Process(channel_in.data(), mono_out.data(), frames);
+        for (size_t i = 0; i < frames; i++)
+            ASSERT_NEAR(out[i * num_channels + ch], mono_out[i], 1e-4) << "ch " << ch << " i " << i;
+    }
+}
+
+TEST(ChannelMorphTest, IndependentMorphsMatchMonoMorphs) {
+    const size_t num_channels = 3;
+    const size_t frames = 4096;
+    const size_t block = 32;
+    DenseIRHandle ir_1 = {dense_ir, dense_ir_size};
+    DenseIRHandle ir_2 = {dense_ir_2, std::size(dense_ir_2)};
+    const int morph_cycles[num_channels] = {10, 40, 0};   // Channel 2 does not morph
+
+    DenseConvolutionEngine multi;
+    std::vector<float> multi_buffer(2048 * num_channels);
+    std::vector<float> channel_taps(dense_ir_size * num_channels), channel_delta(channel_taps.size());
+    std::vector<DenseChannelMorph> channel_morphs(num_channels);
+    multi.Init(ir_1, multi_buffer.data(), multi_buffer.size(), num_channels);
+    multi.EnableChannelIRs(channel_taps.data(), channel_delta.data(), channel_morphs.data());
+
+    const auto in = MakeInterleavedInput(frames, num_channels);
+    std::vector<float> out(in.size());
+    for (size_t start = 0; start < frames; start += block) {
+        // Morphs start at different times
+        if (start == 5 * block) multi.MorphIRDenseChannel(0, ir_2, morph_cycles[0]);
+        if (start == 9 * block) multi.MorphIRDenseChannel(1, ir_2, morph_cycles[1]);
+        multi.Process(in.data() + start * num_channels, out.data() + start * num_channels, block);
+        multi.MorphIRDenseChannel_Update();
+    }
+
+    for (size_t ch = 0; ch < num_channels; ch++) {
+        DenseConvolutionEngine mono;
+        std::vector<float> mono_buffer(2048), mono_out(frames), current(dense_ir_size), delta(dense_ir_size);
+        mono.Init(ir_1, mono_buffer.data(), mono_buffer.size(), 1, current.data(), delta.data());
+        const auto channel_in = ChannelInput(in, ch, num_channels);
+        for (size_t start = 0; start < frames; start += block) {
+            if (ch == 0 && start == 5 * block) mono.MorphIRDense(ir_2, morph_cycles[0]);
+            if (ch == 1 && start == 9 * block) mono.MorphIRDense(ir_2, morph_cycles[1]);
+            mono.Process(channel_in.data() + start, mono_out.data() + start, block);
+            mono.MorphIRDense_Update();
+        }
+        for (size_t i = 0; i < frames; i++)
+            ASSERT_NEAR(out[i * num_channels + ch], mono_out[i], 1e-4) << "ch " << ch << " i " << i;
+    }
+}
+
+TEST(ChannelGainTest, RampIsSampleAccurate) {
+    // Single tap at 0: the output is the input times the gain
+    const float unit_tap = 1.0f;
+    DenseIRHandle handle = {&unit_tap, 1};
+    const size_t num_channels = 2;
+
+    DenseConvolutionEngine engine;
+    std::vector<float> circ_buffer(16);
+    std::vector<ConvolutionUtils::ChannelGain> gains(num_channels);
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_channels);
+    engine.SetChannelGainBuffer(gains.data());
+    engine.SetChannelGain(1, 0.0f, 100);    // Channel 0 stays at unity
+
+    std::vector<float> in(200 * num_channels, 1.0f), out(in.size());
+    for (size_t start = 0; start < 200; start += 7) {
+        const size_t frames = std::min<size_t>(7, 200 - start);
+        engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+    for (size_t i = 0; i < 200; i++) {
+        EXPECT_FLOAT_EQ(out[i * num_channels], 1.0f);
+        const float expected = i < 100 ? 1.0f - static_cast<float>(i) / 100.0f : 0.0f;
+        EXPECT_NEAR(out[i * num_channels + 1], expected, 1e-5) << "frame " << i;
+    }
+}
+
+TEST(ChannelGainTest, RampAdvancesWhileIdle) {
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    VelvetConvolutionEngine engine;
+    std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(ir_length(handle)));
+    ConvolutionUtils::ChannelGain gain;
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), 1);
+    engine.SetChannelGainBuffer(&gain);
+    engine.SetChannelGain(0, 0.5f, 1000);
+
+    std::vector<float> silence(600, 0.0f), out(600);
+    engine.Process(silence.data(), out.data(), 600);
+    EXPECT_TRUE(engine.IsIdle());
+    EXPECT_NEAR(gain.gain, 0.7f, 1e-5);
+}
@@ -1,4 +1,5 @@
 #include "test_common.hpp"
+#include "generated_test_data.hpp"
 
 // Test ID: EDGE-01 - Block Size Variation
 TEST_P(ConvolutionEngineTest, BlockSizeVariation) {
@@ -156,3 +157,34 @@ TEST_P(ConvolutionEngineTest, ZeroSizeProcessCall) {
 
     EXPECT_EQ(get_write_head(), initial_write_head);
 }
+
+// Test ID: EDGE-04 - Velvet blocks longer than the buffer headroom
+TEST(VelvetBlockTest, BlockLongerThanHeadroom) {
+    const size_t pos_taps[] = {0, 3, 17, 40};
+    const size_t neg_taps[] = {1, 29, 41};
+    VelvetIRHandle handle = {pos_taps, 4, neg_taps, 3};
+
+    for (size_t num_channels : {1, 2, 3, 4}) {
+        // Only 5 frames of headroom past the IR, so 64-sample calls are split internally
+        const size_t buffer_size = (42 + 4) * num_channels + (num_channels > 1 ? 1 : 0);
+        std::vector<float> in(input_signal_size * num_channels);
+        for (size_t i = 0; i < in.size(); i++) in[i] = input_signal[i % input_signal_size];
+
+        auto run = [&](size_t block_size) {
+            VelvetConvolutionEngine engine;
+            std::vector<float> circ_buffer(buffer_size);
+            engine.Init(handle, circ_buffer.data(), buffer_size, num_channels);
+            std::vector<float> out(in.size());
+            for (size_t start = 0; start < input_signal_size; start += block_size) {
+                const size_t frames = std::min(block_size, input_signal_size - start);
+                engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+            }
+            return out;
+        };
+
+        const auto single = run(1);
+        const auto blocked = run(64);
+        for (size_t i = 0; i < single.size(); i++)
+            ASSERT_NEAR(blocked[i], single[i], 1e-5) << "channels " << num_channels << " sample " << i;
+    }
+}
@@ -0,0 +1,43 @@
+#include "test_common.hpp"
+
+TEST(ExtractTest, BlockSplitsAtWrapPoint) {
+    for (bool non_temporal : {false, true}) {
+        // Unaligned head, so the streaming clear also takes its scalar edges
+        std::vector<float> buffer(37), out(30, 1.0f);
+        for (size_t i = 0; i < buffer.size(); i++) buffer[i] = static_cast<float>(i + 1);
+        ConvolutionUtils::extract_block(buffer.data(), buffer.size(), 13, out.data(), 30, non_temporal);
+        for (size_t i = 0; i < 30; i++) EXPECT_EQ(out[i], static_cast<float>((13 + i) % 37 + 1)) << "i " << i;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            const bool extracted = i >= 13 || i < 6;
+            EXPECT_EQ(buffer[i], extracted ? 0.0f : static_cast<float>(i + 1)) << "cell " << i;
+        }
+    }
+}
+
+TEST(ExtractTest, BlockAccumulates) {
+    std::vector<float> buffer = {1.0f, 2.0f, 3.0f, 4.0f}, out = {10.0f, 10.0f, 10.0f};
+    ConvolutionUtils::extract_block<true>(buffer.data(), buffer.size(), 3, out.data(), 3, false, 0.5f);
+    EXPECT_EQ(out, (std::vector<float>{12.0f, 10.5f, 11.0f}));
+    EXPECT_EQ(buffer, (std::vector<float>{0.0f, 0.0f, 3.0f, 0.0f}));
+}
+
+TEST(ExtractTest, FramesMatchPerFrameExtraction) {
+    // Straddling frames in an arbitrary-sized buffer, with and without channel gains
+    const size_t num_ch = 3, frames = 9, buffer_size = 31;
+    std::vector<ConvolutionUtils::ChannelGain> gains(num_ch);
+    for (auto* channel_gains : {static_cast<ConvolutionUtils::ChannelGain*>(nullptr), gains.data()}) {
+        std::vector<float> bulk(buffer_size), single(buffer_size), bulk_out(frames * num_ch), single_out(frames * num_ch);
+        for (size_t i = 0; i < buffer_size; i++) bulk[i] = single[i] = 0.5f * i;
+        size_t head = 20;
+        for (size_t smp = 0; smp < frames; smp++) {
+            ConvolutionUtils::extract_frame<ConvolutionUtils::WrappingMode::ARBITRARY, ConvolutionUtils::ChannelLayout::MULTICHANNEL>(
+                single.data(), buffer_size, head, single_out.data() + smp * num_ch, num_ch, channel_gains);
+            head = (head + num_ch) % buffer_size;
+        }
+        const size_t bulk_head = ConvolutionUtils::extract_frames<ConvolutionUtils::WrappingMode::ARBITRARY, ConvolutionUtils::ChannelLayout::MULTICHANNEL>(
+            bulk.data(), buffer_size, 20, bulk_out.data(), frames, num_ch, channel_gains);
+        EXPECT_EQ(bulk_head, head);
+        EXPECT_EQ(bulk_out, single_out);
+        EXPECT_EQ(bulk, single);
+    }
+}
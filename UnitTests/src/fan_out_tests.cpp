@@ -0,0 +1,58 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include <iterator>
+#include "../../FanOutConvolutionEngine.hpp"
+
+TEST(FanOutTest, MixedIRsMatchSingleEngines) {
+    DenseIRHandle dense = {dense_ir, dense_ir_size};
+    DenseIRHandle dense_2 = {dense_ir_2, std::size(dense_ir_2)};
+    SparseIRHandle sparse = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    VelvetIRHandle velvet = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    const IRHandleRef handles[] = {dense, sparse, velvet, dense_2};
+    const size_t max_length = std::max({ir_length(dense), ir_length(sparse), ir_length(velvet)});
+
+    for (size_t num_channels : {1, 2, 3}) {
+        const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+
+        std::vector<std::vector<float>> expected = {
+            RenderReference<DenseConvolutionEngine>(dense, in, num_channels),
+            RenderReference<SparseConvolutionEngine>(sparse, in, num_channels),
+            RenderReference<VelvetConvolutionEngine>(velvet, in, num_channels),
+            RenderReference<DenseConvolutionEngine>(dense_2, in, num_channels)};
+
+        // Exact fit (one frame per pass) and a roomy history, with blocks larger than both
+        for (size_t history_frames : {max_length, max_length + 100}) {
+            std::vector<float> history(history_frames * num_channels);
+            FanOutConvolutionEngine engine;
+            engine.Init(handles, 4, history.data(), history.size(), num_channels);
+
+            std::vector<std::vector<float>> outs(4, std::vector<float>(in.size()));
+            for (size_t start = 0; start < input_signal_size; start += 333) {
+                const size_t frames = std::min<size_t>(333, input_signal_size - start);
+                float* const block_outs[] = {outs[0].data() + start * num_channels, outs[1].data() + start * num_channels,
+                                             outs[2].data() + start * num_channels, outs[3].data() + start * num_channels};
+                engine.Process(in.data() + start * num_channels, block_outs, frames);
+            }
+
+            for (size_t ir = 0; ir < 4; ir++)
+                for (size_t i = 0; i < in.size(); i++)
+                    ASSERT_NEAR(outs[ir][i], expected[ir][i], 1e-4)
+                        << "ir " << ir << " ch " << num_channels << " history " << history_frames << " i " << i;
+        }
+    }
+}
+
+TEST(FanOutTest, RejectsShortHistory) {
+    DenseIRHandle dense = {dense_ir, dense_ir_size};
+    const IRHandleRef handles[] = {dense};
+    std::vector<float> history((dense_ir_size - 1) * 2), in(64 * 2, 1.0f), out(in.size(), 1.0f);
+    float* outs[] = {out.data()};
+    FanOutConvolutionEngine engine;
+    EXPECT_FALSE(engine.Init(handles, 1, history.data(), history.size(), 2));
+    engine.Process(in.data(), outs, 64);
+    for (float sample : out) ASSERT_EQ(sample, 0.0f);
+
+    history.resize(dense_ir_size * 2);
+    EXPECT_TRUE(engine.Init(handles, 1, history.data(), history.size(), 2));
+}
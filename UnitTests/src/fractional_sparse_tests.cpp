@@ -0,0 +1,140 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../FractionalSparseConvolutionEngine.hpp"
+
+#include <cmath>
+
+static std::vector<float> RunSparse(const std::vector<size_t>& positions, const std::vector<float>& values,
+                                    const std::vector<float>& in, size_t num_channels) {
+    return RenderReference<SparseConvolutionEngine>(SparseIRHandle{positions.data(), values.data(), positions.size()},
+                                                    in, num_channels);
+}
+
+TEST(FractionalSparseTest, IntegerPositionsMatchSparseEngine) {
+    std::vector<size_t> positions(sparse_ir_positions, sparse_ir_positions + sparse_ir_positions_size);
+    std::vector<float> values(sparse_ir_values, sparse_ir_values + sparse_ir_values_size);
+    for (auto& position : positions) position += 1;  // Cubic needs positions >= 1
+    std::vector<float> fractional(positions.begin(), positions.end());
+
+    for (auto interpolation : {FractionalInterpolation::LINEAR, FractionalInterpolation::CUBIC}) {
+        for (size_t num_channels : {1, 2, 3, 4}) {
+            const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+            const auto expected = RunSparse(positions, values, in, num_channels);
+
+            // Power of two and arbitrary buffer sizes
+            for (size_t buffer_frames : {512, 300}) {
+                std::vector<float> circ_buffer(buffer_frames * num_channels), out(in.size());
+                std::vector<float> taps(FractionalSparseConvolutionEngine::GetTapBufferSize(values.size()));
+                FractionalSparseConvolutionEngine engine;
+                engine.Init({fractional.data(), values.data(), values.size()}, circ_buffer.data(), circ_buffer.size(),
+                            num_channels, taps.data(), interpolation);
+                for (size_t start = 0; start < input_signal_size; start += 64) {
+                    const size_t block = std::min<size_t>(64, input_signal_size - start);
+                    engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, block);
+                }
+                for (size_t i = 0; i < out.size(); i++)
+                    ASSERT_NEAR(out[i], expected[i], 1e-4) << "ch " << num_channels << " buffer " << buffer_frames << " i " << i;
+            }
+        }
+    }
+}
+
+TEST(FractionalSparseTest, HalfFramePositionsInterpolate) {
+    // A tap at 10.5: linear is the mean of taps at 10 and 11, cubic is (-1, 9, 9, -1) / 16 over 9..12
+    const float position = 10.5f, value = 0.75f;
+    const auto in = MakeInterleavedInput(input_signal_size, 1);
+    const auto at = [&](size_t p, float v) { return RunSparse({p}, {v}, in, 1); };
+    const auto t9 = at(9, value), t10 = at(10, value), t11 = at(11, value), t12 = at(12, value);
+
+    for (auto interpolation : {FractionalInterpolation::LINEAR, FractionalInterpolation::CUBIC}) {
+        std::vector<float> circ_buffer(256), taps(3), out(in.size());
+        FractionalSparseConvolutionEngine engine;
+        engine.Init({&position, &value, 1}, circ_buffer.data(), circ_buffer.size(), 1, taps.data(), interpolation);
+        engine.Process(in.data(), out.data(), input_signal_size);
+        for (size_t i = 0; i < out.size(); i++) {
+            const float expected = (interpolation == FractionalInterpolation::LINEAR)
+                                 ? 0.5f * (t10[i] + t11[i])
+                                 : (-t9[i] + 9.0f * t10[i] + 9.0f * t11[i] - t12[i]) / 16.0f;
+            ASSERT_NEAR(out[i], expected, 1e-5) << "i " << i;
+        }
+    }
+}
+
+TEST(FractionalSparseTest, PositionsRampWithoutJumps) {
+    // A constant input through one tap gliding from 20 to 25 frames
+    const float start = 20.0f, end = 25.0f, value = 0.5f;
+    std::vector<float> circ_buffer(64), taps(3);
+    FractionalSparseConvolutionEngine engine;
+    engine.Init({&start, &value, 1}, circ_buffer.data(), circ_buffer.size(), 1, taps.data());
+
+    std::vector<float> in(320, 1.0f), out(320);
+    engine.Process(in.data(), out.data(), 64);
+    engine.SetTapPositions(&end, 100);
+    EXPECT_TRUE(engine.IsRamping());
+    engine.Process(in.data() + 64, out.data() + 64, 50);
+    EXPECT_NEAR(engine.GetTapPosition(0), 22.5f, 1e-3);
+    engine.Process(in.data() + 114, out.data() + 114, 206);
+    EXPECT_FALSE(engine.IsRamping());
+    EXPECT_EQ(engine.GetTapPosition(0), end);
+
+    // Moving away at 0.05 frames per frame spreads the writes: the output dips to
+    // value / 1.05 on average (with a ripple of the interpolation) and recovers once
+    // the ramp ends, with no step anywhere
+    for (size_t i = 21; i < out.size(); i++) ASSERT_NEAR(out[i], out[i - 1], 0.03f) << "i " << i;
+    float mean = 0.0f;
+    for (size_t i = 120; i < 160; i++) mean += out[i] / 40.0f;
+    EXPECT_NEAR(mean, value / 1.05f, 2e-3);
+    EXPECT_NEAR(out[319], value, 1e-5);
+}
+
+TEST(FractionalSparseTest, RampingBlocksMatchFrameByFrame) {
+    // Taps gliding both ways, some across several frames within a block, against the same
+    // ramps processed one frame per call
+    const std::vector<float> from = {3.2f, 7.9f, 15.0f, 40.5f, 41.25f};
+    const std::vector<float> to   = {9.7f, 4.1f, 15.0f, 12.0f, 41.75f};
+    const std::vector<float> values = {0.8f, -0.6f, 0.5f, 0.3f, -0.9f};
+
+    for (auto interpolation : {FractionalInterpolation::LINEAR, FractionalInterpolation::CUBIC}) {
+        for (size_t num_channels : {1, 2, 3}) {
+            const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+            std::vector<float> outs[2];
+            for (size_t block : {1, 200}) {
+                std::vector<float> circ_buffer(100 * num_channels), taps(3 * values.size());
+                std::vector<float>& out = outs[block > 1];
+                out.resize(in.size());
+                FractionalSparseConvolutionEngine engine;
+                engine.Init({from.data(), values.data(), values.size()}, circ_buffer.data(), circ_buffer.size(),
+                            num_channels, taps.data(), interpolation);
+                engine.SetTapPositions(to.data(), 150);
+                for (size_t start = 0; start < input_signal_size; start += block) {
+                    const size_t frames = std::min(block, input_signal_size - start);
+                    engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+                }
+                EXPECT_FALSE(engine.IsRamping());
+            }
+            // Positions advanced one frame at a time pick up some rounding along the ramp
+            for (size_t i = 0; i < in.size(); i++)
+                ASSERT_NEAR(outs[1][i], outs[0][i], 5e-4) << "ch " << num_channels << " i " << i;
+        }
+    }
+}
+
+TEST(FractionalSparseTest, GoesIdleAfterTheLongestReach) {
+    const float positions[] = {100.25f, 3.5f}, values[] = {1.0f, -0.5f}, shorter[] = {10.0f, 3.5f};
+    std::vector<float> circ_buffer(256), taps(6), in(64, 0.0f), out(64);
+    FractionalSparseConvolutionEngine engine;
+    engine.Init({positions, values, 2}, circ_buffer.data(), circ_buffer.size(), 1, taps.data());
+    in[0] = 1.0f;
+    engine.Process(in.data(), out.data(), 64);
+
+    // The tail written from 100.25 is still pending after the taps move in
+    engine.SetTapPositions(shorter, 0);
+    in[0] = 0.0f;
+    engine.Process(in.data(), out.data(), 30);
+    EXPECT_FALSE(engine.IsIdle());
+    engine.Process(in.data(), out.data(), 10);
+    EXPECT_NEAR(out[100 - 94], 0.75f, 1e-6);
+    EXPECT_NEAR(out[101 - 94], 0.25f, 1e-6);
+    engine.Process(in.data(), out.data(), 64);
+    EXPECT_TRUE(engine.IsIdle());
+}
@@ -8,7 +8,7 @@ const size_t input_signal_size = 4096;
 const float dense_ir[] = {0.5954909, -0.5898948, -0.13216935, 0.07227897, -1.5002218, -0.778837, 1.3510729, 0.8861912, -0.06263958, 0.24312346, -0.2942425, 1.3565834, -0.20035258, 0.23184209, 1.1460302, -0.77737147, 1.5587891, -1.5304614, 1.6296421, -0.3726756, -0.24269874, -1.8900101, -0.4547947, -1.0398065, -0.60764635, -0.13731097, 0.9577916, 0.20760335, 0.30767664, -1.0955194, -0.8807541, 1.798725, -0.73520106, 1.6562083, -0.2430612, 0.0022879362, 1.0703652, 1.2718924, -0.11081256, -0.38824305, -0.05592045, 0.33795753, 0.89130366, 0.004229859, 0.6188863, 1.6383598, 0.3813096, 0.31165287, -1.5189108, -2.6307302, 0.38837573, -0.09482423, -0.51478267, 0.2435302, -0.06040373, 1.1277802, 0.08611087, -0.74692327, 0.99016625, -0.21713108, 0.5265367, -0.4774107, -0.6498269, 0.08416823, 0.012828643, 0.47982705, -0.26864576, -1.8363597, -0.4327739, 0.7938185, -0.29737607, -0.2463834, 0.9863765, -0.71197325, -1.5428032, -0.16063112, -0.48417395, -0.9662463, -0.17537846, 0.49150565, -0.0092885615, 0.3069811, 1.8134077, -0.34287885, 0.27834862, -0.5092134, -0.8463597, -0.58490765, -0.47875857, 0.3594758, 2.3490758, -0.7160434, -0.4166253, -0.06312301, 0.39579886, 0.26355082, 1.2840958, -2.426392, -2.38693, -0.49587816, 1.0973002, -1.5656481, -3.0076323, 0.5711794, 0.24365722, -1.0902084, -0.9855396, -0.9697437, 0.110535316, -0.6263153, 0.4940639, -2.8546267, -0.8568519, -1.1260539, -0.25634068, -0.53804773, 0.79784375, -1.8593367, 0.045491476, 0.55833644, 1.8566475, -0.481766, 0.3244586, -1.8038628, -2.391956, 0.84477437, -0.005560294, 1.1785127, -1.3734028, 0.5199021, 1.8688178, 0.4197056, 0.2765815, 0.008556081, -1.5708815, 1.3555729, -0.61085767, 0.5044833, -1.5630343, -1.1794597, 1.4350874, -0.3473023, 1.4532754, -0.07823066, -1.8418977, 0.8920676, -0.5898923, 0.6986888, 0.025210867, -1.5431182, 0.16429476, 2.1962233, 0.49298647, -0.057517752, 1.0753434, 0.21066846, 0.20953423, -1.0916252, 0.23384802, 1.0354434, -0.83606213, 1.4244958, -0.09170602, -0.8877695, 0.9976321, -0.28679425, 0.75951487, -0.29175863, -0.059826143, 0.4935602, 0.29089707, -1.9955318, -1.1212437, 0.92941, -0.13213658, -0.5237313, -1.358574, -1.0797364, -2.0217986, -0.10128072, -0.5984376, -0.9665879, -0.06812342, 0.36397064, 2.0931978, -1.5118834, 1.159381, 0.97310156, -0.7790927, 0.20323595, -0.45763326, 0.18568859, 1.509131, 0.60560626, 0.5086084, -0.43030933, -1.4840567, -0.20846821, 1.2066082, -1.5271678, -1.0550894, 0.12626773, -0.9846548, -0.79252344, -0.4235986, -1.3656174, -0.97412187, 0.7034279, -1.3073698, -1.5978721, -0.63002497, 0.7319555, -0.19692181, -0.46458107, 0.044358797, -1.7457074, 0.49470565, 0.38343504, -0.40930846, 1.0059245, -1.1274961, 1.127909, 0.15449366, -0.3365526, -0.019873636, -0.107264765, 1.2202829, -1.0766791, -0.76251924, 1.0363029, -0.5955349, 0.9005331, 1.699436, -0.40179503, 0.68136233, -1.1536922, 0.7547333, 0.19942398, 0.4730383, -0.64557207, -1.6610835, 0.5032521, -2.0634031, -0.3173505, 0.94118184, 0.19189773, 1.9483427, 1.0251092, -0.6538984, 0.02731338, -0.047370702, -1.5821768, -0.94039893, -0.5607609, -2.0362206, 0.04749347};
 const size_t dense_ir_size = 256;
 
-const float dense_ir_2[] = {1.2345678, -0.9876543, 0.3456789, -0.6543210, 0.8765432, -0.1234567, 0.5678901, -0.4321098, 0.7654321, -0.2109876, 0.4567890, -0.7890123, 0.1357924, -0.8642097, 0.2468135, -0.3579246, 0.6913578, -0.5024681, 0.8136790, -0.4792357, 0.1605284, -0.9283047, 0.3716058, -0.2839465, 0.6172840, -0.7495162, 0.0628394, -0.8351729, 0.4950617, -0.3074185, 0.7638251, -0.1406392, 0.5274038, -0.8947163, 0.2185296, -0.6730481, 0.9462974, -0.0851739, 0.3495162, -0.7018356, 0.1638297, -0.5273961, 0.8796124, -0.2450738, 0.6084295, -0.9317642, 0.3751084, -0.1295736, 0.7829463, -0.4062951, 0.0537284, -0.8195740, 0.2738461, -0.6451928, 0.9074385, -0.3207649, 0.5841062, -0.7563419, 0.1285047, -0.4718392, 0.8352916, -0.2974653, 0.6507281, -0.0139485, 0.4672840, -0.7206139, 0.1950372, -0.8473651, 0.2617048, -0.5340926, 0.7864152, -0.3186074, 0.9508213, -0.0742859, 0.4175396, -0.6830527, 0.1407295, -0.5639471, 0.8261749, -0.2083756, 0.6397540, -0.9152630, 0.3574819, -0.1028475, 0.7603924, -0.4251738, 0.0816297, -0.8439562, 0.2958174, -0.6081429, 0.9273586, -0.3496051, 0.5729463, -0.7842197, 0.1365074, -0.4987251, 0.8120486, -0.2643759, 0.6176025, -0.9508312, 0.3841697, -0.0274859, 0.7596320, -0.4308541, 0.0971628, -0.8235074, 0.2769435, -0.6402816, 0.9136597, -0.3571092, 0.5834726, -0.7408519, 0.1697302, -0.4923861, 0.8257034, -0.2480597, 0.6014268, -0.9347152, 0.3678495, -0.0512839, 0.7951623, -0.4186074, 0.1029536, -0.8473920, 0.2607184, -0.6239851, 0.8976425, -0.3142793, 0.5674108, -0.7830526, 0.1408391, -0.4965172, 0.8193654, -0.2571849, 0.6327045, -0.9085174, 0.3451628, -0.0738952, 0.7604139, -0.4297615, 0.0853206, -0.8267391, 0.2934852, -0.6451079, 0.9173608, -0.3285794, 0.5729163, -0.7946851, 0.1062074, -0.4830527, 0.8354096, -0.2516739, 0.6071428, -0.9396105, 0.3752841, -0.0194856, 0.7629473, -0.4186275, 0.1043859, -0.8520971, 0.2847305, -0.6153972, 0.8906154, -0.3429617, 0.5861720, -0.7304859, 0.1627384, -0.4932851, 0.8159476, -0.2473691, 0.6198354, -0.9271058, 0.3584729, -0.0851693, 0.7437520, -0.4206931, 0.1075284, -0.8394017, 0.2739862, -0.6285074, 0.9018351, -0.3571694, 0.5734921, -0.7192865, 0.1456072, -0.4839271, 0.8207543, -0.2614379, 0.6152940, -0.9306185, 0.3485729, -0.0672831, 0.7594102, -0.4318574, 0.0937265, -0.8163729, 0.2756941, -0.6429073, 0.9081457, -0.3204568, 0.5847392, -0.7513620, 0.1285374, -0.4962817, 0.8051934, -0.2738516, 0.6294017, -0.9420386, 0.3639271, -0.0483059, 0.7382694, -0.4165072, 0.1058239, -0.8494637, 0.2671580, -0.6037924, 0.8735861, -0.3251074, 0.5963182, -0.7428596, 0.1739264, -0.4851709, 0.8026431, -0.2594073, 0.6318529, -0.9164082, 0.3472695, -0.0726143, 0.7584209, -0.4371658, 0.0892375, -0.8230641, 0.2963517, -0.6457209};
+const float dense_ir_2[] = {1.2345678, -0.9876543, 0.3456789, -0.6543210, 0.8765432, -0.1234567, 0.5678901, -0.4321098, 0.7654321, -0.2109876, 0.4567890, -0.7890123, 0.1357924, -0.8642097, 0.2468135, -0.3579246, 0.6913578, -0.5024681, 0.8136790, -0.4792357, 0.1605284, -0.9283047, 0.3716058, -0.2839465, 0.6172840, -0.7495162, 0.0628394, -0.8351729, 0.4950617, -0.3074185, 0.7638251, -0.1406392, 0.5274038, -0.8947163, 0.2185296, -0.6730481, 0.9462974, -0.0851739, 0.3495162, -0.7018356, 0.1638297, -0.5273961, 0.8796124, -0.2450738, 0.6084295, -0.9317642, 0.3751084, -0.1295736, 0.7829463, -0.4062951, 0.0537284, -0.8195740, 0.2738461, -0.6451928, 0.9074385, -0.3207649, 0.5841062, -0.7563419, 0.1285047, -0.4718392, 0.8352916, -0.2974653, 0.6507281, -0.0139485, 0.4672840, -0.7206139, 0.1950372, -0.8473651, 0.2617048, -0.5340926, 0.7864152, -0.3186074, 0.9508213, -0.0742859, 0.4175396, -0.6830527, 0.1407295, -0.5639471, 0.8261749, -0.2083756, 0.6397540, -0.9152630, 0.3574819, -0.1028475, 0.7603924, -0.4251738, 0.0816297, -0.8439562, 0.2958174, -0.6081429, 0.9273586, -0.3496051, 0.5729463, -0.7842197, 0.1365074, -0.4987251, 0.8120486, -0.2643759, 0.6176025, -0.9508312, 0.3841697, -0.0274859, 0.7596320, -0.4308541, 0.0971628, -0.8235074, 0.2769435, -0.6402816, 0.9136597, -0.3571092, 0.5834726, -0.7408519, 0.1697302, -0.4923861, 0.8257034, -0.2480597, 0.6014268, -0.9347152, 0.3678495, -0.0512839, 0.7951623, -0.4186074, 0.1029536, -0.8473920, 0.2607184, -0.6239851, 0.8976425, -0.3142793, 0.5674108, -0.7830526, 0.1408391, -0.4965172, 0.8193654, -0.2571849, 0.6327045, -0.9085174, 0.3451628, -0.0738952, 0.7604139, -0.4297615, 0.0853206, -0.8267391, 0.2934852, -0.6451079, 0.9173608, -0.3285794, 0.5729163, -0.7946851, 0.1062074, -0.4830527, 0.8354096, -0.2516739, 0.6071428, -0.9396105, 0.3752841, -0.0194856, 0.7629473, -0.4186275, 0.1043859, -0.8520971, 0.2847305, -0.6153972, 0.8906154, -0.3429617, 0.5861720, -0.7304859, 0.1627384, -0.4932851, 0.8159476, -0.2473691, 0.6198354, -0.9271058, 0.3584729, -0.0851693, 0.7437520, -0.4206931, 0.1075284, -0.8394017, 0.2739862, -0.6285074, 0.9018351, -0.3571694, 0.5734921, -0.7192865, 0.1456072, -0.4839271, 0.8207543, -0.2614379, 0.6152940, -0.9306185, 0.3485729, -0.0672831, 0.7594102, -0.4318574, 0.0937265, -0.8163729, 0.2756941, -0.6429073, 0.9081457, -0.3204568, 0.5847392, -0.7513620, 0.1285374, -0.4962817, 0.8051934, -0.2738516, 0.6294017, -0.9420386, 0.3639271, -0.0483059, 0.7382694, -0.4165072, 0.1058239, -0.8494637, 0.2671580, -0.6037924, 0.8735861, -0.3251074, 0.5963182, -0.7428596, 0.1739264, -0.4851709, 0.8026431, -0.2594073, 0.6318529, -0.9164082, 0.3472695, -0.0726143, 0.7584209, -0.4371658, 0.0892375, -0.8230641, 0.2963517, -0.6457209, 0.9104308, -0.9030447, 0.1008962, -0.1263848, 0.8019490, -0.7123730, 0.6527574, -0.3273228, 0.5953497, -0.5961216, 0.5730836, -0.1925446, 0.4376027, -0.4041786, 0.7007109, -0.9453376, 0.9044559, -0.5397593, 0.4503688, -0.2914167, 0.0823319, -0.0747004};
 const size_t dense_ir_2_size = 256;
 
 const size_t sparse_ir_positions[] = {177, 207, 152, 139, 198, 38, 144, 44, 138, 69, 124, 150, 90, 237, 69, 165, 129, 255, 213, 83, 88, 78, 251, 112, 92, 71, 164, 48, 51, 32, 21, 113, 238, 132, 230, 17, 165, 117, 116, 36, 221, 242, 222, 63, 137, 78, 169, 122, 175, 43, 81, 86, 224, 15, 53, 101, 162, 97, 155, 1, 93, 140, 168, 207, 58, 68, 118, 91, 180, 230, 44, 147, 23, 188, 90, 93, 57, 236, 154, 153, 127, 6, 169, 46, 52, 186, 37, 196, 214, 219, 225, 52, 142, 223, 153, 47, 94, 146, 136, 63};
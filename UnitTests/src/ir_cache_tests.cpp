@@ -0,0 +1,162 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../IRCache.hpp"
+
+#include <algorithm>
+#include <thread>
+
+TEST(IRCacheTest, SameContentsShareOneCopy) {
+    IRCache cache;
+    std::vector<float> copy(dense_ir, dense_ir + dense_ir_size);
+    auto a = cache.Get(DenseIRHandle{dense_ir, dense_ir_size});
+    auto b = cache.Get(DenseIRHandle{copy.data(), copy.size()});
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a->handle.taps, copy.data());
+    EXPECT_EQ(a->length, ir_length(DenseIRHandle{dense_ir, dense_ir_size}));
+
+    copy[10] += 1.0f;
+    auto c = cache.Get(DenseIRHandle{copy.data(), copy.size()});
+    EXPECT_NE(a, c);
+    EXPECT_EQ(cache.GetNumEntries(), 2u);
+    EXPECT_EQ(cache.GetHits(), 1u);
+    EXPECT_EQ(cache.GetMisses(), 2u);
+}
+
+TEST(IRCacheTest, PreparedSparseIRMatchesSource) {
+    // Reversed, with one tap split in two at the same position
+    std::vector<size_t> positions(sparse_ir_positions, sparse_ir_positions + sparse_ir_positions_size);
+    std::vector<float> values(sparse_ir_values, sparse_ir_values + sparse_ir_values_size);
+    std::reverse(positions.begin(), positions.end());
+    std::reverse(values.begin(), values.end());
+    values[0] *= 0.5f;
+    positions.push_back(positions[0]);
+    values.push_back(values[0]);
+    const SparseIRHandle source = {positions.data(), values.data(), positions.size()};
+
+    IRCache cache;
+    auto prepared = cache.Get(source);
+    std::vector<size_t> unique(sparse_ir_positions, sparse_ir_positions + sparse_ir_positions_size);
+    std::sort(unique.begin(), unique.end());
+    EXPECT_EQ(prepared->handle.num_taps, size_t(std::unique(unique.begin(), unique.end()) - unique.begin()));
+    EXPECT_TRUE(std::is_sorted(prepared->positions.begin(), prepared->positions.end()));
+
+    const auto in = MakeInterleavedInput(input_signal_size, 1);
+    auto expected = RenderReference<SparseConvolutionEngine>(source, in, 1);
+    auto actual = RenderReference<SparseConvolutionEngine>(prepared->handle, in, 1);
+    for (size_t i = 0; i < expected.size(); i++) ASSERT_NEAR(actual[i], expected[i], 1e-5) << "sample " << i;
+}
+
+TEST(IRCacheTest, DerivedTablesAreSharedPerChannelCount) {
+    IRCache cache;
+    const auto in = MakeInterleavedInput(input_signal_size, 2);
+
+    // Sparse runs: built once per channel count, counted in the cache size
+    auto sparse = cache.Get(SparseIRHandle{sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size});
+    const size_t taps_only = cache.GetBytes();
+    const SparseRunTable runs = cache.GetRuns(sparse, 2);
+    EXPECT_EQ(cache.GetRuns(sparse, 2).runs, runs.runs);
+    EXPECT_NE(cache.GetRuns(sparse, 1).runs, runs.runs);
+    EXPECT_EQ(cache.GetBytes(), sparse->Bytes());
+    EXPECT_GT(cache.GetBytes(), taps_only);
+
+    std::vector<SparseRun> own_runs(sparse->handle.num_taps);
+    const size_t buffer_size = SparseConvolutionEngine::GetBufferSize(sparse->handle, 2);
+    std::vector<float> own_buffer(buffer_size), shared_buffer(buffer_size), expected(in.size()), out(in.size());
+    SparseConvolutionEngine own, shared;
+    own.Init(sparse->handle, own_buffer.data(), own_buffer.size(), 2, own_runs.data());
+    shared.Init(sparse->handle, shared_buffer.data(), shared_buffer.size(), 2, runs);
+    own.Process(in.data(), expected.data(), input_signal_size);
+    shared.Process(in.data(), out.data(), input_signal_size);
+    EXPECT_EQ(out, expected);
+
+    // Velvet offsets, likewise
+    auto velvet = cache.Get(VelvetIRHandle{velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                                           velvet_ir_neg_positions, velvet_ir_neg_positions_size});
+    const VelvetOffsetTable offsets = cache.GetOffsets(velvet, 2);
+    EXPECT_EQ(cache.GetOffsets(velvet, 2).pos_offsets, offsets.pos_offsets);
+    EXPECT_EQ(offsets.neg_offsets[0], velvet->handle.neg_taps[0] * 2);
+
+    std::vector<size_t> pos_offsets(velvet->handle.num_pos_taps), neg_offsets(velvet->handle.num_neg_taps);
+    own_buffer.resize(VelvetConvolutionEngine::GetBufferSize(velvet->handle, 2));
+    shared_buffer.resize(own_buffer.size());
+    VelvetConvolutionEngine own_velvet, shared_velvet;
+    own_velvet.Init(velvet->handle, own_buffer.data(), own_buffer.size(), 2, nullptr, nullptr, nullptr, nullptr,
+                    nullptr, nullptr, 0, 0, pos_offsets.data(), neg_offsets.data());
+    shared_velvet.Init(velvet->handle, shared_buffer.data(), shared_buffer.size(), 2, offsets);
+    own_velvet.Process(in.data(), expected.data(), input_signal_size);
+    shared_velvet.Process(in.data(), out.data(), input_signal_size);
+    EXPECT_EQ(out, expected);
+    EXPECT_EQ(cache.GetBytes(), sparse->Bytes() + velvet->Bytes());
+}
+
+TEST(IRCacheTest, EvictionKeepsViewsInUse) {
+    const VelvetIRHandle velvet = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                                   velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    IRCache cache;
+    auto held = cache.Get(velvet);
+    cache.Get(SparseIRHandle{sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size});
+    EXPECT_EQ(cache.GetNumEntries(), 2u);
+
+    // Only the unreferenced entry can go
+    cache.SetBudget(0);
+    EXPECT_EQ(cache.GetNumEntries(), 1u);
+    EXPECT_EQ(cache.GetBytes(), held->Bytes());
+    EXPECT_EQ(cache.Get(velvet), held);
+
+    // Evicted while in use: the view outlives the entry
+    const size_t first_tap = held->handle.pos_taps[0];
+    auto view = held;
+    held.reset();
+    view.reset();
+    cache.Trim();
+    EXPECT_EQ(cache.GetNumEntries(), 0u);
+    EXPECT_EQ(cache.GetBytes(), 0u);
+    EXPECT_EQ(cache.Get(velvet)->handle.pos_taps[0], first_tap);
+}
+
+TEST(IRCacheTest, ConcurrentGetsShareOneCopy) {
+    IRCache cache;
+    std::vector<std::shared_ptr<const PreparedDenseIR>> results(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); t++) {
+        threads.emplace_back([&, t] {
+            std::vector<float> copy(dense_ir, dense_ir + dense_ir_size);
+            for (int i = 0; i < 100; i++) results[t] = cache.Get(DenseIRHandle{copy.data(), copy.size()});
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& result : results) EXPECT_EQ(result, results[0]);
+    EXPECT_EQ(cache.GetNumEntries(), 1u);
+}
+
+// Files every IR under the same key, as a hash collision would
+class CollidingIRCache : public IRCache {
+public:
+    template <typename Prepared, typename HandleType>
+    std::shared_ptr<const Prepared> GetColliding(const HandleType& handle) { return get<Prepared>(handle, 0); }
+};
+
+TEST(IRCacheTest, CollisionsReturnTheRightIR) {
+    CollidingIRCache cache;
+    std::vector<float> other(dense_ir, dense_ir + dense_ir_size);
+    other[0] += 1.0f;
+    const SparseIRHandle sparse = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    auto a = cache.GetColliding<PreparedDenseIR>(DenseIRHandle{dense_ir, dense_ir_size});
+    auto b = cache.GetColliding<PreparedDenseIR>(DenseIRHandle{other.data(), other.size()});
+    auto c = cache.GetColliding<PreparedSparseIR>(sparse);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(b->taps, other);
+    EXPECT_TRUE(c->Matches(sparse));
+    EXPECT_FALSE(c->Matches(SparseIRHandle{sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size - 1}));
+    EXPECT_EQ(cache.GetNumEntries(), 3u);
+
+    EXPECT_EQ(cache.GetColliding<PreparedDenseIR>(DenseIRHandle{dense_ir, dense_ir_size}), a);
+    EXPECT_EQ(cache.GetColliding<PreparedSparseIR>(sparse), c);
+    EXPECT_EQ(cache.GetHits(), 2u);
+
+    // Evicting one entry leaves the others under the shared key
+    b.reset();
+    cache.SetBudget(0);
+    EXPECT_EQ(cache.GetNumEntries(), 2u);
+    EXPECT_EQ(cache.GetColliding<PreparedDenseIR>(DenseIRHandle{dense_ir, dense_ir_size}), a);
+}
@@ -0,0 +1,111 @@
+#include "test_common.hpp"
+#include "../../MultiRateConvolutionEngine.hpp"
+
+#include <cmath>
+#include <random>
+
+// Exponentially decaying noise, smoothed so that most of the energy sits below a
+// quarter of the sample rate, like the tail of a real room
+static std::vector<float> MakeReverbIR(size_t num_taps) {
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise;
+    std::vector<float> ir(num_taps);
+    float smooth = 0.0f;
+    for (size_t n = 0; n < num_taps; n++) {
+        smooth = 0.8f * smooth + 0.2f * noise(rng);
+        ir[n] = smooth * std::exp(-3.0f * n / num_taps);
+    }
+    return ir;
+}
+
+// A few low sines, different per channel
+static std::vector<float> MakeLowInput(size_t frames, size_t num_ch) {
+    std::vector<float> in(frames * num_ch);
+    for (size_t i = 0; i < frames; i++)
+        for (size_t ch = 0; ch < num_ch; ch++)
+            in[i * num_ch + ch] = std::sin(0.03f * i * (ch + 1)) + 0.5f * std::sin(0.011f * i + ch);
+    return in;
+}
+
+static std::vector<float> DenseReference(const std::vector<float>& ir, const std::vector<float>& in, size_t num_ch) {
+    return RenderReference<DenseConvolutionEngine>(DenseIRHandle{ir.data(), ir.size()}, in, num_ch);
+}
+
+static std::vector<float> RunMultiRate(const std::vector<float>& ir, const MultiRateConfig& config,
+                                       const std::vector<float>& in, size_t num_ch, size_t block) {
+    std::vector<float> work(MultiRateConvolutionEngine::GetWorkBufferSize(ir.size(), config, num_ch)), out(in.size());
+    MultiRateConvolutionEngine engine;
+    engine.Init({ir.data(), ir.size()}, config, work.data(), num_ch);
+    const size_t frames = in.size() / num_ch;
+    for (size_t start = 0; start < frames; start += block) {
+        const size_t size = std::min(block, frames - start);
+        engine.Process(in.data() + start * num_ch, out.data() + start * num_ch, size);
+    }
+    return out;
+}
+
+// Error energy relative to the reference, in dB, past the first skip frames
+static double ErrorDb(const std::vector<float>& out, const std::vector<float>& expected, size_t skip) {
+    double error = 0.0, energy = 0.0;
+    for (size_t i = skip; i < out.size(); i++) {
+        error  += (out[i] - expected[i]) * (out[i] - expected[i]);
+        energy += expected[i] * expected[i];
+    }
+    return 10.0 * std::log10(error / energy);
+}
+
+TEST(MultiRateTest, ShortIRIsExact) {
+    // Everything fits in the early part: plain dense convolution
+    const auto ir = MakeReverbIR(450);
+    const MultiRateConfig config = {400, 2, 63};
+    const auto in = MakeLowInput(3000, 2);
+    const auto out = RunMultiRate(ir, config, in, 2, 64);
+    const auto expected = DenseReference(ir, in, 2);
+    for (size_t i = 0; i < out.size(); i++) ASSERT_NEAR(out[i], expected[i], 1e-4) << "i " << i;
+}
+
+TEST(MultiRateTest, EarlyPartIsExact) {
+    // An impulse reproduces the IR exactly until the low-passed late part, with its
+    // filter spread, starts to contribute
+    const auto ir = MakeReverbIR(4096);
+    for (size_t rate : {2, 4}) {
+        const MultiRateConfig config = {512, rate, 63};
+        std::vector<float> in(6000, 0.0f);
+        in[0] = 1.0f;
+        const auto out = RunMultiRate(ir, config, in, 1, 100);
+        for (size_t n = 0; n < config.split_taps - 2 * config.filter_taps; n++)
+            ASSERT_FLOAT_EQ(out[n], ir[n]) << "rate " << rate << " n " << n;
+    }
+}
+
+TEST(MultiRateTest, LowBandMatchesFullConvolution) {
+    // In band, the sum of both parts matches the full-rate convolution, with the late
+    // part's latency compensated, for any callback size and channel count
+    const auto ir = MakeReverbIR(4096);
+    for (size_t num_ch : {1, 2, 3}) {
+        const auto in = MakeLowInput(6000, num_ch);
+        const auto expected = DenseReference(ir, in, num_ch);
+        for (size_t rate : {2, 4}) {
+            for (size_t block : {1, 37, 700}) {
+                const auto out = RunMultiRate(ir, {512, rate, 127}, in, num_ch, block);
+                EXPECT_LT(ErrorDb(out, expected, 0), -60.0) << "ch " << num_ch << " rate " << rate << " block " << block;
+            }
+        }
+    }
+}
+
+TEST(MultiRateTest, LongerFilterIsMoreAccurate) {
+    // The filter length is the accuracy control: its passband widens with its length, so
+    // a tone near the band edge of the quarter rate goes from attenuated to accurate
+    const auto ir = MakeReverbIR(4096);
+    std::vector<float> in(8000);
+    for (size_t i = 0; i < in.size(); i++) in[i] = std::sin(0.4f * i);
+    const auto expected = DenseReference(ir, in, 1);
+    const size_t filters[3] = {31, 63, 127};
+    double errors[3];
+    for (size_t i = 0; i < 3; i++)
+        errors[i] = ErrorDb(RunMultiRate(ir, {512, 4, filters[i]}, in, 1, 128), expected, 0);
+    EXPECT_LT(errors[1], errors[0] - 10.0);
+    EXPECT_LT(errors[2], errors[1] - 10.0);
+    EXPECT_LT(errors[2], -40.0);
+}
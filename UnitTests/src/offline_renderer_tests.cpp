@@ -0,0 +1,83 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../OfflineRenderer.hpp"
+
+// Reference: one engine, whole signal plus tail in a single pass
+template<typename EngineType, typename HandleType>
+static std::vector<float> RenderWithTail(const HandleType& handle, std::vector<float> in, size_t num_channels) {
+    const size_t length = ir_length(handle);
+    in.resize(in.size() + (length > 0 ? length - 1 : 0) * num_channels, 0.0f);
+    return RenderReference<EngineType>(handle, in, num_channels);
+}
+
+// Renders `in` in pieces of piece_frames through the chunk-parallel renderer
+template<typename EngineType, typename HandleType>
+static std::vector<float> RenderOffline(const HandleType& handle, const std::vector<float>& in, size_t num_channels,
+                                        size_t chunk_frames, size_t num_threads, size_t piece_frames) {
+    OfflineRenderer<EngineType, HandleType> renderer;
+    renderer.Init(handle, num_channels, chunk_frames, num_threads);
+    const size_t num_frames = in.size() / num_channels;
+    std::vector<float> out(in.size() + renderer.GetTailFrames() * num_channels, 0.0f);
+    for (size_t start = 0; start < num_frames; start += piece_frames) {
+        const size_t frames = std::min(piece_frames, num_frames - start);
+        renderer.Render(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+    renderer.Flush(out.data() + in.size());
+    return out;
+}
+
+TEST(OfflineRendererTest, DenseMatchesSinglePass) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    for (size_t num_channels : {1, 2, 5}) {
+        const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+        const auto expected = RenderWithTail<DenseConvolutionEngine>(handle, in, num_channels);
+        // Chunks shorter than the IR tail, uneven pieces and more threads than chunks
+        for (size_t chunk : {100, 1000, 8192}) {
+            const auto out = RenderOffline<DenseConvolutionEngine>(handle, in, num_channels, chunk, 3, 1500);
+            ASSERT_EQ(out.size(), expected.size());
+            for (size_t i = 0; i < out.size(); i++)
+                ASSERT_NEAR(out[i], expected[i], 1e-4) << "chunk " << chunk << " sample " << i;
+        }
+    }
+}
+
+TEST(OfflineRendererTest, SparseMatchesSinglePass) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    const auto in = MakeInterleavedInput(input_signal_size, 2);
+    const auto expected = RenderWithTail<SparseConvolutionEngine>(handle, in, 2);
+    const auto out = RenderOffline<SparseConvolutionEngine>(handle, in, 2, 512, 4, 777);
+    ASSERT_EQ(out.size(), expected.size());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4);
+}
+
+TEST(OfflineRendererTest, VelvetMatchesSinglePass) {
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    const auto in = MakeInterleavedInput(input_signal_size, 4);
+    const auto expected = RenderWithTail<VelvetConvolutionEngine>(handle, in, 4);
+    const auto out = RenderOffline<VelvetConvolutionEngine>(handle, in, 4, 300, 2, 4096);
+    ASSERT_EQ(out.size(), expected.size());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4);
+}
+
+TEST(OfflineRendererTest, AutoChunksAndTailWaves) {
+    using Renderer = OfflineRenderer<DenseConvolutionEngine, DenseIRHandle>;
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    Renderer renderer;
+    renderer.Init(handle, 1);
+    EXPECT_GE(renderer.GetChunkFrames(), renderer.GetTailFrames() * Renderer::kChunkTailRatio);
+    EXPECT_GE(renderer.GetChunkFrames(), Renderer::kMinChunkFrames);
+
+    // A tail budget of one tail: every wave renders one chunk per thread
+    const auto in = MakeInterleavedInput(input_signal_size, 2);
+    const auto expected = RenderWithTail<DenseConvolutionEngine>(handle, in, 2);
+    Renderer waves;
+    waves.Init(handle, 2, 200, 2, (dense_ir_size - 1) * 2 * sizeof(float));
+    std::vector<float> out(expected.size(), 0.0f);
+    waves.Render(in.data(), out.data(), input_signal_size);
+    waves.Flush(out.data() + in.size());
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4) << "sample " << i;
+}
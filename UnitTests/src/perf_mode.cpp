@@ -0,0 +1,181 @@
+#include "perf_mode.hpp"
+#include "generated_test_data.hpp"
+#include "../../Benchmarks/src/bench_common.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+
+struct PerfOptions {
+    std::string baseline_path = "perf_baseline.txt";
+    double tolerance = 0.15;
+    size_t samples = 32768;
+    size_t repetitions = 7;
+    size_t warmup = 2;
+    int cpu = 0;
+    bool update_baseline = false;
+};
+
+// Times config.block_size calls over options.samples frames and returns the median throughput
+// in frames per second.
+template<typename EngineType, typename HandleType>
+double MeasureThroughput(const TestConfig& config, const HandleType& handle, const PerfOptions& options) {
+    const size_t num_ch = config.num_channels;
+    std::vector<float> circ_buffer(config.buffer_size);
+    std::vector<float> in(options.samples * num_ch);
+    std::vector<float> out(options.samples * num_ch);
+    for (size_t i = 0; i < options.samples; i++)
+        for (size_t ch = 0; ch < num_ch; ch++)
+            in[i * num_ch + ch] = input_signal[i % input_signal_size];
+
+    EngineType engine;
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_ch);
+
+    std::vector<double> seconds;
+    for (size_t rep = 0; rep < options.warmup + options.repetitions; rep++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t pos = 0; pos < options.samples; pos += config.block_size) {
+            const size_t block = std::min(config.block_size, options.samples - pos);
+            engine.Process(in.data() + pos * num_ch, out.data() + pos * num_ch, block);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        if (rep >= options.warmup)
+            seconds.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return options.samples / seconds[seconds.size() / 2];
+}
+
+double MeasureConfig(const TestConfig& config, const PerfOptions& options) {
+    switch (config.ir_type) {
+        case IRType::DENSE: {
+            DenseIRHandle handle = {dense_ir, dense_ir_size};
+            return MeasureThroughput<DenseConvolutionEngine>(config, handle, options);
+        }
+        case IRType::SPARSE: {
+            SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+            return MeasureThroughput<SparseConvolutionEngine>(config, handle, options);
+        }
+        case IRType::VELVET: {
+            VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                                     velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+            return MeasureThroughput<VelvetConvolutionEngine>(config, handle, options);
+        }
+    }
+    return 0.0;
+}
+
+// Baseline format: one "<config name> <frames per second>" per line, '#' starts a comment
+std::map<std::string, double> LoadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        double throughput;
+        if (fields >> name >> throughput) baseline[name] = throughput;
+    }
+    return baseline;
+}
+
+bool SaveBaseline(const std::string& path, const std::vector<std::pair<std::string, double>>& results,
+                  const PerfOptions& options) {
+    std::ofstream file(path);
+    if (!file) return false;
+    file << "# Throughput baseline for run_tests --perf, in frames per second.\n";
+    file << "# Machine specific: regenerate with --update-baseline from a Release build\n";
+    file << "# (samples " << options.samples << ", repetitions " << options.repetitions << ").\n";
+    for (const auto& result : results)
+        file << result.first << " " << static_cast<long long>(result.second) << "\n";
+    return true;
+}
+
+bool ParseOptions(int argc, char** argv, PerfOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(arg, "--perf")) continue;
+        else if (!std::strcmp(arg, "--update-baseline")) options.update_baseline = true;
+        else if (!std::strcmp(arg, "--baseline") && has_value) options.baseline_path = argv[++i];
+        else if (!std::strcmp(arg, "--tolerance") && has_value) options.tolerance = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--samples") && has_value) options.samples = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(arg, "--repetitions") && has_value) options.repetitions = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(arg, "--warmup") && has_value) options.warmup = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(arg, "--cpu") && has_value) options.cpu = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "perf: unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return options.samples > 0 && options.repetitions > 0;
+}
+
+} // namespace
+
+int RunPerfMode(const std::vector<TestConfig>& configs, int argc, char** argv) {
+    PerfOptions options;
+    if (!ParseOptions(argc, argv, options)) return 2;
+
+    if (!Bench::PinToCpu(options.cpu))
+        std::fprintf(stderr, "perf: could not pin to cpu %d, timings may be noisy\n", options.cpu);
+
+    const auto baseline = options.update_baseline ? std::map<std::string, double>() : LoadBaseline(options.baseline_path);
+    if (!options.update_baseline && baseline.empty()) {
+        std::fprintf(stderr, "perf: no baseline in %s (use --update-baseline to record one)\n", options.baseline_path.c_str());
+        return 2;
+    }
+
+    std::vector<std::pair<std::string, double>> results;
+    int regressions = 0;
+    int stale = 0;
+    for (const auto& config : configs) {
+        const std::string name = ConfigName(config);
+        const double throughput = MeasureConfig(config, options);
+        results.emplace_back(name, throughput);
+
+        if (options.update_baseline) {
+            std::printf("%-40s %12.0f frames/s\n", name.c_str(), throughput);
+            continue;
+        }
+        const auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::printf("%-40s %12.0f frames/s  (no baseline)\n", name.c_str(), throughput);
+            continue;
+        }
+        // Faster by more than the tolerance: the baseline no longer holds the current speed
+        // and would let that gain be given back unnoticed
+        const double ratio = throughput / it->second;
+        const bool regressed = ratio < 1.0 - options.tolerance;
+        const bool outdated = ratio > 1.0 + options.tolerance;
+        regressions += regressed ? 1 : 0;
+        stale += outdated ? 1 : 0;
+        std::printf("%-40s %12.0f frames/s  %+6.1f%%%s\n", name.c_str(), throughput, (ratio - 1.0) * 100.0,
+                    regressed ? "  REGRESSION" : outdated ? "  STALE BASELINE" : "");
+    }
+
+    if (options.update_baseline) {
+        if (!SaveBaseline(options.baseline_path, results, options)) {
+            std::fprintf(stderr, "perf: cannot write %s\n", options.baseline_path.c_str());
+            return 2;
+        }
+        std::printf("baseline written to %s\n", options.baseline_path.c_str());
+        return 0;
+    }
+
+    std::printf("%d of %zu configurations regressed beyond %.0f%% tolerance\n",
+                regressions, configs.size(), options.tolerance * 100.0);
+    if (stale > 0)
+        std::printf("%d of %zu configurations ran faster than the baseline by more than the tolerance: "
+                    "record a new one with --update-baseline along with the change\n", stale, configs.size());
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "test_common.hpp"
+#include <vector>
+
+// Perf-test mode (run_tests --perf): times every configuration of the unit test matrix on the
+// generated test signals and compares the throughput against a checked-in baseline.
+//
+// Options:
+//   --baseline FILE      baseline to compare against (default: perf_baseline.txt)
+//   --tolerance FRAC     allowed slowdown before failing, e.g. 0.15 for 15% (default 0.15)
+//   --samples N          frames processed per timed repetition (default 32768)
+//   --repetitions N      timed repetitions, the median is reported (default 7)
+//   --warmup N           untimed repetitions discarded before timing (default 2)
+//   --cpu N              core to pin the process to (default 0, -1 disables pinning)
+//   --update-baseline    write the measured throughput to the baseline file instead of comparing
+//
+// Returns non-zero if any configuration is slower than baseline * (1 - tolerance).
+int RunPerfMode(const std::vector<TestConfig>& configs, int argc, char** argv);
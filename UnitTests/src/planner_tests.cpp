@@ -0,0 +1,79 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../ConvolutionPlanner.hpp"
+
+#include <cstdio>
+
+TEST(PlannerTest, TunesAndReusesWisdom) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const size_t buffer_size = 1024, num_channels = 2, block_size = 64;
+    const std::string key = ConvolutionPlanner::MakeKey(handle, buffer_size, num_channels, block_size);
+    EXPECT_EQ(key, "dense:taps=256:len=256:ch=2:block=64:pow2=1");
+
+    ConvolutionPlanner planner;
+    planner.SetMeasureBudget(1 << 16);
+    std::vector<float> circ_buffer(buffer_size);
+    DenseConvolutionEngine engine;
+    engine.Init(handle, circ_buffer.data(), buffer_size, num_channels);
+
+    const auto tiling = planner.Tune(engine, handle, buffer_size, num_channels, block_size);
+    EXPECT_EQ(planner.GetNumMeasurements(), 1u);
+    EXPECT_TRUE(planner.HasWisdom(key));
+    EXPECT_EQ(engine.GetTiling().tile_taps, tiling.tile_taps);
+
+    // Same configuration again: no new measurement
+    planner.Tune(engine, handle, buffer_size, num_channels, block_size);
+    EXPECT_EQ(planner.GetNumMeasurements(), 1u);
+
+    // Round trip through a wisdom file
+    const std::string path = ::testing::TempDir() + "planner_wisdom.txt";
+    ASSERT_TRUE(planner.SaveWisdom(path));
+    ConvolutionPlanner restarted;
+    ASSERT_TRUE(restarted.LoadWisdom(path));
+    EXPECT_TRUE(restarted.HasWisdom(key));
+    const auto reused = restarted.Tune(engine, handle, buffer_size, num_channels, block_size);
+    EXPECT_EQ(restarted.GetNumMeasurements(), 0u);
+    EXPECT_EQ(reused.block_frames, tiling.block_frames);
+    EXPECT_EQ(reused.tile_taps, tiling.tile_taps);
+
+    // Wisdom from another CPU model is not applied
+    ConvolutionPlanner other_cpu;
+    other_cpu.SetCpuModel("Some Other CPU");
+    other_cpu.SetMeasureBudget(1 << 16);
+    ASSERT_TRUE(other_cpu.LoadWisdom(path));
+    EXPECT_FALSE(other_cpu.HasWisdom(key));
+    other_cpu.Tune(engine, handle, buffer_size, num_channels, block_size);
+    EXPECT_EQ(other_cpu.GetNumMeasurements(), 1u);
+    std::remove(path.c_str());
+}
+
+TEST(PlannerTest, TunedSparseEngineStaysCorrect) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    ConvolutionPlanner planner;
+    planner.SetMeasureBudget(1 << 14);
+    std::vector<float> circ_buffer(1024), out(input_signal_size);
+    SparseConvolutionEngine engine;
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), 1);
+    planner.Tune(engine, handle, circ_buffer.size(), 1, 64);
+
+    for (size_t start = 0; start < input_signal_size; start += 64)
+        engine.Process(input_signal + start, out.data() + start, std::min<size_t>(64, input_signal_size - start));
+    for (size_t i = 0; i < input_signal_size; i++)
+        ASSERT_NEAR(out[i], expected_output_sparse[i], 1e-3);
+}
+
+TEST(PlannerTest, EmptyBlockLeavesEngineUntuned) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    ConvolutionPlanner planner;
+    std::vector<float> circ_buffer(1024);
+    DenseConvolutionEngine engine;
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), 1);
+    const auto before = engine.GetTiling();
+
+    const auto tiling = planner.Tune(engine, handle, circ_buffer.size(), 1, 0);
+    EXPECT_EQ(planner.GetNumMeasurements(), 0u);
+    EXPECT_FALSE(planner.HasWisdom(ConvolutionPlanner::MakeKey(handle, circ_buffer.size(), 1, 0)));
+    EXPECT_EQ(tiling.block_frames, before.block_frames);
+    EXPECT_EQ(tiling.tile_taps, before.tile_taps);
+    EXPECT_EQ(engine.GetTiling().tile_taps, before.tile_taps);
+}
@@ -0,0 +1,56 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../PolyphaseConvolutionEngine.hpp"
+
+// Zero-stuff by up, convolve at the high rate, keep every down-th sample
+static std::vector<float> NaiveResample(const std::vector<float>& in, size_t num_channels, const float* taps, size_t num_taps,
+                                        size_t up, size_t down) {
+    const size_t in_frames = in.size() / num_channels;
+    const size_t high_frames = in_frames * up;
+    std::vector<float> out;
+    for (size_t m = 0; m * down < high_frames; m++) {
+        for (size_t ch = 0; ch < num_channels; ch++) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < num_taps && k <= m * down; k++) {
+                const size_t t = m * down - k;
+                if (t % up == 0) acc += taps[k] * in[(t / up) * num_channels + ch];
+            }
+            out.push_back(acc);
+        }
+    }
+    return out;
+}
+
+TEST(PolyphaseTest, MatchesZeroStuffedFilter) {
+    const size_t factors[][2] = {{2, 1}, {4, 1}, {1, 2}, {1, 4}, {3, 2}, {2, 3}, {1, 1}};
+    const size_t in_frames = 1000;
+
+    for (size_t num_channels : {1, 2, 3}) {
+        std::vector<float> in(in_frames * num_channels);
+        for (size_t i = 0; i < in.size(); i++) in[i] = input_signal[i % input_signal_size];
+
+        for (const auto& f : factors) {
+            const size_t up = f[0], down = f[1];
+            DenseIRHandle handle = {dense_ir, dense_ir_size};
+            const auto expected = NaiveResample(in, num_channels, dense_ir, dense_ir_size, up, down);
+
+            PolyphaseConvolutionEngine engine;
+            std::vector<float> phase_taps(dense_ir_size);
+            std::vector<float> circ_buffer(PolyphaseConvolutionEngine::GetMinBufferSize(handle, down, num_channels) + 5);
+            engine.Init(handle, up, down, circ_buffer.data(), circ_buffer.size(), num_channels, phase_taps.data());
+
+            std::vector<float> out(engine.GetMaxOutputFrames(in_frames) * num_channels);
+            size_t written = 0;
+            for (size_t start = 0; start < in_frames; start += 37) {
+                const size_t frames = std::min<size_t>(37, in_frames - start);
+                const size_t predicted = engine.GetOutputFrames(frames);
+                const size_t n = engine.Process(in.data() + start * num_channels, out.data() + written * num_channels, frames);
+                ASSERT_EQ(n, predicted);
+                written += n;
+            }
+            ASSERT_EQ(written * num_channels, expected.size()) << "up " << up << " down " << down;
+            for (size_t i = 0; i < expected.size(); i++)
+                ASSERT_NEAR(out[i], expected[i], 1e-4) << "up " << up << " down " << down << " ch " << num_channels << " i " << i;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../ReblockingEngine.hpp"
+
+#include <random>
+
+// Callback sizes from 1 to 300 frames, fixed seed
+static std::vector<size_t> MakeCallbackSizes(size_t total) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> dist(1, 300);
+    std::vector<size_t> sizes;
+    for (size_t done = 0; done < total; ) {
+        const size_t n = std::min(dist(rng), total - done);
+        sizes.push_back(n);
+        done += n;
+    }
+    return sizes;
+}
+
+template<typename EngineType, typename HandleType>
+static std::vector<float> RenderDirect(const HandleType& handle, size_t num_channels) {
+    return RenderReference<EngineType>(handle, MakeInterleavedInput(input_signal_size, num_channels), num_channels);
+}
+
+// In place, the output overwrites the input buffer
+template<typename EngineType>
+static std::vector<float> RenderReblocked(ReblockingEngine<EngineType>& reblocking, size_t num_channels, bool in_place = false) {
+    const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+    std::vector<float> out(in.size());
+    if (in_place) out = in;
+    const float* src = in_place ? out.data() : in.data();
+    size_t start = 0;
+    for (size_t frames : MakeCallbackSizes(input_signal_size)) {
+        reblocking.Process(src + start * num_channels, out.data() + start * num_channels, frames);
+        start += frames;
+    }
+    return out;
+}
+
+TEST(ReblockingTest, BufferedModeDelaysByLatency) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const size_t num_channels = 2;
+    const auto expected = RenderDirect<DenseConvolutionEngine>(handle, num_channels);
+
+    for (size_t block_frames : {1, 16, 64, 500}) {
+        std::vector<float> circ_buffer(1024);
+        std::vector<float> fifo(ReblockingEngine<DenseConvolutionEngine>::GetFifoSize(block_frames, num_channels));
+        DenseConvolutionEngine engine;
+        engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_channels);
+        ReblockingEngine<DenseConvolutionEngine> reblocking;
+        reblocking.Init(&engine, num_channels, block_frames, fifo.data());
+        ASSERT_EQ(reblocking.GetLatency(), block_frames - 1);
+
+        const auto out = RenderReblocked(reblocking, num_channels);
+        const size_t latency = reblocking.GetLatency() * num_channels;
+        for (size_t i = 0; i < out.size(); i++)
+            ASSERT_NEAR(out[i], i < latency ? 0.0f : expected[i - latency], 1e-4) << "block " << block_frames << " i " << i;
+    }
+}
+
+TEST(ReblockingTest, ZeroLatencySparse) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    const size_t num_channels = 1;
+    const auto expected = RenderDirect<SparseConvolutionEngine>(handle, num_channels);
+
+    for (size_t block_frames : {1, 32, 128}) {
+        std::vector<size_t> positions(handle.num_taps);
+        std::vector<float> values(handle.num_taps);
+        SparseIRHandle head, tail;
+        split_ir(handle, block_frames - 1, positions.data(), values.data(), head, tail);
+
+        std::vector<float> head_buffer(1024), tail_buffer(1024);
+        std::vector<float> fifo(ReblockingEngine<SparseConvolutionEngine>::GetFifoSize(block_frames, num_channels));
+        SparseConvolutionEngine head_engine, tail_engine;
+        head_engine.Init(head, head_buffer.data(), head_buffer.size(), num_channels);
+        tail_engine.Init(tail, tail_buffer.data(), tail_buffer.size(), num_channels);
+        ReblockingEngine<SparseConvolutionEngine> reblocking;
+        reblocking.Init(&tail_engine, num_channels, block_frames, fifo.data(), &head_engine);
+        ASSERT_EQ(reblocking.GetLatency(), 0u);
+
+        const auto out = RenderReblocked(reblocking, num_channels);
+        for (size_t i = 0; i < out.size(); i++)
+            ASSERT_NEAR(out[i], expected[i], 1e-4) << "block " << block_frames << " i " << i;
+    }
+}
+
+TEST(ReblockingTest, ZeroLatencyVelvet) {
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    const size_t num_channels = 4;
+    const size_t block_frames = 256;
+    const auto expected = RenderDirect<VelvetConvolutionEngine>(handle, num_channels);
+
+    std::vector<size_t> pos(handle.num_pos_taps), neg(handle.num_neg_taps);
+    VelvetIRHandle head, tail;
+    split_ir(handle, block_frames - 1, pos.data(), neg.data(), head, tail);
+    ASSERT_EQ(head.num_pos_taps + tail.num_pos_taps, handle.num_pos_taps);
+
+    const size_t buffer_size = ConvolutionUtils::next_power_of_two(ir_length(handle) * num_channels);
+    std::vector<float> head_buffer(buffer_size), tail_buffer(buffer_size);
+    std::vector<float> fifo(ReblockingEngine<VelvetConvolutionEngine>::GetFifoSize(block_frames, num_channels));
+    VelvetConvolutionEngine head_engine, tail_engine;
+    head_engine.Init(head, head_buffer.data(), buffer_size, num_channels);
+    tail_engine.Init(tail, tail_buffer.data(), buffer_size, num_channels);
+    ReblockingEngine<VelvetConvolutionEngine> reblocking;
+    reblocking.Init(&tail_engine, num_channels, block_frames, fifo.data(), &head_engine);
+
+    const auto out = RenderReblocked(reblocking, num_channels);
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4) << "i " << i;
+}
+
+TEST(ReblockingTest, ZeroLatencyInPlace) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    const size_t num_channels = 2, block_frames = 32;
+    const auto expected = RenderDirect<SparseConvolutionEngine>(handle, num_channels);
+
+    std::vector<size_t> positions(handle.num_taps);
+    std::vector<float> values(handle.num_taps);
+    SparseIRHandle head, tail;
+    split_ir(handle, block_frames - 1, positions.data(), values.data(), head, tail);
+
+    std::vector<float> head_buffer(2048), tail_buffer(2048);
+    std::vector<float> fifo(ReblockingEngine<SparseConvolutionEngine>::GetFifoSize(block_frames, num_channels));
+    SparseConvolutionEngine head_engine, tail_engine;
+    head_engine.Init(head, head_buffer.data(), head_buffer.size(), num_channels);
+    tail_engine.Init(tail, tail_buffer.data(), tail_buffer.size(), num_channels);
+    ReblockingEngine<SparseConvolutionEngine> reblocking;
+    reblocking.Init(&tail_engine, num_channels, block_frames, fifo.data(), &head_engine);
+
+    const auto out = RenderReblocked(reblocking, num_channels, true);
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4) << "i " << i;
+}
@@ -0,0 +1,105 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+
+#include <atomic>
+#include <limits>
+
+// Signal bursts separated by gaps longer than the IR, so the engine goes idle and wakes up again
+static std::vector<float> MakeBurstInput(size_t frames, size_t burst, size_t gap, size_t num_channels) {
+    auto in = MakeInterleavedInput(frames, num_channels);
+    for (size_t i = 0; i < frames; i++)
+        if (i % (burst + gap) >= burst)
+            std::fill_n(in.begin() + i * num_channels, num_channels, 0.0f);
+    return in;
+}
+
+// Direct convolution of each channel, for comparison with the engines
+static std::vector<float> DirectConvolution(const std::vector<float>& in, const float* taps, size_t num_taps, size_t num_channels) {
+    std::vector<float> out(in.size(), 0.0f);
+    const size_t frames = in.size() / num_channels;
+    for (size_t n = 0; n < frames; n++)
+        for (size_t k = 0; k < num_taps && k <= n; k++)
+            for (size_t ch = 0; ch < num_channels; ch++)
+                out[n * num_channels + ch] += taps[k] * in[(n - k) * num_channels + ch];
+    return out;
+}
+
+TEST(SilenceTest, IdleFastPathKeepsOutputExact) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const size_t num_channels = 2;
+    const auto in = MakeBurstInput(6000, 300, 700, num_channels);
+    const auto expected = DirectConvolution(in, dense_ir, dense_ir_size, num_channels);
+
+    DenseConvolutionEngine engine;
+    std::vector<float> circ_buffer(1024);
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_channels);
+    EXPECT_TRUE(engine.IsIdle());
+
+    std::vector<float> out(in.size());
+    bool went_idle = false;
+    for (size_t start = 0; start < 6000; start += 50) {
+        engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, 50);
+        went_idle |= engine.IsIdle();
+        // Within the burst the engine is busy, once the gap covers the IR it is idle
+        const size_t phase = (start + 50) % 1000;
+        if (phase > 0 && phase <= 300) {
+            EXPECT_FALSE(engine.IsIdle()) << "frame " << start;
+        }
+        if (phase >= 300 + dense_ir_size + 50) {
+            EXPECT_TRUE(engine.IsIdle()) << "frame " << start;
+        }
+    }
+    EXPECT_TRUE(went_idle);
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4) << "sample " << i;
+}
+
+TEST(SilenceTest, IdleCounterTracksEngines) {
+    SparseIRHandle sparse = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    VelvetIRHandle velvet = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    std::atomic<size_t> idle_count(0);
+    std::vector<float> sparse_buffer(ConvolutionUtils::next_power_of_two(ir_length(sparse)));
+    std::vector<float> velvet_buffer(ConvolutionUtils::next_power_of_two(ir_length(velvet)));
+    {
+        SparseConvolutionEngine sparse_engine;
+        VelvetConvolutionEngine velvet_engine;
+        sparse_engine.Init(sparse, sparse_buffer.data(), sparse_buffer.size(), 1);
+        velvet_engine.Init(velvet, velvet_buffer.data(), velvet_buffer.size(), 1);
+        sparse_engine.SetIdleCounter(&idle_count);
+        velvet_engine.SetIdleCounter(&idle_count);
+        EXPECT_EQ(idle_count.load(), 2u);
+
+        std::vector<float> block(64, 0.0f), out(64);
+        block[10] = 1.0f;
+        sparse_engine.Process(block.data(), out.data(), 64);
+        EXPECT_EQ(idle_count.load(), 1u);
+        velvet_engine.Process(block.data(), out.data(), 64);
+        EXPECT_EQ(idle_count.load(), 0u);
+
+        // Silence until both tails have drained
+        std::fill(block.begin(), block.end(), 0.0f);
+        const size_t longest = std::max(ir_length(sparse), ir_length(velvet));
+        for (size_t done = 0; done < longest + 64; done += 64) {
+            sparse_engine.Process(block.data(), out.data(), 64);
+            velvet_engine.Process(block.data(), out.data(), 64);
+        }
+        EXPECT_EQ(idle_count.load(), 2u);
+        for (float v : out) EXPECT_EQ(v, 0.0f);
+    }
+    // Destroyed engines leave the count
+    EXPECT_EQ(idle_count.load(), 0u);
+}
+
+#if defined(CONVOLUTION_HAS_MXCSR)
+TEST(SilenceTest, DenormalGuardFlushesToZero) {
+    volatile float tiny = std::numeric_limits<float>::min();
+    volatile float half = 0.5f;
+    EXPECT_NE(tiny * half, 0.0f);
+    {
+        ConvolutionUtils::DenormalGuard guard;
+        EXPECT_EQ(tiny * half, 0.0f);
+    }
+    EXPECT_NE(tiny * half, 0.0f);
+}
+#endif
@@ -0,0 +1,51 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../SparseMatrixConvolutionEngine.hpp"
+
+TEST(SparseMatrixTest, MatchesSingleSparseEngines) {
+    // Eight IRs over overlapping subsets of the same positions, as the taps of a delay network
+    const size_t num_irs = 8;
+    std::vector<std::vector<size_t>> positions(num_irs);
+    std::vector<std::vector<float>> values(num_irs);
+    std::vector<SparseIRHandle> handles(num_irs);
+    for (size_t i = 0; i < num_irs; i++) {
+        for (size_t t = i % 3; t < sparse_ir_positions_size; t += 1 + i % 2) {
+            positions[i].push_back(sparse_ir_positions[t]);
+            values[i].push_back(sparse_ir_values[t] * (i % 2 ? -0.5f : 1.0f));
+        }
+        handles[i] = {positions[i].data(), values[i].data(), positions[i].size()};
+    }
+    const size_t num_entries = SparseMatrixConvolutionEngine::GetNumEntries(handles.data(), num_irs);
+    size_t max_length = 0;
+    for (const auto& handle : handles) max_length = std::max(max_length, ir_length(handle));
+
+    for (size_t num_channels : {1, 2, 3}) {
+        const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+        std::vector<std::vector<float>> expected;
+        for (const auto& handle : handles)
+            expected.push_back(RenderReference<SparseConvolutionEngine>(handle, in, num_channels));
+
+        // Exact fit (one frame per pass) and a roomy history
+        for (size_t history_frames : {max_length, max_length + 500}) {
+            std::vector<float> history(history_frames * num_channels);
+            std::vector<SparseMatrixRow> rows(num_entries);
+            std::vector<SparseMatrixEntry> entries(num_entries);
+            SparseMatrixConvolutionEngine engine;
+            engine.Init(handles.data(), num_irs, history.data(), history.size(), num_channels, rows.data(), entries.data());
+            EXPECT_LE(engine.GetNumRows(), sparse_ir_positions_size);
+
+            std::vector<std::vector<float>> outs(num_irs, std::vector<float>(in.size()));
+            for (size_t start = 0; start < input_signal_size; start += 200) {
+                const size_t frames = std::min<size_t>(200, input_signal_size - start);
+                std::vector<float*> block_outs(num_irs);
+                for (size_t i = 0; i < num_irs; i++) block_outs[i] = outs[i].data() + start * num_channels;
+                engine.Process(in.data() + start * num_channels, block_outs.data(), frames);
+            }
+
+            for (size_t ir = 0; ir < num_irs; ir++)
+                for (size_t i = 0; i < in.size(); i++)
+                    ASSERT_NEAR(outs[ir][i], expected[ir][i], 1e-4)
+                        << "ir " << ir << " ch " << num_channels << " history " << history_frames << " i " << i;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+
+// Clustered IR: long runs, a short run below kMinRunLength and scattered single taps
+static void MakeClusteredIR(std::vector<size_t>& positions, std::vector<float>& values) {
+    positions.clear();
+    values.clear();
+    auto add = [&](size_t pos) {
+        positions.push_back(pos);
+        values.push_back(0.1f * static_cast<float>((pos % 7) + 1) * ((pos & 1) ? -1.0f : 1.0f));
+    };
+    add(3);
+    for (size_t p = 10; p < 26; p++) add(p);
+    add(40);
+    for (size_t p = 50; p < 53; p++) add(p);
+    add(77);
+    for (size_t p = 100; p < 108; p++) add(p);
+    add(0);
+}
+
+static std::vector<float> RunSparse(const SparseIRHandle& handle, size_t buffer_size, size_t num_channels,
+                                    size_t block_size, SparseRun* runs) {
+    SparseConvolutionEngine engine;
+    std::vector<float> circ_buffer(buffer_size);
+    engine.Init(handle, circ_buffer.data(), buffer_size, num_channels, runs);
+
+    const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+    std::vector<float> out(in.size());
+    for (size_t start = 0; start < input_signal_size; start += block_size) {
+        const size_t frames = std::min(block_size, input_signal_size - start);
+        engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+    return out;
+}
+
+TEST(SparseRunTest, GroupedMatchesPerTap) {
+    std::vector<size_t> positions;
+    std::vector<float> values;
+    MakeClusteredIR(positions, values);
+    SparseIRHandle handle = {positions.data(), values.data(), positions.size()};
+    std::vector<SparseRun> runs(positions.size());
+
+    for (size_t num_channels : {1, 2, 3, 4, 5}) {
+        // Power of two, exact fit and sizes that make frames straddle the wrap point
+        for (size_t buffer_size : {ConvolutionUtils::next_power_of_two(108 * num_channels),
+                                   108 * num_channels, 108 * num_channels + 1, 131 * num_channels + 3}) {
+            const auto expected = RunSparse(handle, buffer_size, num_channels, 37, nullptr);
+            const auto grouped  = RunSparse(handle, buffer_size, num_channels, 37, runs.data());
+            for (size_t i = 0; i < expected.size(); i++)
+                ASSERT_NEAR(grouped[i], expected[i], 1e-5) << "ch " << num_channels << " buf " << buffer_size << " i " << i;
+        }
+    }
+}
+
+TEST(SparseRunTest, RunDetection) {
+    std::vector<size_t> positions;
+    std::vector<float> values;
+    MakeClusteredIR(positions, values);
+    SparseIRHandle handle = {positions.data(), values.data(), positions.size()};
+    std::vector<SparseRun> runs(positions.size(), SparseRun{0, 0, 0});
+
+    SparseConvolutionEngine engine;
+    std::vector<float> circ_buffer(512);
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), 3, runs.data());
+
+    // {3}, {10..25}, {40}, {50..52}, {77}, {100..107}, {0}
+    const size_t expected[][3] = {{3, 0, 1}, {10, 1, 16}, {40, 17, 1}, {50, 18, 3}, {77, 21, 1}, {100, 22, 8}, {0, 30, 1}};
+    for (size_t r = 0; r < 7; r++) {
+        EXPECT_EQ(runs[r].offset,    expected[r][0] * 3) << "run " << r;
+        EXPECT_EQ(runs[r].first_tap, expected[r][1]) << "run " << r;
+        EXPECT_EQ(runs[r].length,    expected[r][2]) << "run " << r;
+    }
+    EXPECT_EQ(runs[7].length, 0u);
+}
+
+TEST(SparseRunTest, GeneratedIRMatchesReference) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    std::vector<SparseRun> runs(sparse_ir_positions_size);
+    const auto out = RunSparse(handle, 1024, 1, 64, runs.data());
+    for (size_t i = 0; i < input_signal_size; i++)
+        ASSERT_NEAR(out[i], expected_output_sparse[i], 1e-3);
+}
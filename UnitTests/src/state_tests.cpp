@@ -0,0 +1,237 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+
+// Processes in blocks of 64 frames, from frame begin to frame end
+template<typename EngineType>
+static void ProcessRange(EngineType& engine, const std::vector<float>& in, std::vector<float>& out,
+                         size_t begin, size_t end, size_t num_channels) {
+    for (size_t start = begin; start < end; start += 64) {
+        const size_t frames = std::min<size_t>(64, end - start);
+        engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+}
+
+// A snapshot taken halfway resumes, in a second engine, exactly where the first one goes on
+template<typename EngineType, typename HandleType>
+static void CheckSnapshotResumes(const HandleType& handle, size_t buffer_size, size_t num_channels) {
+    const size_t frames = 2000, split = 1000;
+    const auto in = MakeInterleavedInput(frames, num_channels);
+
+    std::vector<float> buffer_a(buffer_size), buffer_b(buffer_size);
+    EngineType engine_a, engine_b;
+    engine_a.Init(handle, buffer_a.data(), buffer_a.size(), num_channels);
+    engine_b.Init(handle, buffer_b.data(), buffer_b.size(), num_channels);
+
+    std::vector<float> out_a(in.size()), out_b(in.size());
+    ProcessRange(engine_a, in, out_a, 0, split, num_channels);
+
+    std::vector<unsigned char> state(engine_a.GetStateSize());
+    ASSERT_EQ(engine_a.SaveState(state.data(), state.size()), state.size());
+    // Only the IR span is stored, not the whole buffer
+    EXPECT_LT(state.size(), buffer_size * sizeof(float) / 2);
+
+    // The second engine runs something else first, then takes over
+    ProcessRange(engine_b, in, out_b, 0, 700, num_channels);
+    ASSERT_TRUE(engine_b.RestoreState(state.data(), state.size()));
+
+    ProcessRange(engine_a, in, out_a, split, frames, num_channels);
+    ProcessRange(engine_b, in, out_b, split, frames, num_channels);
+    for (size_t i = split * num_channels; i < in.size(); i++)
+        ASSERT_EQ(out_a[i], out_b[i]) << "ch " << num_channels << " sample " << i;
+}
+
+TEST(StateTest, SnapshotResumesExactly) {
+    DenseIRHandle dense = {dense_ir, dense_ir_size};
+    SparseIRHandle sparse = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    VelvetIRHandle velvet = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+
+    for (size_t num_channels : {1, 2, 3}) {
+        CheckSnapshotResumes<DenseConvolutionEngine>(dense, 8192, num_channels);
+        CheckSnapshotResumes<SparseConvolutionEngine>(sparse, 8192, num_channels);
+        CheckSnapshotResumes<VelvetConvolutionEngine>(velvet, 8192, num_channels);
+        // Non power of two, so that the live span wraps at odd places
+        CheckSnapshotResumes<DenseConvolutionEngine>(dense, 3001 * num_channels, num_channels);
+    }
+}
+
+TEST(StateTest, ResetMatchesFreshInit) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const size_t num_channels = 2;
+    const auto in = MakeInterleavedInput(1500, num_channels);
+
+    std::vector<float> reused_buffer(4096), fresh_buffer(4096);
+    DenseConvolutionEngine reused, fresh;
+    reused.Init(handle, reused_buffer.data(), reused_buffer.size(), num_channels);
+
+    std::vector<float> out(in.size()), expected(in.size());
+    ProcessRange(reused, in, out, 0, 1500, num_channels);
+    EXPECT_FALSE(reused.IsIdle());
+
+    reused.Reset();
+    EXPECT_TRUE(reused.IsIdle());
+    for (float sample : reused_buffer) ASSERT_EQ(sample, 0.0f);
+
+    fresh.Init(handle, fresh_buffer.data(), fresh_buffer.size(), num_channels);
+    ProcessRange(reused, in, out, 0, 1500, num_channels);
+    ProcessRange(fresh, in, expected, 0, 1500, num_channels);
+    for (size_t i = 0; i < in.size(); i++)
+        ASSERT_EQ(out[i], expected[i]) << "sample " << i;
+}
+
+TEST(StateTest, RestoreRejectsMismatchedState) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    const auto in = MakeInterleavedInput(500, 2);
+    std::vector<float> out(in.size());
+
+    std::vector<float> stereo_buffer(4096), mono_buffer(4096);
+    SparseConvolutionEngine stereo, mono;
+    stereo.Init(handle, stereo_buffer.data(), stereo_buffer.size(), 2);
+    mono.Init(handle, mono_buffer.data(), mono_buffer.size(), 1);
+    ProcessRange(stereo, in, out, 0, 500, 2);
+
+    std::vector<unsigned char> state(stereo.GetStateSize());
+    EXPECT_EQ(stereo.SaveState(state.data(), state.size() - 1), 0u);
+    ASSERT_EQ(stereo.SaveState(state.data(), state.size()), state.size());
+
+    const std::vector<float> before = stereo_buffer;
+    EXPECT_FALSE(mono.RestoreState(state.data(), state.size()));
+    EXPECT_FALSE(stereo.RestoreState(state.data(), state.size() - 1));
+    EXPECT_FALSE(stereo.RestoreState(nullptr, 0));
+    EXPECT_EQ(stereo_buffer, before);
+    EXPECT_TRUE(stereo.RestoreState(state.data(), state.size()));
+    EXPECT_EQ(stereo_buffer, before);
+}
+
+TEST(StateTest, SnapshotKeepsMorphProgress) {
+    const size_t num_channels = 1;
+    const auto in = MakeInterleavedInput(1200, num_channels);
+
+    // Dense: halfway through a linear morph
+    {
+        DenseIRHandle initial = {dense_ir, dense_ir_size}, target = {dense_ir_2, dense_ir_2_size};
+        std::vector<float> buffer_a(1024), buffer_b(1024);
+        std::vector<float> current_a(dense_ir_size), delta_a(dense_ir_size);
+        std::vector<float> current_b(dense_ir_size), delta_b(dense_ir_size);
+        DenseConvolutionEngine engine_a, engine_b;
+        engine_a.Init(initial, buffer_a.data(), buffer_a.size(), num_channels, current_a.data(), delta_a.data());
+        engine_b.Init(initial, buffer_b.data(), buffer_b.size(), num_channels, current_b.data(), delta_b.data());
+
+        std::vector<float> out_a(in.size()), out_b(in.size());
+        engine_a.MorphIRDense(target, 10);
+        for (int i = 0; i < 4; i++) engine_a.MorphIRDense_Update();
+        ProcessRange(engine_a, in, out_a, 0, 600, num_channels);
+
+        std::vector<unsigned char> state(engine_a.GetStateSize());
+        ASSERT_EQ(engine_a.SaveState(state.data(), state.size()), state.size());
+        ASSERT_TRUE(engine_b.RestoreState(state.data(), state.size()));
+
+        for (size_t start = 600; start < 1200; start += 100) {
+            engine_a.MorphIRDense_Update();
+            engine_b.MorphIRDense_Update();
+            ProcessRange(engine_a, in, out_a, start, start + 100, num_channels);
+            ProcessRange(engine_b, in, out_b, start, start + 100, num_channels);
+        }
+        for (size_t i = 600; i < in.size(); i++)
+            ASSERT_EQ(out_a[i], out_b[i]) << "dense sample " << i;
+    }
+
+    // Velvet: partway through the tap-by-tap morph
+    {
+        VelvetIRHandle initial = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                                  velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+        VelvetIRHandle target = {velvet_ir_2_pos_positions, velvet_ir_2_pos_positions_size,
+                                 velvet_ir_2_neg_positions, velvet_ir_2_neg_positions_size};
+        const size_t max_taps = 100;
+        std::vector<float> buffers[2] = {std::vector<float>(1024), std::vector<float>(1024)};
+        std::vector<size_t> taps[2][6];
+        VelvetConvolutionEngine engines[2];
+        for (int e = 0; e < 2; e++) {
+            for (auto& t : taps[e]) t.resize(max_taps);
+            engines[e].Init(initial, buffers[e].data(), buffers[e].size(), num_channels,
+                            taps[e][0].data(), taps[e][1].data(), taps[e][2].data(),
+                            taps[e][3].data(), taps[e][4].data(), taps[e][5].data(), max_taps, max_taps);
+        }
+
+        std::vector<float> out_a(in.size()), out_b(in.size());
+        engines[0].MorphIRVelvet(target);
+        for (int i = 0; i < 20; i++) engines[0].MorphIRVelvet_Update();
+        ProcessRange(engines[0], in, out_a, 0, 600, num_channels);
+
+        std::vector<unsigned char> state(engines[0].GetStateSize());
+        ASSERT_EQ(engines[0].SaveState(state.data(), state.size()), state.size());
+        ASSERT_TRUE(engines[1].RestoreState(state.data(), state.size()));
+        EXPECT_TRUE(engines[1].IsMorphing());
+
+        for (size_t start = 600; start < 1200; start += 20) {
+            engines[0].MorphIRVelvet_Update();
+            engines[1].MorphIRVelvet_Update();
+            ProcessRange(engines[0], in, out_a, start, start + 20, num_channels);
+            ProcessRange(engines[1], in, out_b, start, start + 20, num_channels);
+        }
+        EXPECT_FALSE(engines[1].IsMorphing());
+        for (size_t i = 600; i < in.size(); i++)
+            ASSERT_EQ(out_a[i], out_b[i]) << "velvet sample " << i;
+    }
+}
+
+TEST(StateTest, RestoreKeepsOwnIRs) {
+    // Each engine has its own copy of the IR; the donor's copies are gone after the snapshot
+    const size_t num_channels = 2;
+    const auto in = MakeInterleavedInput(1200, num_channels);
+    std::vector<float> reference(in.size()), out(in.size());
+
+    {
+        std::vector<float> ir_b(dense_ir, dense_ir + dense_ir_size), buffer_ref(2048), buffer_b(2048);
+        DenseIRHandle handle_b = {ir_b.data(), ir_b.size()};
+        DenseConvolutionEngine engine_ref, engine_b;
+        engine_ref.Init(handle_b, buffer_ref.data(), buffer_ref.size(), num_channels);
+        engine_b.Init(handle_b, buffer_b.data(), buffer_b.size(), num_channels);
+        ProcessRange(engine_ref, in, reference, 0, 1200, num_channels);
+
+        std::vector<unsigned char> state;
+        {
+            std::vector<float> ir_a(dense_ir, dense_ir + dense_ir_size), buffer_a(2048), scratch(in.size());
+            DenseConvolutionEngine engine_a;
+            engine_a.Init({ir_a.data(), ir_a.size()}, buffer_a.data(), buffer_a.size(), num_channels);
+            ProcessRange(engine_a, in, scratch, 0, 600, num_channels);
+            state.resize(engine_a.GetStateSize());
+            ASSERT_EQ(engine_a.SaveState(state.data(), state.size()), state.size());
+            std::fill(ir_a.begin(), ir_a.end(), 100.0f);
+        }
+        ASSERT_TRUE(engine_b.RestoreState(state.data(), state.size()));
+        ProcessRange(engine_b, in, out, 600, 1200, num_channels);
+        for (size_t i = 600 * num_channels; i < in.size(); i++)
+            ASSERT_NEAR(out[i], reference[i], 1e-4) << "dense sample " << i;
+    }
+
+    // Mid-morph: the target is copied at MorphIRDense, not referenced by the snapshot
+    {
+        std::vector<float> buffer_a(2048), buffer_b(2048), out_a(in.size());
+        std::vector<float> current_a(dense_ir_size), target_a(dense_ir_size), current_b(dense_ir_size), target_b(dense_ir_size);
+        DenseIRHandle initial = {dense_ir, dense_ir_size};
+        DenseConvolutionEngine engine_a, engine_b;
+        engine_a.Init(initial, buffer_a.data(), buffer_a.size(), num_channels, current_a.data(), target_a.data());
+        engine_b.Init(initial, buffer_b.data(), buffer_b.size(), num_channels, current_b.data(), target_b.data());
+        {
+            std::vector<float> target(dense_ir_2, dense_ir_2 + dense_ir_2_size);
+            engine_a.MorphIRDense({target.data(), target.size()}, 8);
+            std::fill(target.begin(), target.end(), 100.0f);
+        }
+        for (int i = 0; i < 3; i++) engine_a.MorphIRDense_Update();
+        ProcessRange(engine_a, in, out_a, 0, 600, num_channels);
+
+        std::vector<unsigned char> state(engine_a.GetStateSize());
+        ASSERT_EQ(engine_a.SaveState(state.data(), state.size()), state.size());
+        ASSERT_TRUE(engine_b.RestoreState(state.data(), state.size()));
+        for (size_t start = 600; start < 1200; start += 100) {
+            engine_a.MorphIRDense_Update();
+            engine_b.MorphIRDense_Update();
+            ProcessRange(engine_a, in, out_a, start, start + 100, num_channels);
+            ProcessRange(engine_b, in, out, start, start + 100, num_channels);
+        }
+        EXPECT_EQ(current_b, std::vector<float>(dense_ir_2, dense_ir_2 + dense_ir_2_size));
+        for (size_t i = 600 * num_channels; i < in.size(); i++)
+            ASSERT_EQ(out[i], out_a[i]) << "morph sample " << i;
+    }
+}
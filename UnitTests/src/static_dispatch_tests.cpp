@@ -0,0 +1,46 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+
+using WMode = ConvolutionUtils::WrappingMode;
+using CLayout = ConvolutionUtils::ChannelLayout;
+
+// Runs both engines over the same interleaved input in uneven blocks
+template<typename RuntimeEngine, typename StaticEngine, typename HandleType>
+static void ExpectSameOutput(const HandleType& handle, size_t buffer_size, size_t num_channels) {
+    const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+
+    RuntimeEngine runtime_engine;
+    StaticEngine static_engine;
+    std::vector<float> runtime_buffer(buffer_size), static_buffer(buffer_size);
+    runtime_engine.Init(handle, runtime_buffer.data(), buffer_size, num_channels);
+    static_engine.Init(handle, static_buffer.data(), buffer_size, num_channels);
+
+    std::vector<float> expected(in.size()), out(in.size());
+    for (size_t start = 0; start < input_signal_size; start += 29) {
+        const size_t frames = std::min<size_t>(29, input_signal_size - start);
+        runtime_engine.Process(in.data() + start * num_channels, expected.data() + start * num_channels, frames);
+        static_engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_EQ(out[i], expected[i]) << "sample " << i;
+}
+
+TEST(StaticDispatchTest, DenseMatchesRuntime) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    ExpectSameOutput<DenseConvolutionEngine, DenseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::MONO>>(handle, 512, 1);
+    ExpectSameOutput<DenseConvolutionEngine, DenseConvolutionEngineT<WMode::ARBITRARY, CLayout::STEREO>>(handle, 600, 2);
+    ExpectSameOutput<DenseConvolutionEngine, DenseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::MULTICHANNEL>>(handle, 2048, 3);
+}
+
+TEST(StaticDispatchTest, SparseMatchesRuntime) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    ExpectSameOutput<SparseConvolutionEngine, SparseConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::STEREO>>(handle, 2048, 2);
+    ExpectSameOutput<SparseConvolutionEngine, SparseConvolutionEngineT<WMode::ARBITRARY, CLayout::QUAD>>(handle, 4000, 4);
+}
+
+TEST(StaticDispatchTest, VelvetMatchesRuntime) {
+    VelvetIRHandle handle = {velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+                             velvet_ir_neg_positions, velvet_ir_neg_positions_size};
+    ExpectSameOutput<VelvetConvolutionEngine, VelvetConvolutionEngineT<WMode::POWER_OF_TWO, CLayout::MONO>>(handle, 8192, 1);
+    ExpectSameOutput<VelvetConvolutionEngine, VelvetConvolutionEngineT<WMode::ARBITRARY, CLayout::MULTICHANNEL>>(handle, 5000, 5);
+}
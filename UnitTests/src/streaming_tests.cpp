@@ -0,0 +1,110 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include "../../StreamingDenseConvolutionEngine.hpp"
+
+#include <thread>
+
+// Direct convolution of frame m with the first num_taps taps
+static float Convolve(const std::vector<float>& in, size_t num_ch, size_t m, size_t ch, size_t num_taps) {
+    float sum = 0.0f;
+    for (size_t k = 0; k < num_taps && k <= m; k++) sum += dense_ir[k] * in[(m - k) * num_ch + ch];
+    return sum;
+}
+
+TEST(StreamingDenseTest, WholeIRMatchesDenseEngine) {
+    for (size_t num_ch : {1, 2, 3}) {
+        const auto in = MakeInterleavedInput(input_signal_size, num_ch);
+        std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(dense_ir_size * num_ch)), expected(in.size());
+        DenseConvolutionEngine dense;
+        dense.Init({dense_ir, dense_ir_size}, circ_buffer.data(), circ_buffer.size(), num_ch);
+        dense.Process(in.data(), expected.data(), input_signal_size);
+
+        // Minimal and roomy histories, so that blocks are split or not
+        for (size_t max_block : {1, 64, 300}) {
+            std::vector<float> ir(dense_ir, dense_ir + dense_ir_size), out(in.size());
+            std::vector<float> history(StreamingDenseConvolutionEngine::GetHistorySize(dense_ir_size, max_block, num_ch));
+            StreamingDenseConvolutionEngine engine;
+            engine.Init(ir.data(), ir.size(), ir.size(), history.data(), history.size(), num_ch);
+            EXPECT_TRUE(engine.IsComplete());
+            for (size_t start = 0; start < input_signal_size; start += 100) {
+                const size_t block = std::min<size_t>(100, input_signal_size - start);
+                engine.Process(in.data() + start * num_ch, out.data() + start * num_ch, block);
+            }
+            for (size_t i = 0; i < out.size(); i++)
+                ASSERT_NEAR(out[i], expected[i], 1e-4) << "ch " << num_ch << " max block " << max_block << " i " << i;
+        }
+    }
+}
+
+TEST(StreamingDenseTest, LateSegmentsApplyToPastInput) {
+    // 32 taps at Init, then segments published between blocks: each block matches the
+    // full convolution with the taps published so far, including over earlier input
+    const size_t num_ch = 2, block = 40;
+    const auto in = MakeInterleavedInput(input_signal_size, num_ch);
+    std::vector<float> ir(dense_ir_size), history(StreamingDenseConvolutionEngine::GetHistorySize(dense_ir_size, block, num_ch));
+    std::copy(dense_ir, dense_ir + 32, ir.begin());
+    StreamingDenseConvolutionEngine engine;
+    engine.Init(ir.data(), ir.size(), 32, history.data(), history.size(), num_ch);
+
+    std::vector<float> out(block * num_ch);
+    for (size_t start = 0; start + block <= input_signal_size; start += block) {
+        const size_t num_taps = engine.GetNumTaps();
+        engine.Process(in.data() + start * num_ch, out.data(), block);
+        for (size_t i = 0; i < block; i++)
+            for (size_t ch = 0; ch < num_ch; ch++)
+                ASSERT_NEAR(out[i * num_ch + ch], Convolve(in, num_ch, start + i, ch, num_taps), 1e-4)
+                    << "frame " << start + i << " taps " << num_taps;
+        if (!engine.IsComplete()) {
+            const size_t count = std::min<size_t>(56, dense_ir_size - num_taps);
+            engine.AppendTaps(dense_ir + num_taps, count);
+        }
+    }
+    EXPECT_TRUE(engine.IsComplete());
+}
+
+TEST(StreamingDenseTest, SegmentWakesAnIdleEngine) {
+    // Input stops, the engine goes idle on the 16-tap head; the rest of the IR then reaches
+    // back to the input from before the silence
+    std::vector<float> ir(dense_ir, dense_ir + dense_ir_size), history(StreamingDenseConvolutionEngine::GetHistorySize(dense_ir_size, 64, 1));
+    StreamingDenseConvolutionEngine engine;
+    engine.Init(ir.data(), ir.size(), 16, history.data(), history.size(), 1);
+
+    std::vector<float> in(200, 0.0f), out(200);
+    std::copy(input_signal, input_signal + 64, in.begin());
+    engine.Process(in.data(), out.data(), 64);
+    engine.Process(in.data() + 64, out.data() + 64, 40);
+    EXPECT_TRUE(engine.IsIdle());
+
+    engine.PublishTaps(dense_ir_size);
+    engine.Process(in.data() + 104, out.data() + 104, 96);
+    EXPECT_FALSE(engine.IsIdle());
+    for (size_t m = 104; m < 200; m++) ASSERT_NEAR(out[m], Convolve(in, 1, m, 0, dense_ir_size), 1e-4) << "frame " << m;
+}
+
+TEST(StreamingDenseTest, LoaderThreadPublishesWhileProcessing) {
+    const size_t num_ch = 1, frames = 312 * 64, block = 64;
+    std::vector<float> ir(dense_ir_size), history(StreamingDenseConvolutionEngine::GetHistorySize(dense_ir_size, block, num_ch));
+    std::copy(dense_ir, dense_ir + 8, ir.begin());
+    StreamingDenseConvolutionEngine engine;
+    engine.Init(ir.data(), ir.size(), 8, history.data(), history.size(), num_ch);
+
+    std::thread loader([&] {
+        for (size_t loaded = 8; loaded < dense_ir_size; ) {
+            const size_t count = std::min<size_t>(8, dense_ir_size - loaded);
+            engine.AppendTaps(dense_ir + loaded, count);
+            loaded += count;
+            std::this_thread::yield();
+        }
+    });
+
+    const auto in = MakeInterleavedInput(frames, num_ch);
+    std::vector<float> out(in.size());
+    for (size_t start = 0; start < frames - block; start += block)
+        engine.Process(in.data() + start, out.data() + start, block);
+    loader.join();
+    EXPECT_TRUE(engine.IsComplete());
+
+    // Once complete, the output is the full convolution
+    engine.Process(in.data() + frames - block, out.data() + frames - block, block);
+    for (size_t m = frames - block; m < frames; m++) ASSERT_NEAR(out[m], Convolve(in, 1, m, 0, dense_ir_size), 1e-4);
+}
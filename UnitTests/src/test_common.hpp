@@ -6,9 +6,12 @@
 #include "../../SparseConvolutionEngine.hpp"
 #include "../../VelvetConvolutionEngine.hpp"
 #include "../../IRHandle.hpp"
+#include "generated_test_data.hpp"
 #include <vector>
+#include <algorithm>
 #include <numeric>
 #include <memory>
+#include <string>
 
 #include <stdio.h>
 
@@ -33,6 +36,47 @@ struct TestConfig {
     }
 };
 
+// Stable name of a configuration, used for test names and perf baselines
+inline std::string ConfigName(const TestConfig& config) {
+    std::string name;
+    switch (config.ir_type) {
+        case IRType::DENSE: name += "Dense"; break;
+        case IRType::SPARSE: name += "Sparse"; break;
+        case IRType::VELVET: name += "Velvet"; break;
+    }
+    name += "_";
+    switch (config.channel_layout) {
+        case DenseConvolutionEngine::ChannelLayout::MONO: name += "Mono"; break;
+        case DenseConvolutionEngine::ChannelLayout::STEREO: name += "Stereo"; break;
+        case DenseConvolutionEngine::ChannelLayout::QUAD: name += "Quad"; break;
+        case DenseConvolutionEngine::ChannelLayout::MULTICHANNEL: name += "Multi"; break;
+    }
+    name += "_N" + std::to_string(config.num_channels);
+    name += "_Buf" + std::to_string(config.buffer_size);
+    name += "_Blk" + std::to_string(config.block_size);
+    return name;
+}
+
+// Test signal interleaved over num_channels, channel ch scaled by ch + 1 (input_signal repeats past its end)
+inline std::vector<float> MakeInterleavedInput(size_t frames, size_t num_channels) {
+    std::vector<float> in(frames * num_channels);
+    for (size_t i = 0; i < frames; i++)
+        for (size_t ch = 0; ch < num_channels; ch++)
+            in[i * num_channels + ch] = input_signal[i % input_signal_size] * (ch + 1);
+    return in;
+}
+
+// Reference output: one engine, buffer sized for the IR, whole input in a single Process call
+template<typename EngineType, typename HandleType>
+std::vector<float> RenderReference(const HandleType& handle, const std::vector<float>& in, size_t num_channels) {
+    std::vector<float> circ_buffer(ConvolutionUtils::next_power_of_two(std::max<size_t>(ir_length(handle), 1) * num_channels));
+    std::vector<float> out(in.size());
+    EngineType engine;
+    engine.Init(handle, circ_buffer.data(), circ_buffer.size(), num_channels);
+    engine.Process(in.data(), out.data(), in.size() / num_channels);
+    return out;
+}
+
 // Base interface for engine access
 class EngineWrapper {
 public:
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "test_common.hpp"
+#include <vector>
+
+// The configuration matrix shared by the parameterized tests, the perf mode and rt_safety
+inline const std::vector<TestConfig> test_configs = {
+    // DENSE
+    {IRType::DENSE, DenseConvolutionEngine::ChannelLayout::MONO, 1, 1024, 64, DenseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::DENSE, DenseConvolutionEngine::ChannelLayout::STEREO, 2, 2048, 128, DenseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::DENSE, DenseConvolutionEngine::ChannelLayout::MULTICHANNEL, 5, 4096, 256, DenseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::DENSE, DenseConvolutionEngine::ChannelLayout::QUAD, 4, 2047, 64, DenseConvolutionEngine::WrappingMode::ARBITRARY}, 
+    {IRType::DENSE, DenseConvolutionEngine::ChannelLayout::MONO, 1, 511, 16, DenseConvolutionEngine::WrappingMode::ARBITRARY}, 
+
+    // SPARSE
+    {IRType::SPARSE, SparseConvolutionEngine::ChannelLayout::MONO, 1, 1024, 64, SparseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::SPARSE, SparseConvolutionEngine::ChannelLayout::STEREO, 2, 2048, 128, SparseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::SPARSE, SparseConvolutionEngine::ChannelLayout::MULTICHANNEL, 6, 4096, 256, SparseConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::SPARSE, SparseConvolutionEngine::ChannelLayout::QUAD, 4, 2047, 128, SparseConvolutionEngine::WrappingMode::ARBITRARY},  
+    {IRType::SPARSE, SparseConvolutionEngine::ChannelLayout::STEREO, 2, 2047, 64, SparseConvolutionEngine::WrappingMode::ARBITRARY},  
+
+    // VELVET
+    {IRType::VELVET, VelvetConvolutionEngine::ChannelLayout::MONO, 1, 1024, 64, VelvetConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::VELVET, VelvetConvolutionEngine::ChannelLayout::STEREO, 2, 2048, 128, VelvetConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::VELVET, VelvetConvolutionEngine::ChannelLayout::MULTICHANNEL, 3, 4096, 256, VelvetConvolutionEngine::WrappingMode::POWER_OF_TWO},
+    {IRType::VELVET, VelvetConvolutionEngine::ChannelLayout::QUAD, 4, 2047, 4, VelvetConvolutionEngine::WrappingMode::ARBITRARY}, 
+    {IRType::VELVET, VelvetConvolutionEngine::ChannelLayout::MULTICHANNEL, 7, 4095, 32, VelvetConvolutionEngine::WrappingMode::ARBITRARY}, 
+};
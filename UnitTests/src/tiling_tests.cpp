@@ -0,0 +1,78 @@
+#include "test_common.hpp"
+#include "generated_test_data.hpp"
+#include <iterator>
+
+static_assert(std::size(dense_ir_2) == dense_ir_size, "channel IRs must match the base IR length");
+
+template<typename EngineType, typename HandleType>
+static std::vector<float> RenderTiled(const HandleType& handle, size_t buffer_size, size_t num_channels,
+                                      const ConvolutionUtils::TilingConfig& tiling, size_t block_size) {
+    EngineType engine;
+    std::vector<float> circ_buffer(buffer_size);
+    engine.Init(handle, circ_buffer.data(), buffer_size, num_channels);
+    engine.SetTiling(tiling);
+
+    const auto in = MakeInterleavedInput(input_signal_size, num_channels);
+    std::vector<float> out(in.size());
+    for (size_t start = 0; start < input_signal_size; start += block_size) {
+        const size_t frames = std::min(block_size, input_signal_size - start);
+        engine.Process(in.data() + start * num_channels, out.data() + start * num_channels, frames);
+    }
+    return out;
+}
+
+TEST(TilingTest, AutoTilingThreshold) {
+    EXPECT_EQ(ConvolutionUtils::auto_tiling(256, 2).tile_taps, 0u);
+    const auto tiling = ConvolutionUtils::auto_tiling(1 << 20, 2);
+    EXPECT_GT(tiling.tile_taps, 0u);
+    EXPECT_GT(tiling.block_frames, 0u);
+    EXPECT_LE(tiling.tile_taps * 3 * sizeof(float), ConvolutionUtils::kTileTargetBytes);
+}
+
+TEST(TilingTest, DenseTiledMatchesUntiled) {
+    DenseIRHandle handle = {dense_ir, dense_ir_size};
+    const ConvolutionUtils::TilingConfig tilings[] = {{32, 64}, {7, 100}, {64, 1}, {1000, 256}};
+
+    for (size_t num_channels : {1, 2, 3}) {
+        // Power of two, exact fit (block limited to one frame) and arbitrary sizes
+        for (size_t buffer_size : {1024 * num_channels, dense_ir_size * num_channels, 300 * num_channels + 1}) {
+            const auto expected = RenderTiled<DenseConvolutionEngine>(handle, buffer_size, num_channels, {0, 0}, 96);
+            for (const auto& tiling : tilings) {
+                const auto out = RenderTiled<DenseConvolutionEngine>(handle, buffer_size, num_channels, tiling, 96);
+                for (size_t i = 0; i < out.size(); i++)
+                    ASSERT_NEAR(out[i], expected[i], 1e-4) << "ch " << num_channels << " buf " << buffer_size
+                                                           << " tile " << tiling.tile_taps << " i " << i;
+            }
+        }
+    }
+}
+
+TEST(TilingTest, SparseTiledMatchesUntiled) {
+    SparseIRHandle handle = {sparse_ir_positions, sparse_ir_values, sparse_ir_positions_size};
+    const size_t buffer_size = ConvolutionUtils::next_power_of_two(ir_length(handle) * 2);
+    const auto expected = RenderTiled<SparseConvolutionEngine>(handle, buffer_size, 2, {0, 0}, 50);
+    for (const ConvolutionUtils::TilingConfig tiling : {ConvolutionUtils::TilingConfig{16, 8}, ConvolutionUtils::TilingConfig{128, 33}}) {
+        const auto out = RenderTiled<SparseConvolutionEngine>(handle, buffer_size, 2, tiling, 50);
+        for (size_t i = 0; i < out.size(); i++)
+            ASSERT_NEAR(out[i], expected[i], 1e-4) << "tile " << tiling.tile_taps << " i " << i;
+    }
+}
+
+TEST(TilingTest, DenseTiledWithChannelIRs) {
+    DenseIRHandle ir_1 = {dense_ir, dense_ir_size};
+    DenseIRHandle ir_2 = {dense_ir_2, std::size(dense_ir_2)};
+    std::vector<float> in(input_signal_size * 2), expected(in.size()), out(in.size());
+    for (size_t i = 0; i < in.size(); i++) in[i] = input_signal[i / 2];
+
+    for (bool tiled : {false, true}) {
+        DenseConvolutionEngine engine;
+        std::vector<float> circ_buffer(1024), channel_taps(dense_ir_size * 2);
+        engine.Init(ir_1, circ_buffer.data(), circ_buffer.size(), 2);
+        engine.EnableChannelIRs(channel_taps.data());
+        engine.SetChannelIR(1, ir_2);
+        engine.SetTiling(tiled ? ConvolutionUtils::TilingConfig{32, 40} : ConvolutionUtils::TilingConfig{0, 0});
+        engine.Process(in.data(), (tiled ? out : expected).data(), input_signal_size);
+    }
+    for (size_t i = 0; i < out.size(); i++)
+        ASSERT_NEAR(out[i], expected[i], 1e-4) << "i " << i;
+}
@@ -387,4 +387,59 @@ TEST(VelvetMorphingTest, UpdatesAfterCompletion) {
         EXPECT_NO_THROW(engine.MorphIRVelvet_Update());
         EXPECT_NO_THROW(engine.Process(input.data(), output.data(), 4));
     }
-}
\ No newline at end of file
+}
+TEST(VelvetMorphingTest, PrescaledOffsetsStayInSync) {
+    const size_t num_channels = 3;
+    const size_t max_taps = 100;
+
+    struct MorphingEngine {
+        VelvetConvolutionEngine engine;
+        std::vector<float> circ_buffer = std::vector<float>(1024, 0.0f);
+        std::vector<size_t> current_pos = std::vector<size_t>(100), current_neg = std::vector<size_t>(100);
+        std::vector<size_t> initial_pos = std::vector<size_t>(100), initial_neg = std::vector<size_t>(100);
+        std::vector<size_t> target_pos = std::vector<size_t>(100), target_neg = std::vector<size_t>(100);
+        std::vector<size_t> pos_offsets = std::vector<size_t>(100), neg_offsets = std::vector<size_t>(100);
+    };
+
+    VelvetIRHandle initial_handle = {
+        velvet_ir_pos_positions, velvet_ir_pos_positions_size,
+        velvet_ir_neg_positions, 30
+    };
+    VelvetIRHandle target_handle = {
+        velvet_ir_2_pos_positions, 20,
+        velvet_ir_2_neg_positions, velvet_ir_2_neg_positions_size
+    };
+
+    MorphingEngine plain, prescaled;
+    for (MorphingEngine* e : {&plain, &prescaled}) {
+        const bool with_offsets = (e == &prescaled);
+        e->engine.Init(initial_handle, e->circ_buffer.data(), 1023, num_channels,
+                       e->current_pos.data(), e->current_neg.data(),
+                       e->initial_pos.data(), e->initial_neg.data(),
+                       e->target_pos.data(), e->target_neg.data(),
+                       max_taps, max_taps,
+                       with_offsets ? e->pos_offsets.data() : nullptr,
+                       with_offsets ? e->neg_offsets.data() : nullptr);
+        e->engine.MorphIRVelvet(target_handle);
+    }
+
+    std::vector<float> input(16 * num_channels);
+    std::vector<float> out_plain(input.size()), out_prescaled(input.size());
+    for (int step = 0; step < 60; step++) {
+        for (size_t i = 0; i < input.size(); i++)
+            input[i] = input_signal[(step * input.size() + i) % input_signal_size];
+
+        plain.engine.Process(input.data(), out_plain.data(), 16);
+        prescaled.engine.Process(input.data(), out_prescaled.data(), 16);
+        for (size_t i = 0; i < input.size(); i++)
+            ASSERT_EQ(out_plain[i], out_prescaled[i]) << "step " << step;
+
+        plain.engine.MorphIRVelvet_Update();
+        prescaled.engine.MorphIRVelvet_Update();
+        for (size_t t = 0; t < 20; t++)
+            ASSERT_EQ(prescaled.pos_offsets[t], prescaled.current_pos[t] * num_channels);
+        for (size_t t = 0; t < 30; t++)
+            ASSERT_EQ(prescaled.neg_offsets[t], prescaled.current_neg[t] * num_channels);
+    }
+    EXPECT_FALSE(prescaled.engine.IsMorphing());
+}
@@ -5,118 +5,65 @@
 #include "IRHandle.hpp"
 #include "ConvolutionUtils.hpp"
 #include <cstddef>   
+#include <cassert>
 #include <algorithm> 
 #include <cmath>     
 #include <type_traits> 
 
 /**
- * @brief A generic, real-time safe convolution engine supporting velvet
- * impulse responses with compile-time optimization for channel layout.
+ * @brief Read-only tap offsets prescaled for one IR and channel count, which any number of
+ * engines can share (see IRCache::GetOffsets).
  */
-class VelvetConvolutionEngine
+struct VelvetOffsetTable
+{
+    const size_t* pos_offsets;   /**< Positive tap positions times num_channels, in handle order. */
+    const size_t* neg_offsets;   /**< Negative tap positions times num_channels, in handle order. */
+    size_t        num_channels;
+};
+
+/**
+ * @brief State, morphing and kernels shared by the runtime-dispatch VelvetConvolutionEngine
+ * and the statically dispatched VelvetConvolutionEngineT.
+ */
+class VelvetConvolutionEngineCore
 {
-    friend class ConvolutionEngineTest;
-    template<typename EngineType> friend class EngineWrapperImpl;
 public:
     using WrappingMode = ConvolutionUtils::WrappingMode;
     using ChannelLayout = ConvolutionUtils::ChannelLayout;
 
-    using ProcessFunctionPtr = void (VelvetConvolutionEngine::*)(const float*, float*, size_t);
-
-    VelvetConvolutionEngine() : active_process_function_(nullptr), is_morphing_(false),
-                                initial_pos_tail_(0), initial_neg_tail_(0), 
-                                target_pos_head_(0), target_neg_head_(0) {}
-    ~VelvetConvolutionEngine() {}
-
-    void Init(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
-              size_t* current_pos_buffer = nullptr, size_t* current_neg_buffer = nullptr,
-              size_t* initial_pos_buffer = nullptr, size_t* initial_neg_buffer = nullptr,
-              size_t* target_pos_buffer = nullptr, size_t* target_neg_buffer = nullptr,
-              size_t max_pos_taps = 0, size_t max_neg_taps = 0)
+    /**
+     * @brief Circular buffer size (in samples) to allocate for Init with handle: the span of
+     * the IR in frames plus max_block_frames - 1, rounded up to a power of two so that the masked
+     * wrapping kernels are used. Process calls of up to max_block_frames frames then run as one
+     * block. When morphing, pass the span of the longest target as max_morph_length.
+     */
+    static size_t GetBufferSize(const VelvetIRHandle& handle, size_t num_channels,
+                                size_t max_block_frames = ConvolutionUtils::kDefaultMaxBlockFrames,
+                                size_t max_morph_length = 0)
     {
-        circ_buffer_  = circ_buffer;
-        buffer_size_  = buffer_size;
-        num_channels_ = num_channels;
-        write_head_   = 0;
-
-        assert(circ_buffer_); 	// != NULL
-        assert(buffer_size);  	// > 0 
-        assert(num_channels_); 	// > 0
-
-		// Init empty buffer
-        std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
-
-        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
-        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
-
-        velvet_pos_taps_ 			= handle.pos_taps;
-        num_velvet_pos_taps_ 		= handle.num_pos_taps;
-        velvet_neg_taps_ 			= handle.neg_taps;
-        num_velvet_neg_taps_ 		= handle.num_neg_taps;
-        assert(velvet_pos_taps_     || (num_velvet_pos_taps_ == 0));    // != NULL
-        assert(velvet_neg_taps_     || (num_velvet_neg_taps_ == 0));    // != NULL
-
-        // Initialize morphing buffers if provided
-        current_pos_taps_ = current_pos_buffer;
-        current_neg_taps_ = current_neg_buffer;
-        initial_pos_taps_ = initial_pos_buffer;
-        initial_neg_taps_ = initial_neg_buffer;
-        target_pos_taps_ = target_pos_buffer;
-        target_neg_taps_ = target_neg_buffer;
-        max_pos_taps_ = max_pos_taps;
-        max_neg_taps_ = max_neg_taps;
-
-        // Copy initial IR to current buffers if morphing is enabled
-        if (current_pos_taps_ && num_velvet_pos_taps_ > 0)
-        {
-            std::copy(velvet_pos_taps_, velvet_pos_taps_ + num_velvet_pos_taps_, current_pos_taps_);
-            num_current_pos_taps_ = num_velvet_pos_taps_;
-        }
-        else
-        {
-            num_current_pos_taps_ = 0;
-        }
-
-        if (current_neg_taps_ && num_velvet_neg_taps_ > 0)
-        {
-            std::copy(velvet_neg_taps_, velvet_neg_taps_ + num_velvet_neg_taps_, current_neg_taps_);
-            num_current_neg_taps_ = num_velvet_neg_taps_;
-        }
-        else
-        {
-            num_current_neg_taps_ = 0;
-        }
-
-        // Dispatch to the correct template specialization based on runtime channel count
-        // and WrappingMode
-        if (num_channels_ == 1)
-		{
-            dispatch_set_process_function(wrapping_mode, ChannelLayout::MONO);
-		}
-        else if (num_channels_ == 2)
-		{
-            dispatch_set_process_function(wrapping_mode, ChannelLayout::STEREO);
-		}
-        else if (num_channels_ == 4)
-		{
-            dispatch_set_process_function(wrapping_mode, ChannelLayout::QUAD);
-		}
-        else
-		{
-            dispatch_set_process_function(wrapping_mode, ChannelLayout::MULTICHANNEL);
-		}
+        return ConvolutionUtils::buffer_size_for(std::max(ir_length(handle), max_morph_length), num_channels, max_block_frames);
     }
 
-    void Process(const float* in, float* out, size_t size)
-    {
-        (this->*active_process_function_)(in, out, size);
-    }
+    VelvetConvolutionEngineCore() : is_morphing_(false),
+                                    initial_pos_tail_(0), initial_neg_tail_(0), 
+                                    target_pos_head_(0), target_neg_head_(0),
+                                    pos_offsets_(nullptr), neg_offsets_(nullptr),
+                                    pos_offsets_buffer_(nullptr), neg_offsets_buffer_(nullptr), ir_length_(0), tail_length_(0), channel_gains_(nullptr) {}
 
     bool IsMorphing() const
     {
         return is_morphing_;
     }
 
+    /**
+     * @brief Writes num_taps tap positions times num_channels to offsets, the table the
+     * kernel reads instead of multiplying positions.
+     */
+    static void PrescaleOffsets(const size_t* taps, size_t num_taps, size_t num_channels, size_t* offsets)
+    {
+        for (size_t t = 0; t < num_taps; t++) offsets[t] = taps[t] * num_channels;
+    }
+
     void MorphIRVelvet(const VelvetIRHandle& target_handle)
     {
         assert(current_pos_taps_);
@@ -227,10 +174,110 @@ public:
         if (pos_complete && neg_complete)
         {
             is_morphing_ = false;
+            update_ir_length();
         }
     }
 
+    /**
+     * @brief True while the input has been silent for at least the IR length, i.e. the
+     * output buffer is drained and Process only writes zeros.
+     */
+    bool IsIdle() const { return tail_.IsIdle(); }
+
+    /**
+     * @brief Attaches a counter, typically shared by all voices, of how many engines are idle.
+     */
+    void SetIdleCounter(std::atomic<size_t>* counter) { tail_.SetIdleCounter(counter); }
+
+    /**
+     * @brief Attaches storage for num_channels per-channel output gains, all starting at unity.
+     * Call after Init; pass nullptr to detach.
+     */
+    void SetChannelGainBuffer(ConvolutionUtils::ChannelGain* gains)
+    {
+        channel_gains_ = gains;
+        if (channel_gains_)
+            for (size_t ch = 0; ch < num_channels_; ch++) channel_gains_[ch] = { 1.0f, 1.0f, 0.0f, 0 };
+    }
+
+    /**
+     * @brief Ramps the output gain of one channel to target over ramp_frames output frames,
+     * sample-accurately from the next processed frame. Requires a gain buffer.
+     */
+    void SetChannelGain(size_t channel, float target, size_t ramp_frames)
+    {
+        assert(channel_gains_);
+        assert(channel < num_channels_);
+        channel_gains_[channel].Set(target, ramp_frames);
+    }
+
+
+    /**
+     * @brief Bytes SaveState needs for the current state.
+     */
+    size_t GetStateSize() const
+    {
+        ConvolutionUtils::StateWriter writer(nullptr, 0);
+        const_cast<VelvetConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Size();
+    }
+
+    /**
+     * @brief Snapshots the engine into state: the live part of the buffer (the IR span
+     * ahead of the write head, not the whole buffer) plus the silence tracking, morph
+     * and gain state. Real-time safe.
+     * @return Bytes written, 0 if capacity is below GetStateSize().
+     */
+    size_t SaveState(void* state, size_t capacity) const
+    {
+        ConvolutionUtils::StateWriter writer(state, capacity);
+        const_cast<VelvetConvolutionEngineCore*>(this)->transfer_state(writer);
+        return writer.Ok() ? writer.Size() : 0;
+    }
+
+    /**
+     * @brief Restores a SaveState snapshot, e.g. to seek or to hand a voice over. The engine
+     * must be initialized with the same IR, buffer size, channel count and optional buffers;
+     * otherwise false is returned and the engine is left untouched. Real-time safe.
+     */
+    bool RestoreState(const void* state, size_t size)
+    {
+        ConvolutionUtils::StateReader check(state, size, false);
+        transfer_state(check);
+        if (!check.Done()) return false;
+
+        Reset();
+        ConvolutionUtils::StateReader reader(state, size, true);
+        transfer_state(reader);
+
+        // The offsets follow the restored taps (shared ones always match the Init handle)
+        if (pos_offsets_buffer_) PrescaleOffsets(velvet_pos_taps_, num_velvet_pos_taps_, num_channels_, pos_offsets_buffer_);
+        if (neg_offsets_buffer_) PrescaleOffsets(velvet_neg_taps_, num_velvet_neg_taps_, num_channels_, neg_offsets_buffer_);
+        return true;
+    }
+
+    /**
+     * @brief Drops the tail, as a new Init would, but clears only the cells that can hold
+     * it: none when idle, else the IR span ahead of the write head. IR, morph and gain
+     * state are kept. Real-time safe.
+     */
+    void Reset()
+    {
+        if (!tail_.IsIdle())
+            ConvolutionUtils::clear_ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Reset();
+        tail_length_ = ir_length_;
+    }
+
 private:
+    // Exact IR length (last tap + 1). While morphing it is only ever raised, which keeps it an upper bound.
+    void update_ir_length()
+    {
+        ir_length_ = 0;
+        for (size_t t = 0; t < num_velvet_pos_taps_; t++) ir_length_ = std::max(ir_length_, velvet_pos_taps_[t] + 1);
+        for (size_t t = 0; t < num_velvet_neg_taps_; t++) ir_length_ = std::max(ir_length_, velvet_neg_taps_[t] + 1);
+    }
+
     void RemovePositiveTap()
     {
         assert(num_current_pos_taps_ > 0);
@@ -242,6 +289,8 @@ private:
     {
         assert(num_current_pos_taps_ < max_pos_taps_);
         current_pos_taps_[num_current_pos_taps_] = tap_position;
+        if (pos_offsets_buffer_) pos_offsets_buffer_[num_current_pos_taps_] = tap_position * num_channels_;
+        ir_length_ = std::max(ir_length_, tap_position + 1);
         num_current_pos_taps_++;
         num_velvet_pos_taps_ = num_current_pos_taps_;
     }
@@ -257,6 +306,8 @@ private:
     {
         assert(num_current_neg_taps_ < max_neg_taps_);
         current_neg_taps_[num_current_neg_taps_] = tap_position;
+        if (neg_offsets_buffer_) neg_offsets_buffer_[num_current_neg_taps_] = tap_position * num_channels_;
+        ir_length_ = std::max(ir_length_, tap_position + 1);
         num_current_neg_taps_++;
         num_velvet_neg_taps_ = num_current_neg_taps_;
     }
@@ -265,72 +316,243 @@ private:
     {
         assert(index < num_current_pos_taps_);
         current_pos_taps_[index] = new_tap_position;
+        if (pos_offsets_buffer_) pos_offsets_buffer_[index] = new_tap_position * num_channels_;
+        ir_length_ = std::max(ir_length_, new_tap_position + 1);
     }
 
     void SubstituteNegativeTap(size_t index, size_t new_tap_position)
     {
         assert(index < num_current_neg_taps_);
         current_neg_taps_[index] = new_tap_position;
+        if (neg_offsets_buffer_) neg_offsets_buffer_[index] = new_tap_position * num_channels_;
+        ir_length_ = std::max(ir_length_, new_tap_position + 1);
     }
 
 protected:
-    template <WrappingMode WMode, ChannelLayout CLayout>
-    void set_process_function(WrappingMode)
+    void init_state(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+                    size_t* current_pos_buffer, size_t* current_neg_buffer,
+                    size_t* initial_pos_buffer, size_t* initial_neg_buffer,
+                    size_t* target_pos_buffer, size_t* target_neg_buffer,
+                    size_t max_pos_taps, size_t max_neg_taps,
+                    size_t* pos_offsets_buffer, size_t* neg_offsets_buffer)
     {
-        active_process_function_ = &VelvetConvolutionEngine::ProcessImpl<WMode, CLayout>;
-    }
+        circ_buffer_  = circ_buffer;
+        buffer_size_  = buffer_size;
+        num_channels_ = num_channels;
+        write_head_   = 0;
 
-    void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
-    {
-		// POWER OF TWO
-        if (wrapping_mode == WrappingMode::POWER_OF_TWO) {
-            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MONO>(wrapping_mode);
-            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::STEREO>(wrapping_mode);
-            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::QUAD>(wrapping_mode);
-            else set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MULTICHANNEL>(wrapping_mode);
-        } else { // ARBITRARY
-            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MONO>(wrapping_mode);
-            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::STEREO>(wrapping_mode);
-            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::QUAD>(wrapping_mode);
-            else set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        assert(circ_buffer_); 	// != NULL
+        assert(buffer_size);  	// > 0 
+        assert(num_channels_); 	// > 0
+
+		// Init empty buffer
+        std::fill(circ_buffer_, circ_buffer_ + buffer_size_, 0.0f);
+        tail_.Reset();
+        channel_gains_ = nullptr;
+
+        handle_                     = handle;
+        velvet_pos_taps_ 			= handle.pos_taps;
+        num_velvet_pos_taps_ 		= handle.num_pos_taps;
+        velvet_neg_taps_ 			= handle.neg_taps;
+        num_velvet_neg_taps_ 		= handle.num_neg_taps;
+        assert(velvet_pos_taps_     || (num_velvet_pos_taps_ == 0));    // != NULL
+        assert(velvet_neg_taps_     || (num_velvet_neg_taps_ == 0));    // != NULL
+
+        // Initialize morphing buffers if provided
+        current_pos_taps_ = current_pos_buffer;
+        current_neg_taps_ = current_neg_buffer;
+        initial_pos_taps_ = initial_pos_buffer;
+        initial_neg_taps_ = initial_neg_buffer;
+        target_pos_taps_ = target_pos_buffer;
+        target_neg_taps_ = target_neg_buffer;
+        max_pos_taps_ = max_pos_taps;
+        max_neg_taps_ = max_neg_taps;
+
+        // Copy initial IR to current buffers if morphing is enabled
+        if (current_pos_taps_ && num_velvet_pos_taps_ > 0)
+        {
+            std::copy(velvet_pos_taps_, velvet_pos_taps_ + num_velvet_pos_taps_, current_pos_taps_);
+            num_current_pos_taps_ = num_velvet_pos_taps_;
         }
+        else
+        {
+            num_current_pos_taps_ = 0;
+        }
+
+        if (current_neg_taps_ && num_velvet_neg_taps_ > 0)
+        {
+            std::copy(velvet_neg_taps_, velvet_neg_taps_ + num_velvet_neg_taps_, current_neg_taps_);
+            num_current_neg_taps_ = num_velvet_neg_taps_;
+        }
+        else
+        {
+            num_current_neg_taps_ = 0;
+        }
+
+        // Prescale tap positions to channel-strided offsets if storage is provided
+        pos_offsets_ = pos_offsets_buffer_ = pos_offsets_buffer;
+        neg_offsets_ = neg_offsets_buffer_ = neg_offsets_buffer;
+        if (pos_offsets_buffer_) PrescaleOffsets(velvet_pos_taps_, num_velvet_pos_taps_, num_channels_, pos_offsets_buffer_);
+        if (neg_offsets_buffer_) PrescaleOffsets(velvet_neg_taps_, num_velvet_neg_taps_, num_channels_, neg_offsets_buffer_);
+
+        num_initial_pos_taps_ = num_initial_neg_taps_ = 0;
+        num_target_pos_taps_  = num_target_neg_taps_  = 0;
+        update_ir_length();
+        tail_length_ = ir_length_;
     }
 
+    // Switches to a prebuilt offset table of the Init handle, after init_state without morph buffers
+    void use_offsets(const VelvetOffsetTable& offsets)
+    {
+        assert(offsets.num_channels == num_channels_);
+        assert(!current_pos_taps_ && !current_neg_taps_);   // Morphing would rewrite the shared offsets
+        assert(offsets.pos_offsets || num_velvet_pos_taps_ == 0);
+        assert(offsets.neg_offsets || num_velvet_neg_taps_ == 0);
+        pos_offsets_ = offsets.pos_offsets;
+        neg_offsets_ = offsets.neg_offsets;
+        pos_offsets_buffer_ = neg_offsets_buffer_ = nullptr;
+    }
 
     template <WrappingMode WMode, ChannelLayout CLayout>
     void ProcessImpl(const float* in, float* out, size_t size)
     {
+        ProcessMix<WMode, CLayout, false>(in, out, size, 1.0f);
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void ProcessAccumulateImpl(const float* in, float* out, size_t size, float gain)
+    {
+        ProcessMix<WMode, CLayout, true>(in, out, size, gain);
+    }
+
+    // Overwrites out with the output, or with Accumulate adds gain times it; in == out is allowed
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessMix(const float* in, float* out, size_t size, float gain)
+    {
+        ConvolutionUtils::DenormalGuard denormal_guard;
         const size_t num_ch = num_channels_;
+        const size_t silent = ConvolutionUtils::trailing_silent_frames(in, size, num_ch);
+
+        // Drained buffer and silent input: the output stays zero (or untouched), only the head moves
+        if (tail_.IsIdle() && silent == size)
+        {
+            if constexpr (!Accumulate) std::fill(out, out + size * num_ch, 0.0f);
+            write_head_ = (write_head_ + size * num_ch) % buffer_size_;
+            if (channel_gains_)
+                for (size_t ch = 0; ch < num_ch; ch++) channel_gains_[ch].Skip(size);
+        }
+        else
+        {
+            ProcessKernel<WMode, CLayout, Accumulate>(in, out, size, gain);
+        }
+        tail_length_ = std::max(tail_length_, ir_length_);
+        tail_.Update(silent, size, tail_length_);
+        if (tail_.IsIdle()) tail_length_ = ir_length_;
+    }
+
+    template <WrappingMode WMode, ChannelLayout CLayout, bool Accumulate>
+    void ProcessKernel(const float* in, float* out, size_t size, float gain)
+    {
+        const size_t num_ch = ConvolutionUtils::channel_count<CLayout>(num_channels_);
+
+        // Largest block whose writes, (block + ir_length_ - 1) frames ahead of the write head,
+        // cannot wrap onto cells that still have to be read in this block
+        const size_t buffer_frames = buffer_size_ / num_ch;
+        const size_t max_block = (ir_length_ < buffer_frames) ? buffer_frames - ir_length_ + 1 : 1;
 
-        for (size_t smp = 0; smp < size; smp++)
+        while (size > 0)
         {
-            // VELVET KERNEL
-            for (size_t t = 0; t < num_velvet_pos_taps_; t++)
-                ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) 
-                {
-                    const size_t tap_pos = ConvolutionUtils::wrap_address<WMode>(write_head_ + ch + velvet_pos_taps_[t] * num_ch, buffer_size_);
-                    circ_buffer_[tap_pos] += in[smp*num_ch + ch];
-                }, num_channels_);
-            for (size_t t = 0; t < num_velvet_neg_taps_; t++)
-                ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) 
-                {
-                    const size_t tap_pos = ConvolutionUtils::wrap_address<WMode>(write_head_ + ch + velvet_neg_taps_[t] * num_ch, buffer_size_);
-                    circ_buffer_[tap_pos] -= in[smp*num_ch + ch];
-                }, num_channels_);
-            
+            const size_t block = std::min(size, max_block);
+
+            // VELVET KERNEL: each tap adds the whole input block into consecutive cells
+            if (pos_offsets_)
+                ScatterBlock<WMode, true, false>(pos_offsets_, num_velvet_pos_taps_, in, block * num_ch);
+            else
+                ScatterBlock<WMode, false, false>(velvet_pos_taps_, num_velvet_pos_taps_, in, block * num_ch);
+            if (neg_offsets_)
+                ScatterBlock<WMode, true, true>(neg_offsets_, num_velvet_neg_taps_, in, block * num_ch);
+            else
+                ScatterBlock<WMode, false, true>(velvet_neg_taps_, num_velvet_neg_taps_, in, block * num_ch);
+
             // Extract output and clear buffer
-            ConvolutionUtils::for_each_channel<CLayout>([&](size_t ch) {
-                out[smp * num_ch + ch] = circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)];
-				circ_buffer_[ConvolutionUtils::wrap_address<WMode>(write_head_ + ch, buffer_size_)] = 0.0f;
-            }, num_channels_);
-			
-			// Advance buffer head
-			write_head_ = ConvolutionUtils::wrap_address<WMode>(write_head_ + num_ch, buffer_size_);
+            write_head_ = ConvolutionUtils::extract_frames<WMode, CLayout, Accumulate>(circ_buffer_, buffer_size_, write_head_, out, block,
+                                                                                        num_ch, channel_gains_, gain);
+
+            in   += block * num_ch;
+            out  += block * num_ch;
+            size -= block;
         }
     }
 
+    // Samples ahead of the write head that can still hold a tail
+    size_t live_size() const { return std::min(tail_length_ * num_channels_, buffer_size_); }
+
+    // Walks the state with a StateWriter or StateReader, in one fixed order
+    template <typename Archive>
+    void transfer_state(Archive& archive)
+    {
+        const size_t optional_buffers = (current_pos_taps_ ? 1 : 0) | (current_neg_taps_ ? 2 : 0) |
+                                        (initial_pos_taps_ ? 4 : 0) | (initial_neg_taps_ ? 8 : 0) |
+                                        (target_pos_taps_ ? 16 : 0) | (target_neg_taps_ ? 32 : 0) |
+                                        (pos_offsets_ ? 64 : 0) | (neg_offsets_ ? 128 : 0) | (channel_gains_ ? 256 : 0);
+        archive.Check(kStateTag);
+        archive.Check(buffer_size_);
+        archive.Check(num_channels_);
+        archive.Check(max_pos_taps_);
+        archive.Check(max_neg_taps_);
+        archive.Check(optional_buffers);
+
+        archive.Io(tail_length_);
+        archive.Ring(circ_buffer_, buffer_size_, write_head_, live_size());
+        tail_.Transfer(archive);
+        archive.Io(ir_length_);
+
+        // The taps in use are either the Init handle's or the current buffers. Only which one
+        // is stored: a restored engine keeps its own handle, never another engine's pointer.
+        archive.Check(handle_.num_pos_taps);
+        archive.Check(handle_.num_neg_taps);
+        bool pos_on_current = current_pos_taps_ && velvet_pos_taps_ == current_pos_taps_;
+        bool neg_on_current = current_neg_taps_ && velvet_neg_taps_ == current_neg_taps_;
+        archive.Io(pos_on_current);
+        archive.Io(neg_on_current);
+        archive.Io(num_velvet_pos_taps_);
+        archive.Io(num_velvet_neg_taps_);
+        velvet_pos_taps_ = pos_on_current ? current_pos_taps_ : handle_.pos_taps;
+        velvet_neg_taps_ = neg_on_current ? current_neg_taps_ : handle_.neg_taps;
+
+        // Morph progress; the working buffers hold copies, so nothing here is referenced
+        archive.Io(is_morphing_);
+        const size_t pos_capacity = std::max(max_pos_taps_, num_velvet_pos_taps_);
+        const size_t neg_capacity = std::max(max_neg_taps_, num_velvet_neg_taps_);
+        if (current_pos_taps_) archive.IoArray(current_pos_taps_, num_current_pos_taps_, pos_capacity);
+        if (current_neg_taps_) archive.IoArray(current_neg_taps_, num_current_neg_taps_, neg_capacity);
+        if (initial_pos_taps_) archive.IoArray(initial_pos_taps_, num_initial_pos_taps_, pos_capacity);
+        if (initial_neg_taps_) archive.IoArray(initial_neg_taps_, num_initial_neg_taps_, neg_capacity);
+        if (target_pos_taps_)  archive.IoArray(target_pos_taps_, num_target_pos_taps_, pos_capacity);
+        if (target_neg_taps_)  archive.IoArray(target_neg_taps_, num_target_neg_taps_, neg_capacity);
+        archive.Io(initial_pos_tail_);
+        archive.Io(initial_neg_tail_);
+        archive.Io(target_pos_head_);
+        archive.Io(target_neg_head_);
+        if (channel_gains_) archive.IoArray(channel_gains_, num_channels_);
+    }
+
+    static constexpr size_t kStateTag = 0x56454c56; // "VELV"
+
+    // Adds (or subtracts) count interleaved input samples at each tap. The block lands on
+    // count consecutive cells, so every tap is one contiguous vector add split at the wrap point.
+    // Prescaled taps are channel-strided offsets.
+    template <WrappingMode WMode, bool Prescaled, bool Negative>
+    void ScatterBlock(const size_t* taps, size_t num_taps, const float* in, size_t count)
+    {
+        for (size_t t = 0; t < num_taps; t++)
+        {
+            const size_t offset = Prescaled ? taps[t] : taps[t] * num_channels_;
+            const size_t start = ConvolutionUtils::wrap_address<WMode>(write_head_ + offset, buffer_size_);
+            ConvolutionUtils::accumulate_block<Negative>(circ_buffer_, buffer_size_, start, in, count);
+        }
+    }
 
-    ProcessFunctionPtr active_process_function_;
 
     size_t write_head_;
     size_t buffer_size_;
@@ -338,6 +560,7 @@ protected:
     float* circ_buffer_;
 
 	// Used for VELVET kernel
+    VelvetIRHandle handle_;         // The Init handle
     const size_t* velvet_pos_taps_;
     size_t        num_velvet_pos_taps_;
     const size_t* velvet_neg_taps_;
@@ -371,6 +594,185 @@ protected:
     // Buffer size limits
     size_t max_pos_taps_;
     size_t max_neg_taps_;
+
+    // Channel-strided tap offsets, parallel to the current tap arrays (optional), and the
+    // engine's own storage for them, which the morph functions keep in sync (null when shared)
+    const size_t* pos_offsets_;
+    const size_t* neg_offsets_;
+    size_t* pos_offsets_buffer_;
+    size_t* neg_offsets_buffer_;
+
+    // Last tap position + 1, bounds the block size of the kernel
+    size_t ir_length_;
+
+    // Longest IR since the buffer was last drained: a morph can shorten ir_length_
+    // while taps of the old IR still have samples in flight
+    size_t tail_length_;
+
+    // Silence tracking for the idle fast path
+    ConvolutionUtils::TailTracker tail_;
+
+    // Per-channel output gain ramps (optional)
+    ConvolutionUtils::ChannelGain* channel_gains_;
+};
+
+/**
+ * @brief Velvet engine with wrapping mode and channel layout fixed at compile time.
+ * Process is a direct call into the kernel that the compiler can inline into the
+ * caller's loop; use it when the configuration is known up front.
+ */
+template <ConvolutionUtils::WrappingMode WMode, ConvolutionUtils::ChannelLayout CLayout>
+class VelvetConvolutionEngineT : public VelvetConvolutionEngineCore
+{
+public:
+    // Same arguments as VelvetConvolutionEngine::Init; the configuration must match WMode and CLayout
+    void Init(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              size_t* current_pos_buffer = nullptr, size_t* current_neg_buffer = nullptr,
+              size_t* initial_pos_buffer = nullptr, size_t* initial_neg_buffer = nullptr,
+              size_t* target_pos_buffer = nullptr, size_t* target_neg_buffer = nullptr,
+              size_t max_pos_taps = 0, size_t max_neg_taps = 0,
+              size_t* pos_offsets_buffer = nullptr, size_t* neg_offsets_buffer = nullptr)
+    {
+        assert(num_channels == ConvolutionUtils::channel_count<CLayout>(num_channels));
+        assert(WMode == WrappingMode::ARBITRARY || ConvolutionUtils::is_power_of_two(buffer_size));
+
+        init_state(handle, circ_buffer, buffer_size, num_channels,
+                   current_pos_buffer, current_neg_buffer, initial_pos_buffer, initial_neg_buffer,
+                   target_pos_buffer, target_neg_buffer, max_pos_taps, max_neg_taps,
+                   pos_offsets_buffer, neg_offsets_buffer);
+    }
+
+    // Same as above without morphing, with a prebuilt offset table of handle for num_channels
+    void Init(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              const VelvetOffsetTable& offsets)
+    {
+        Init(handle, circ_buffer, buffer_size, num_channels);
+        use_offsets(offsets);
+    }
+
+    void Process(const float* in, float* out, size_t size)
+    {
+        this->template ProcessImpl<WMode, CLayout>(in, out, size);
+    }
+
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
+    {
+        this->template ProcessAccumulateImpl<WMode, CLayout>(in, out, size, gain);
+    }
+};
+
+/**
+ * @brief A generic, real-time safe convolution engine supporting velvet
+ * impulse responses with compile-time optimization for channel layout.
+ * Picks the kernel at Init from the runtime channel count and buffer size.
+ */
+class VelvetConvolutionEngine : public VelvetConvolutionEngineCore
+{
+    friend class ConvolutionEngineTest;
+    template<typename EngineType> friend class EngineWrapperImpl;
+public:
+    using ProcessFunctionPtr = void (VelvetConvolutionEngine::*)(const float*, float*, size_t);
+    using AccumulateFunctionPtr = void (VelvetConvolutionEngine::*)(const float*, float*, size_t, float);
+
+    VelvetConvolutionEngine() : active_process_function_(nullptr), active_accumulate_function_(nullptr) {}
+    ~VelvetConvolutionEngine() {}
+
+    /**
+     * @param pos_offsets_buffer, neg_offsets_buffer Optional (preferably cache-line aligned) storage
+     * for max(num taps, max taps) offsets. When provided, tap positions are prescaled by num_channels
+     * at Init and kept in sync by the morph functions, removing the multiply from the kernel.
+     */
+    void Init(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              size_t* current_pos_buffer = nullptr, size_t* current_neg_buffer = nullptr,
+              size_t* initial_pos_buffer = nullptr, size_t* initial_neg_buffer = nullptr,
+              size_t* target_pos_buffer = nullptr, size_t* target_neg_buffer = nullptr,
+              size_t max_pos_taps = 0, size_t max_neg_taps = 0,
+              size_t* pos_offsets_buffer = nullptr, size_t* neg_offsets_buffer = nullptr)
+    {
+        init_state(handle, circ_buffer, buffer_size, num_channels,
+                   current_pos_buffer, current_neg_buffer, initial_pos_buffer, initial_neg_buffer,
+                   target_pos_buffer, target_neg_buffer, max_pos_taps, max_neg_taps,
+                   pos_offsets_buffer, neg_offsets_buffer);
+
+        const bool is_pow2 = ConvolutionUtils::is_power_of_two(buffer_size_);
+        const auto wrapping_mode = is_pow2 ? WrappingMode::POWER_OF_TWO : WrappingMode::ARBITRARY;
+
+        // Dispatch to the correct template specialization based on runtime channel count
+        // and WrappingMode
+        if (num_channels_ == 1)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MONO);
+		}
+        else if (num_channels_ == 2)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::STEREO);
+		}
+        else if (num_channels_ == 4)
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::QUAD);
+		}
+        else
+		{
+            dispatch_set_process_function(wrapping_mode, ChannelLayout::MULTICHANNEL);
+		}
+    }
+
+    /**
+     * @brief Init without morphing, with a prebuilt offset table of handle for num_channels (e.g.
+     * from IRCache::GetOffsets), read-only and shared with other engines: no prescaling at Init.
+     */
+    void Init(const VelvetIRHandle& handle, float* circ_buffer, size_t buffer_size, size_t num_channels,
+              const VelvetOffsetTable& offsets)
+    {
+        Init(handle, circ_buffer, buffer_size, num_channels);
+        use_offsets(offsets);
+    }
+
+    /**
+     * @brief Writes size frames of output. in and out may be the same buffer (in-place),
+     * but must not otherwise overlap.
+     */
+    void Process(const float* in, float* out, size_t size)
+    {
+        (this->*active_process_function_)(in, out, size);
+    }
+
+    /**
+     * @brief Adds gain times the output to out instead of overwriting it, fused into the
+     * extraction, e.g. to mix several engines into one bus without a temporary buffer.
+     * When idle, out is left untouched.
+     */
+    void ProcessAccumulate(const float* in, float* out, size_t size, float gain = 1.0f)
+    {
+        (this->*active_accumulate_function_)(in, out, size, gain);
+    }
+
+protected:
+    template <WrappingMode WMode, ChannelLayout CLayout>
+    void set_process_function(WrappingMode)
+    {
+        active_process_function_ = &VelvetConvolutionEngine::ProcessImpl<WMode, CLayout>;
+        active_accumulate_function_ = &VelvetConvolutionEngine::ProcessAccumulateImpl<WMode, CLayout>;
+    }
+
+    void dispatch_set_process_function(WrappingMode wrapping_mode, ChannelLayout channel_layout)
+    {
+		// POWER OF TWO
+        if (wrapping_mode == WrappingMode::POWER_OF_TWO) {
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::POWER_OF_TWO, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        } else { // ARBITRARY
+            if (channel_layout == ChannelLayout::MONO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MONO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::STEREO) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::STEREO>(wrapping_mode);
+            else if (channel_layout == ChannelLayout::QUAD) set_process_function<WrappingMode::ARBITRARY, ChannelLayout::QUAD>(wrapping_mode);
+            else set_process_function<WrappingMode::ARBITRARY, ChannelLayout::MULTICHANNEL>(wrapping_mode);
+        }
+    }
+
+    ProcessFunctionPtr active_process_function_;
+    AccumulateFunctionPtr active_accumulate_function_;
 };
 
-#endif // VELVET_CONVOLUTION_ENGINE_H
\ No newline at end of file
+#endif // VELVET_CONVOLUTION_ENGINE_H